@@ -0,0 +1,48 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_popup_arena_H_
+#define __DEF_popup_arena_H_
+
+#include <stddef.h>
+
+#define POPUP_ARENA_CHUNK	2048	/* bytes per chunk */
+#define POPUP_ARENA_ALIGN	16
+
+struct popup_arena_chunk;
+
+/* Owner of everything a single request needs, emptied in one go */
+struct popup_arena {
+	struct popup_arena_chunk *chunks;	/* newest first */
+	unsigned int nalloc;		/* allocations since the last reset */
+	size_t used;			/* bytes since the last reset */
+	unsigned int nchunk;		/* chunks ever taken from malloc */
+	unsigned int nreset;
+};
+
+#define POPUP_ARENA_INIT	{ NULL, 0, 0, 0, 0 }
+
+void *popup_arena_alloc(struct popup_arena *a, size_t n);
+char *popup_arena_strdup(struct popup_arena *a, const char *s);
+char *popup_arena_printf(struct popup_arena *a, const char *fmt, ...)
+	__attribute__ ((format(printf, 2, 3)));
+void popup_arena_reset(struct popup_arena *a);
+void popup_arena_fini(struct popup_arena *a);
+
+#endif				/* __DEF_popup_arena_H__ */
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_dispatch_H_
+#define __DEF_popup_dispatch_H_
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <bundle.h>
+
+#define SYSPOPUP_CONTENT_KEY	"_SYSPOPUP_CONTENT_"
+
+/* Option strings longer than this are rejected without hashing */
+#define POPUP_OPT_MAX_LEN	31
+#define POPUP_OPT_SLOTS		16	/* power of two */
+#define POPUP_OPT_MAX_KEYS	2
+
+/*
+ * Slot of an option string. The same function is used for the
+ * compile-time table layout and for the run-time lookup, so a lookup
+ * costs one hash and at most one string compare.
+ */
+#define POPUP_OPT_HASH(len, first, last) \
+	((((len) * 3) + (first) + (last)) & (POPUP_OPT_SLOTS - 1))
+
+/*
+ * Table entry placed at its slot:
+ *	POPUP_OPT("otg_add", 'o', 'd', OTG_ADD, handler, 0, "path")
+ * 'first' and 'last' must be the first and last character of 'name'.
+ * Tables list their entries once as an X-macro and are built with
+ * POPUP_OPT_TABLE(), which also refuses to compile when two options
+ * hash to the same slot.
+ */
+#define POPUP_OPT(name, first, last, id, fn, flags, ...) \
+	[POPUP_OPT_HASH(sizeof(name) - 1, first, last)] = \
+		{ name, sizeof(name) - 1, id, fn, flags, { __VA_ARGS__ } },
+
+#define POPUP_OPT_CASE(name, first, last, ...) \
+	case POPUP_OPT_HASH(sizeof(name) - 1, first, last):
+
+/* A slot collision is a duplicate case label */
+#define POPUP_OPT_TABLE(table, list) \
+	static inline void table##_slots(int slot) \
+	{ \
+		switch (slot) { \
+		list(POPUP_OPT_CASE) \
+			break; \
+		} \
+	} \
+	static const struct popup_opt table[POPUP_OPT_SLOTS] = { \
+		list(POPUP_OPT) \
+	}
+
+/* Option handler, returns popup specific result */
+typedef int (*popup_opt_fn)(void *data, bundle *b);
+
+struct popup_opt {
+	const char *name;
+	size_t len;
+	int id;
+	popup_opt_fn fn;
+	int flags;
+	const char *required[POPUP_OPT_MAX_KEYS];	/* bundle keys */
+};
+
+/* Dispatch result */
+enum {
+	POPUP_DISPATCH_OK = 0,
+	POPUP_DISPATCH_NO_OPTION = -1,
+	POPUP_DISPATCH_UNKNOWN = -2,
+	POPUP_DISPATCH_MISSING_KEY = -3,
+};
+
+const struct popup_opt *popup_opt_lookup(const struct popup_opt *table,
+					 const char *opt);
+int popup_opt_validate(const struct popup_opt *entry, bundle *b);
+int popup_dispatch(const struct popup_opt *table, bundle *b, void *data,
+		   const struct popup_opt **entry, int *result);
+int popup_opt_table_check(const struct popup_opt *table);
+
+/*
+ * For app_create(). A wrong 'first' or 'last' leaves an entry in a slot
+ * its name does not hash to, which the compiler cannot see; debug builds
+ * refuse to start with such a table instead of running with a dead
+ * option.
+ */
+#ifdef SLP_DEBUG
+#define POPUP_OPT_TABLE_ASSERT(table) \
+	do { \
+		if (popup_opt_table_check(table) < 0) \
+			abort(); \
+	} while (0)
+#else
+#define POPUP_OPT_TABLE_ASSERT(table)	((void)popup_opt_table_check(table))
+#endif
+
+#endif				/* __DEF_popup_dispatch_H__ */
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_popup_emerg_H_
+#define __DEF_popup_emerg_H_
+
+#include <Evas.h>
+
+#define POPUP_EMERG_FB_DEV	"/dev/fb0"
+
+/* Overrides the device, a plain file is sized and used as a fake */
+#define POPUP_EMERG_FB_ENV	"POPUP_EMERG_FB"
+
+/* Time the window gets to produce its first frame */
+#define POPUP_EMERG_BUDGET_MS	800
+
+/* A mapped framebuffer, 16 (RGB565) or 32 (XRGB8888) bits per pixel */
+struct popup_fb {
+	unsigned char *mem;
+	int width;
+	int height;
+	int stride;			/* bytes per line */
+	int bpp;
+};
+
+int popup_emerg_draw(struct popup_fb *fb, const char *msg);
+int popup_emerg_arm(Evas_Object *win, const char *msg, int budget_ms);
+void popup_emerg_disarm(void);
+
+#endif				/* __DEF_popup_emerg_H__ */
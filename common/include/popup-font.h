@@ -0,0 +1,61 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_font_H_
+#define __DEF_popup_font_H_
+
+#include <stdint.h>
+
+/* Written by popup-fontcache, POPUP_FONT_ENV overrides the path */
+#define POPUP_FONT_PATH		"/opt/var/lib/system-popup/font.cache"
+#define POPUP_FONT_ENV		"POPUP_FONT_CACHE_FILE"
+
+#define POPUP_FONT_MAGIC	0x43465053	/* "SPFC" */
+#define POPUP_FONT_VERSION	1
+#define POPUP_FONT_LOCALE	16
+#define POPUP_FONT_FAMILIES	112
+
+struct popup_font_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t nent;
+};
+
+/* Fallback families covering every popup string of one locale */
+struct popup_font_ent {
+	char locale[POPUP_FONT_LOCALE];		/* ll_CC, or ll */
+	char families[POPUP_FONT_FAMILIES];	/* comma separated */
+};
+
+/* "ko_KR.UTF-8@x" to "ko_KR", returns the length of the language part */
+static inline int popup_font_locale(const char *in, char *out, int size)
+{
+	int i, lang = 0;
+
+	for (i = 0; in && in[i] && in[i] != '.' && in[i] != '@' &&
+	     i < size - 1; i++) {
+		out[i] = in[i];
+		if (in[i] == '_' && lang == 0)
+			lang = i;
+	}
+	out[i] = '\0';
+	return lang ? lang : i;
+}
+
+int popup_font_apply(void);
+
+#endif				/* __DEF_popup_font_H__ */
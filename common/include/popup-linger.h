@@ -0,0 +1,34 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_linger_H_
+#define __DEF_popup_linger_H_
+
+#include <Elementary.h>
+
+#define POPUP_LINGER_MAX_SEC		600
+
+typedef void (*popup_release_fn)(void *data);
+
+void popup_linger_init(const char *name);
+void popup_linger_dismiss(Evas_Object *win, popup_release_fn release,
+			  void *data);
+int popup_linger_reuse(void);
+void popup_linger_resident(int on);
+void popup_linger_shown(void);
+
+#endif				/* __DEF_popup_linger_H__ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_log_H_
+#define __DEF_popup_log_H_
+
+#include <stdarg.h>
+#include <stdint.h>
+
+/* Levels, a log_level key of 0 selects POPUP_LOG_DEFAULT */
+enum {
+	POPUP_LOG_OFF = 0,
+	POPUP_LOG_ERR,
+	POPUP_LOG_WARN,
+	POPUP_LOG_INFO,
+	POPUP_LOG_DEBUG,
+};
+
+#define POPUP_LOG_DEFAULT	POPUP_LOG_INFO
+
+#define POPUP_LOG_RING		1024	/* records, power of two */
+#define POPUP_LOG_PAYLOAD	96
+#define POPUP_LOG_STR_MAX	63	/* bytes kept of a %s argument */
+
+/* Root-owned directory for the files the popups write about themselves */
+#define POPUP_PRIVATE_DIR	"/opt/var/lib/system-popup"
+
+/*
+ * Dump written on a crash, or on exit at POPUP_LOG_DEBUG, read by
+ * popup-logdump.
+ */
+#define POPUP_LOG_DUMP_FMT	POPUP_PRIVATE_DIR "/%s.log"
+#define POPUP_LOG_MAGIC		0x474c5053	/* "SPLG" */
+#define POPUP_LOG_VERSION	1
+
+/* One fixed-size record, arguments packed in format order */
+struct popup_log_rec {
+	uint32_t seq;			/* index + 1 once complete */
+	uint8_t level;
+	uint8_t truncated;
+	uint16_t len;			/* payload bytes used */
+	uint32_t tid;
+	uint32_t reserved;
+	uint64_t ts_ns;			/* CLOCK_MONOTONIC */
+	uint64_t fmt;			/* format string address */
+	unsigned char payload[POPUP_LOG_PAYLOAD];
+};
+
+/*
+ * Dump layout: header, POPUP_LOG_RING records in ring order, then
+ * { uint64_t addr; uint32_t len; char str[len]; } for every format
+ * referenced, ended by an entry with addr 0.
+ */
+struct popup_log_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t rec_size;
+	uint32_t nrec;
+	uint32_t pid;
+	uint64_t head;			/* records ever written */
+	uint64_t mono_ns;		/* clocks at dump time */
+	uint64_t real_ns;
+	int32_t signo;			/* 0 on a normal exit */
+	char name[36];
+};
+
+/* Argument classes of a printf conversion */
+enum {
+	POPUP_LOG_ARG_NONE = 0,		/* %% */
+	POPUP_LOG_ARG_INT,
+	POPUP_LOG_ARG_LONG,
+	POPUP_LOG_ARG_LLONG,
+	POPUP_LOG_ARG_SIZE,
+	POPUP_LOG_ARG_DOUBLE,
+	POPUP_LOG_ARG_LDOUBLE,
+	POPUP_LOG_ARG_STR,
+	POPUP_LOG_ARG_PTR,
+	POPUP_LOG_ARG_SKIP,		/* %n */
+};
+
+struct popup_log_spec {
+	int arg;
+	int stars;			/* '*' width/precision ints first */
+	int is_unsigned;
+	char conv;
+};
+
+/*
+ * Parse the conversion after a '%'. Shared with the offline formatter
+ * so both sides agree on how the payload is packed.
+ */
+static inline const char *popup_log_parse(const char *p,
+					  struct popup_log_spec *s)
+{
+	int l = 0;
+
+	s->arg = POPUP_LOG_ARG_NONE;
+	s->stars = 0;
+	s->is_unsigned = 0;
+	s->conv = 0;
+
+	while (*p && (*p == '-' || *p == '+' || *p == ' ' || *p == '#' ||
+		      *p == '0' || *p == '\''))
+		p++;
+	for (; *p && ((*p >= '0' && *p <= '9') || *p == '.' || *p == '*'); p++)
+		if (*p == '*')
+			s->stars++;
+
+	for (; *p; p++) {
+		if (*p == 'h')
+			continue;
+		else if (*p == 'l')
+			l++;
+		else if (*p == 'L' || *p == 'q')
+			l = 2;
+		else if (*p == 'z' || *p == 't' || *p == 'j')
+			l = 3;
+		else
+			break;
+	}
+
+	s->conv = *p;
+	switch (*p) {
+	case 'd': case 'i':
+		s->arg = l == 0 ? POPUP_LOG_ARG_INT : l == 1 ? POPUP_LOG_ARG_LONG :
+			 l == 2 ? POPUP_LOG_ARG_LLONG : POPUP_LOG_ARG_SIZE;
+		break;
+	case 'u': case 'x': case 'X': case 'o': case 'c':
+		s->arg = l == 0 ? POPUP_LOG_ARG_INT : l == 1 ? POPUP_LOG_ARG_LONG :
+			 l == 2 ? POPUP_LOG_ARG_LLONG : POPUP_LOG_ARG_SIZE;
+		s->is_unsigned = *p != 'c';
+		break;
+	case 'f': case 'F': case 'e': case 'E':
+	case 'g': case 'G': case 'a': case 'A':
+		s->arg = l == 2 ? POPUP_LOG_ARG_LDOUBLE : POPUP_LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		s->arg = POPUP_LOG_ARG_STR;
+		break;
+	case 'p':
+		s->arg = POPUP_LOG_ARG_PTR;
+		break;
+	case 'n':
+		s->arg = POPUP_LOG_ARG_SKIP;
+		break;
+	case '\0':
+		return p;
+	default:
+		break;
+	}
+
+	return p + 1;
+}
+
+void popup_log_init(const char *name);
+void popup_log(int level, const char *fmt, ...)
+	__attribute__ ((format(printf, 2, 3)));
+void popup_log_v(int level, const char *fmt, va_list ap);
+int popup_log_level(void);
+int popup_log_dump(int fd, int signo);
+int popup_private_open(const char *path);
+
+/* Former per-popup stderr printer, now an INFO record */
+void system_print(const char *format, ...)
+	__attribute__ ((format(printf, 1, 2)));
+
+#endif				/* __DEF_popup_log_H__ */
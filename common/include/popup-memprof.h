@@ -0,0 +1,42 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_memprof_H_
+#define __DEF_popup_memprof_H_
+
+#include <Evas.h>
+#include "popup-log.h"
+
+#define POPUP_MEMPROF_PHASES	8
+#define POPUP_MEMPROF_TOP	12
+#define POPUP_MEMPROF_FILE_FMT	POPUP_PRIVATE_DIR "/memprof-%s-%d.txt"
+
+/* Where the resident and proportional pages of a sample sit */
+enum {
+	POPUP_MEMPROF_LIB = 0,		/* shared objects */
+	POPUP_MEMPROF_THEME,		/* .edj */
+	POPUP_MEMPROF_FONT,		/* .ttf, .otf, fonts dirs */
+	POPUP_MEMPROF_HEAP,		/* [heap] and anonymous */
+	POPUP_MEMPROF_OTHER,
+	POPUP_MEMPROF_KINDS
+};
+
+void popup_memprof_init(const char *name);
+void popup_memprof_phase(const char *phase);
+void popup_memprof_watch(Evas_Object *win);
+
+#endif				/* __DEF_popup_memprof_H__ */
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_popup_pool_H_
+#define __DEF_popup_pool_H_
+
+#include <Elementary.h>
+
+#define POPUP_POOL_SLOTS	4	/* layouts kept per process */
+#define POPUP_POOL_BUTTONS	3
+#define POPUP_POOL_BTN_STYLE	"popup_button/default"
+
+Evas_Object *popup_pool_get(Evas_Object *win, int nbtn);
+void popup_pool_button_set(Evas_Object *popup, int idx, const char *text,
+			   Evas_Smart_Cb cb, void *data);
+void popup_pool_put(Evas_Object *popup);
+
+#endif				/* __DEF_popup_pool_H__ */
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_screen_H_
+#define __DEF_popup_screen_H_
+
+#define POPUP_SCREEN_SHM_NAME	"/syspopup-screen"
+
+/* A cache nobody is keeping current is trusted this long */
+#define POPUP_SCREEN_TRUST_SEC	300
+
+int popup_screen_get(int *w, int *h, int *angle);
+int popup_screen_cached(int *w, int *h, int *angle);
+void popup_screen_stats(int *nqueries, int *ncached);
+
+#endif				/* __DEF_popup_screen_H__ */
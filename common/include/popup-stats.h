@@ -0,0 +1,135 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_stats_H_
+#define __DEF_popup_stats_H_
+
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+
+#define POPUP_STATS_SHM_NAME	"/syspopup-stats"
+#define POPUP_STATS_MAGIC	0x54535053	/* "SPST" */
+#define POPUP_STATS_VERSION	1
+#define POPUP_STATS_PIDS	8	/* live processes tracked per type */
+
+/* Popup types, one block of counters each */
+#define POPUP_STATS_TYPES(X)		\
+	X(POWEROFF, "poweroff")		\
+	X(LOWBATT, "lowbatt")		\
+	X(LOWMEM, "lowmem")		\
+	X(USBOTG, "usbotg")		\
+	X(USBOTG_UNMOUNT, "usbotg-unmount")
+
+/* Monotonic event counters */
+#define POPUP_STATS_COUNTERS(X)			\
+	X(LAUNCH, "launch")			\
+	X(SHOW, "show")				\
+	X(LINGER_REUSE, "linger_reuse")		\
+	X(CHOICE_OK, "choice_ok")		\
+	X(CHOICE_CANCEL, "choice_cancel")	\
+	X(DISMISS, "dismiss")			\
+	X(TIMEOUT, "timeout")			\
+	X(POWEROFF_FALLBACK, "poweroff_fallback") \
+	X(NOTI_INSERT, "noti_insert")		\
+	X(NOTI_DELETE, "noti_delete")		\
+	X(NOTI_FAIL, "noti_fail")		\
+	X(SVI_FAIL, "svi_fail")			\
+	X(HAPTIC_FAIL, "haptic_fail")		\
+	X(PM_FAIL, "pm_fail")			\
+	X(SCREEN_QUERY, "screen_query")		\
+	X(SCREEN_CACHED, "screen_cached")	\
+	X(X_REQUEST, "x_request")		\
+	X(X_ROUNDTRIP, "x_roundtrip")		\
+	X(EMERG_RENDER, "emerg_render")		\
+	X(EMERG_FAIL, "emerg_fail")		\
+	X(BATT_SAMPLE, "batt_sample")		\
+	X(BATT_UEVENT, "batt_uevent")		\
+	X(THERMAL_CLEAR, "thermal_clear")	\
+	X(POOL_BUILD, "pool_build")		\
+	X(POOL_REUSE, "pool_reuse")		\
+	X(POOL_SAVED_BYTES, "pool_saved_bytes")	\
+	X(CHOICE_SLEEP, "choice_sleep")		\
+	X(SLEEP_RESUME, "sleep_resume")		\
+	X(USB_UEVENT, "usb_uevent")		\
+	X(USB_HOTPLUG, "usb_hotplug")
+
+/* Current values, "running" is derived from the live pids */
+#define POPUP_STATS_GAUGES(X)			\
+	X(RUNNING, "running")			\
+	X(SHOW_MS, "last_show_ms")		\
+	X(DEVICES, "devices")			\
+	X(SLEEP_SYNC_MS, "sleep_sync_ms")	\
+	X(SLEEP_FREEZE_MS, "sleep_freeze_ms")	\
+	X(SLEEP_DEVICES_MS, "sleep_devices_ms")
+
+#define POPUP_STATS_ENUM(id, name)	POPUP_STAT_##id,
+#define POPUP_GAUGE_ENUM(id, name)	POPUP_GAUGE_##id,
+#define POPUP_TYPE_ENUM(id, name)	POPUP_TYPE_##id,
+
+enum { POPUP_STATS_TYPES(POPUP_TYPE_ENUM) POPUP_TYPE_MAX };
+enum { POPUP_STATS_COUNTERS(POPUP_STATS_ENUM) POPUP_STAT_MAX };
+enum { POPUP_STATS_GAUGES(POPUP_GAUGE_ENUM) POPUP_GAUGE_MAX };
+
+struct popup_stats_block {
+	uint64_t ctr[POPUP_STAT_MAX];
+	int64_t gauge[POPUP_GAUGE_MAX];
+	int32_t pid[POPUP_STATS_PIDS];	/* 0 when free */
+};
+
+/* Shared segment, written with relaxed atomics, never locked */
+struct popup_stats_shm {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t ntypes;
+	uint16_t nctr;
+	uint16_t ngauge;
+	uint32_t npid;
+	struct popup_stats_block type[POPUP_TYPE_MAX];
+};
+
+int popup_stats_init(int type);
+void popup_stats_add(int ctr, uint64_t n);
+void popup_stats_gauge_set(int gauge, int64_t val);
+void popup_stats_gauge_add(int gauge, int64_t delta);
+
+#define popup_stats_inc(ctr)	popup_stats_add(ctr, 1)
+
+static inline int popup_stats_pid_alive(int32_t pid)
+{
+	if (pid <= 0)
+		return 0;
+	return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+/* Gauge value for readers, RUNNING counts the live pids */
+static inline int64_t popup_stats_gauge_get(const struct popup_stats_block *b,
+					    int gauge)
+{
+	int64_t n = 0;
+	int i;
+
+	if (gauge != POPUP_GAUGE_RUNNING)
+		return __atomic_load_n(&b->gauge[gauge], __ATOMIC_RELAXED);
+
+	for (i = 0; i < POPUP_STATS_PIDS; i++)
+		n += popup_stats_pid_alive(__atomic_load_n(&b->pid[i],
+							   __ATOMIC_RELAXED));
+	return n;
+}
+
+#endif				/* __DEF_popup_stats_H__ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_timeline_H_
+#define __DEF_popup_timeline_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Ring file kept across reboots, POPUP_TIMELINE_ENV overrides the path */
+#define POPUP_TIMELINE_DIR	"/opt/var/lib/system-popup"
+#define POPUP_TIMELINE_PATH	POPUP_TIMELINE_DIR "/shutdown.timeline"
+#define POPUP_TIMELINE_ENV	"POPUP_TIMELINE_FILE"
+
+#define POPUP_TIMELINE_MAGIC	0x4c545053	/* "SPTL" */
+#define POPUP_TIMELINE_VERSION	1
+#define POPUP_TIMELINE_SLOTS	16		/* runs kept */
+#define POPUP_TIMELINE_COPIES	2		/* records per run */
+#define POPUP_TIMELINE_STAGES	24
+#define POPUP_TIMELINE_NAME	12
+
+struct popup_timeline_stage {
+	uint32_t us;			/* since the first mark */
+	char name[POPUP_TIMELINE_NAME];
+};
+
+/*
+ * One run, a whole sector so each update is written in one piece.
+ * Marks alternate between the run's two records, so a torn write costs
+ * the latest stage and not the run. A record that fails the crc is
+ * skipped by the reader, which keeps the copy with more stages.
+ */
+struct popup_timeline_rec {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t nstage;
+	uint32_t seq;			/* runs ever recorded */
+	uint32_t pid;
+	uint64_t real_ns;		/* clocks at the first mark */
+	uint64_t mono_ns;
+	char boot_id[40];
+	uint32_t crc;			/* over the record with crc 0 */
+	uint32_t reserved;
+	struct popup_timeline_stage stage[POPUP_TIMELINE_STAGES];
+	char pad[48];
+};
+
+/* Shared with the offline reader */
+static inline uint32_t popup_timeline_crc(const void *buf, size_t n)
+{
+	const unsigned char *p = buf;
+	uint32_t crc = 0xffffffff;
+	int k;
+
+	while (n--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+	return ~crc;
+}
+
+int popup_timeline_begin(void);
+void popup_timeline_mark(const char *stage);
+void popup_timeline_end(void);
+
+#endif				/* __DEF_popup_timeline_H__ */
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_timer_H_
+#define __DEF_popup_timer_H_
+
+#include <stdint.h>
+
+#define POPUP_TIMER_TICK_MS	50
+#define POPUP_TIMER_SLOTS	64	/* power of two */
+
+typedef void (*popup_timer_cb)(void *data);
+
+/* Timer owned by the caller, so arming never allocates */
+struct popup_timer {
+	struct popup_timer *next;
+	struct popup_timer *prev;
+	uint64_t due;			/* ms on the monotonic clock */
+	unsigned int rounds;		/* wheel turns left */
+	popup_timer_cb cb;
+	void *data;
+};
+
+struct popup_timer_stats {
+	unsigned int fired;
+	unsigned int cancelled;
+	unsigned int late_max_ms;
+	unsigned int late_avg_ms;
+};
+
+int popup_timer_init(void);
+void popup_timer_fini(void);
+int popup_timer_arm(struct popup_timer *t, unsigned int ms,
+		    popup_timer_cb cb, void *data);
+void popup_timer_cancel(struct popup_timer *t);
+int popup_timer_armed(const struct popup_timer *t);
+void popup_timer_stats_get(struct popup_timer_stats *st);
+
+#endif				/* __DEF_popup_timer_H__ */
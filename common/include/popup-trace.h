@@ -0,0 +1,46 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_trace_H_
+#define __DEF_popup_trace_H_
+
+#include <stdint.h>
+#include <bundle.h>
+#include <Evas.h>
+#include "popup-log.h"
+
+#define POPUP_TRACE_MAX_EVENTS	512
+#define POPUP_TRACE_FILE_FMT	POPUP_PRIVATE_DIR "/trace-%s-%d.json"
+
+/* Set by the requester to tie the popup to its own trace */
+#define POPUP_TRACE_BUNDLE_KEY	"_TRACE_ID_"
+
+void popup_trace_init(const char *name);
+void popup_trace_request(bundle *b, Evas_Object *win);
+uint64_t popup_trace_begin(void);
+void popup_trace_end(const char *name, uint64_t start);
+void popup_trace_instant(const char *name);
+
+/* Time one call: POPUP_TRACE("pm_change_state", ret = pm_change_state(s)); */
+#define POPUP_TRACE(name, stmt)				\
+	do {						\
+		uint64_t __t = popup_trace_begin();	\
+		stmt;					\
+		popup_trace_end(name, __t);		\
+	} while (0)
+
+#endif				/* __DEF_popup_trace_H__ */
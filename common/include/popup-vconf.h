@@ -0,0 +1,60 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_vconf_H_
+#define __DEF_popup_vconf_H_
+
+#define POPUP_VCONF_SHM_NAME	"/syspopup-vconf"
+
+/* Seconds a dismissed popup waits for reuse, 0 exits at once */
+#define VCONFKEY_SYSPOPUP_LINGER_SEC	"db/private/system-popup/linger_sec"
+
+/* Ring logger level, see popup-log.h */
+#define VCONFKEY_SYSPOPUP_LOG_LEVEL	"db/private/system-popup/log_level"
+
+/* Non-zero writes a trace-event file per popup process */
+#define VCONFKEY_SYSPOPUP_TRACE		"db/private/system-popup/trace"
+
+/* Non-zero lets lowbatt watch the battery itself and stay resident */
+#define VCONFKEY_SYSPOPUP_BATT_MONITOR	"db/private/system-popup/batt_monitor"
+
+/* Non-zero writes a per-phase memory report per popup process */
+#define VCONFKEY_SYSPOPUP_MEMPROF	"db/private/system-popup/memprof"
+
+/* Non-zero lets usbotg watch USB hotplug itself and stay resident */
+#define VCONFKEY_SYSPOPUP_USB_MONITOR	"db/private/system-popup/usb_monitor"
+
+/* Keys the popups read on the show path */
+enum {
+	POPUP_VCONF_TESTMODE_LOWBATT = 0,
+	POPUP_VCONF_SOUND_ON,
+	POPUP_VCONF_VIBRATION_ON,
+	POPUP_VCONF_LINGER_SEC,
+	POPUP_VCONF_LOG_LEVEL,
+	POPUP_VCONF_TRACE,
+	POPUP_VCONF_BATT_MONITOR,
+	POPUP_VCONF_MEMPROF,
+	POPUP_VCONF_USB_MONITOR,
+	POPUP_VCONF_MAX
+};
+
+int popup_vconf_init(void);
+void popup_vconf_fini(void);
+int popup_vconf_get(int id, int *val);
+void popup_vconf_stats(int *nreads, int *nsaved);
+
+#endif				/* __DEF_popup_vconf_H__ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_popup_x_H_
+#define __DEF_popup_x_H_
+
+#include <Evas.h>
+#include "popup-trace.h"
+
+#define POPUP_X_MAX_STEPS	16
+
+struct popup_x_mark {
+	unsigned long next;		/* sequence of the next request */
+	uint64_t trace;
+};
+
+void popup_x_mark(struct popup_x_mark *m);
+void popup_x_step(const char *name, const struct popup_x_mark *m);
+int popup_x_prepare(Evas_Object *win, int grab_keys);
+void popup_x_report(void);
+
+/* Count the X requests and round trips of one step, name is a literal */
+#define POPUP_X(name, stmt)				\
+	do {						\
+		struct popup_x_mark __m;		\
+		popup_x_mark(&__m);			\
+		stmt;					\
+		popup_x_step(name, &__m);		\
+	} while (0)
+
+#endif				/* __DEF_popup_x_H__ */
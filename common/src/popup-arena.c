@@ -0,0 +1,149 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Request-scoped arena.
+ *
+ * Strings taken from the launch bundle and buffers built for the popup
+ * live until the popup closes. They are carved out of a chunk owned by
+ * the popup and dropped together by popup_arena_reset(), which keeps
+ * the first chunk so the next request normally allocates nothing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "popup-arena.h"
+#include "popup-log.h"
+
+struct popup_arena_chunk {
+	struct popup_arena_chunk *next;
+	size_t size;
+	size_t used;
+	unsigned char data[] __attribute__ ((aligned(POPUP_ARENA_ALIGN)));
+};
+
+void *popup_arena_alloc(struct popup_arena *a, size_t n)
+{
+	struct popup_arena_chunk *c = a->chunks;
+	size_t off, size;
+	void *p;
+
+	if (n == 0)
+		n = 1;
+
+	if (c) {
+		off = (c->used + POPUP_ARENA_ALIGN - 1) & ~(size_t)(POPUP_ARENA_ALIGN - 1);
+		if (off + n <= c->size) {
+			c->used = off + n;
+			p = c->data + off;
+			goto out;
+		}
+	}
+
+	/* Oversized requests get a chunk of their own */
+	size = n > POPUP_ARENA_CHUNK ? n : POPUP_ARENA_CHUNK;
+	c = malloc(sizeof(*c) + size);
+	if (c == NULL)
+		return NULL;
+	c->size = size;
+	c->used = n;
+	c->next = a->chunks;
+	a->chunks = c;
+	a->nchunk++;
+	p = c->data;
+
+out:
+	a->nalloc++;
+	a->used += n;
+	return p;
+}
+
+/* NULL stays NULL so optional bundle keys copy straight through */
+char *popup_arena_strdup(struct popup_arena *a, const char *s)
+{
+	size_t n;
+	char *p;
+
+	if (s == NULL)
+		return NULL;
+
+	n = strlen(s) + 1;
+	p = popup_arena_alloc(a, n);
+	if (p)
+		memcpy(p, s, n);
+	return p;
+}
+
+char *popup_arena_printf(struct popup_arena *a, const char *fmt, ...)
+{
+	va_list ap;
+	char *p;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(NULL, 0, fmt, ap);
+	va_end(ap);
+	if (n < 0)
+		return NULL;
+
+	p = popup_arena_alloc(a, n + 1);
+	if (p == NULL)
+		return NULL;
+
+	va_start(ap, fmt);
+	vsnprintf(p, n + 1, fmt, ap);
+	va_end(ap);
+	return p;
+}
+
+/* The popup closed: drop every allocation, keep the oldest chunk */
+void popup_arena_reset(struct popup_arena *a)
+{
+	struct popup_arena_chunk *c, *next;
+
+	popup_log(POPUP_LOG_DEBUG, "arena: %u allocs, %zu bytes, %u chunks",
+		  a->nalloc, a->used, a->nchunk);
+
+	for (c = a->chunks; c && c->next; c = next) {
+		next = c->next;
+		free(c);
+	}
+	a->chunks = c;
+	if (c)
+		c->used = 0;
+
+	a->nalloc = 0;
+	a->used = 0;
+	a->nreset++;
+}
+
+void popup_arena_fini(struct popup_arena *a)
+{
+	struct popup_arena_chunk *c, *next;
+
+	for (c = a->chunks; c; c = next) {
+		next = c->next;
+		free(c);
+	}
+	a->chunks = NULL;
+	a->nalloc = 0;
+	a->used = 0;
+}
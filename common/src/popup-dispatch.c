@@ -0,0 +1,115 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#include <string.h>
+#include "popup-dispatch.h"
+#include "popup-log.h"
+
+/* Find the table entry of an option string, NULL if unknown */
+const struct popup_opt *popup_opt_lookup(const struct popup_opt *table,
+					 const char *opt)
+{
+	const struct popup_opt *entry;
+	size_t len;
+
+	if (table == NULL || opt == NULL)
+		return NULL;
+
+	len = strnlen(opt, POPUP_OPT_MAX_LEN + 1);
+	if (len == 0 || len > POPUP_OPT_MAX_LEN)
+		return NULL;
+
+	entry = &table[POPUP_OPT_HASH(len, (unsigned char)opt[0],
+				      (unsigned char)opt[len - 1])];
+	if (entry->name == NULL || entry->len != len)
+		return NULL;
+	if (memcmp(entry->name, opt, len))
+		return NULL;
+
+	return entry;
+}
+
+/* Check that every bundle key the option needs is present */
+int popup_opt_validate(const struct popup_opt *entry, bundle *b)
+{
+	const char *val;
+	int i;
+
+	if (entry == NULL || b == NULL)
+		return -1;
+
+	for (i = 0; i < POPUP_OPT_MAX_KEYS; i++) {
+		if (entry->required[i] == NULL)
+			break;
+		val = bundle_get_val(b, entry->required[i]);
+		if (val == NULL || val[0] == '\0')
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Decode the syspopup content of a request and run its handler */
+int popup_dispatch(const struct popup_opt *table, bundle *b, void *data,
+		   const struct popup_opt **entry, int *result)
+{
+	const struct popup_opt *e;
+	const char *opt;
+
+	if (entry)
+		*entry = NULL;
+
+	opt = bundle_get_val(b, SYSPOPUP_CONTENT_KEY);
+	if (opt == NULL)
+		return POPUP_DISPATCH_NO_OPTION;
+
+	e = popup_opt_lookup(table, opt);
+	if (e == NULL)
+		return POPUP_DISPATCH_UNKNOWN;
+
+	if (popup_opt_validate(e, b) < 0)
+		return POPUP_DISPATCH_MISSING_KEY;
+
+	if (entry)
+		*entry = e;
+	if (e->fn) {
+		int r = e->fn(data, b);
+		if (result)
+			*result = r;
+	}
+
+	return POPUP_DISPATCH_OK;
+}
+
+/* Verify that every entry sits in the slot its name hashes to */
+int popup_opt_table_check(const struct popup_opt *table)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < POPUP_OPT_SLOTS; i++) {
+		if (table[i].name == NULL)
+			continue;
+		if (popup_opt_lookup(table, table[i].name) != &table[i]) {
+			system_print("\n system-popup : option %s is not in its slot, "
+				     "check its first and last character \n",
+				     table[i].name);
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
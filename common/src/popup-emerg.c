@@ -0,0 +1,444 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Emergency rendering for the shutdown popups.
+ *
+ * A critical battery shuts the device down whether or not the popup
+ * reached the screen, and with a stalled X server or compositor it
+ * silently does not. popup_emerg_arm() starts a watchdog thread before
+ * the window is shown. If the canvas has not rendered a frame within
+ * the budget the thread maps the framebuffer and draws the message with
+ * a built-in 5x7 font, never touching X. The first frame disarms it.
+ *
+ * "First frame" is the canvas finishing its first render. That is as
+ * close as the client gets: whether the compositor then puts the frame
+ * on screen is not visible from here, so a compositor stalled after
+ * that point still leaves the screen blank.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/fb.h>
+#include "popup-emerg.h"
+#include "popup-log.h"
+#include "popup-screen.h"
+#include "popup-stats.h"
+
+#define GLYPH_W		5
+#define GLYPH_H		7
+#define CELL_W		(GLYPH_W + 1)
+#define CELL_H		(GLYPH_H + 3)
+#define COLS		20	/* characters across at the chosen scale */
+#define LINES_MAX	6
+#define MSG_MAX		128
+
+#define COLOR_BG	0x000000
+#define COLOR_FG	0xffffff
+
+struct glyph {
+	char c;
+	uint8_t row[GLYPH_H];		/* bit 4 is the leftmost column */
+};
+
+static const struct glyph font[] = {
+	{ ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+	{ '!', { 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x04 } },
+	{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+	{ '\'', { 0x0c, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 } },
+	{ ',', { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 } },
+	{ '-', { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00 } },
+	{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c } },
+	{ ':', { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00 } },
+	{ '?', { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+	{ '0', { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e } },
+	{ '1', { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e } },
+	{ '2', { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f } },
+	{ '3', { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e } },
+	{ '4', { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 } },
+	{ '5', { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e } },
+	{ '6', { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e } },
+	{ '7', { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+	{ '8', { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e } },
+	{ '9', { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c } },
+	{ 'A', { 0x0e, 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11 } },
+	{ 'B', { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e } },
+	{ 'C', { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e } },
+	{ 'D', { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c } },
+	{ 'E', { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f } },
+	{ 'F', { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 } },
+	{ 'G', { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f } },
+	{ 'H', { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 } },
+	{ 'I', { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e } },
+	{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c } },
+	{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+	{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f } },
+	{ 'M', { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+	{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+	{ 'O', { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e } },
+	{ 'P', { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 } },
+	{ 'Q', { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d } },
+	{ 'R', { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11 } },
+	{ 'S', { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e } },
+	{ 'T', { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+	{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e } },
+	{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04 } },
+	{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a } },
+	{ 'X', { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11 } },
+	{ 'Y', { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04 } },
+	{ 'Z', { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f } },
+};
+
+#define NGLYPHS		(int)(sizeof(font) / sizeof(font[0]))
+#define GLYPH_UNKNOWN	8		/* '?' */
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond;
+static pthread_t watchdog;
+static int cond_ready = 0;
+static int running = 0;			/* watchdog needs a join */
+static int presented = 0;
+static struct timespec deadline;
+
+/* Copied in arm(), the watchdog must not look at X or the caller */
+static char message[MSG_MAX];
+static int screen_w = 0;
+static int screen_h = 0;
+
+static Evas *render_evas = NULL;
+
+static const uint8_t *glyph_rows(char c)
+{
+	int i;
+
+	if (c >= 'a' && c <= 'z')
+		c -= 'a' - 'A';
+	for (i = 0; i < NGLYPHS; i++)
+		if (font[i].c == c)
+			return font[i].row;
+	return font[GLYPH_UNKNOWN].row;
+}
+
+static void fill(struct popup_fb *fb, int x, int y, int w, int h,
+		 uint32_t rgb)
+{
+	uint16_t rgb565;
+	unsigned char *line;
+	int i, j;
+
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	if (x + w > fb->width)
+		w = fb->width - x;
+	if (y + h > fb->height)
+		h = fb->height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	rgb565 = ((rgb >> 8) & 0xf800) | ((rgb >> 5) & 0x07e0) |
+		((rgb >> 3) & 0x001f);
+
+	for (j = y; j < y + h; j++) {
+		line = fb->mem + (size_t)j * fb->stride;
+		if (fb->bpp == 32) {
+			for (i = x; i < x + w; i++)
+				((uint32_t *)line)[i] = rgb;
+		} else {
+			for (i = x; i < x + w; i++)
+				((uint16_t *)line)[i] = rgb565;
+		}
+	}
+}
+
+/* Break at '\n' and between words so no line exceeds cols */
+static int wrap(const char *msg, int cols, char lines[LINES_MAX][MSG_MAX])
+{
+	const char *p = msg;
+	int n = 0, len = 0, word, i;
+
+	while (*p && n < LINES_MAX) {
+		if (*p == ' ') {
+			p++;
+			continue;
+		}
+		if (*p == '\n') {
+			lines[n++][len] = '\0';
+			len = 0;
+			p++;
+			continue;
+		}
+
+		for (word = 0; p[word] && p[word] != ' ' && p[word] != '\n'; word++)
+			;
+		if (len > 0 && len + 1 + word > cols) {
+			lines[n++][len] = '\0';
+			len = 0;
+			if (n == LINES_MAX)
+				break;
+		}
+		if (len > 0)
+			lines[n][len++] = ' ';
+		for (i = 0; i < word && len < cols; i++)
+			lines[n][len++] = p[i];
+		p += word;
+	}
+
+	if (len > 0 && n < LINES_MAX)
+		lines[n++][len] = '\0';
+	return n;
+}
+
+/* Clear the surface and draw msg centred, white on black */
+int popup_emerg_draw(struct popup_fb *fb, const char *msg)
+{
+	char lines[LINES_MAX][MSG_MAX];
+	const uint8_t *rows;
+	int scale, cols, n, len, x0, y0, i, j, gx, gy;
+
+	if (fb == NULL || fb->mem == NULL || msg == NULL)
+		return -1;
+	if ((fb->bpp != 16 && fb->bpp != 32) || fb->width < CELL_W ||
+	    fb->height < CELL_H)
+		return -1;
+
+	scale = fb->width / (CELL_W * COLS);
+	if (scale < 1)
+		scale = 1;
+	cols = fb->width / (CELL_W * scale);
+	if (cols >= MSG_MAX)
+		cols = MSG_MAX - 1;
+	n = wrap(msg, cols, lines);
+
+	fill(fb, 0, 0, fb->width, fb->height, COLOR_BG);
+
+	y0 = (fb->height - n * CELL_H * scale) / 2;
+	for (i = 0; i < n; i++) {
+		len = strlen(lines[i]);
+		x0 = (fb->width - len * CELL_W * scale + scale) / 2;
+		for (j = 0; j < len; j++) {
+			rows = glyph_rows(lines[i][j]);
+			for (gy = 0; gy < GLYPH_H; gy++)
+				for (gx = 0; gx < GLYPH_W; gx++)
+					if (rows[gy] & (0x10 >> gx))
+						fill(fb, x0 + (j * CELL_W + gx) * scale,
+						     y0 + (i * CELL_H + gy) * scale,
+						     scale, scale, COLOR_FG);
+		}
+	}
+
+	return 0;
+}
+
+/* Map the framebuffer, returns the mapping to unmap or NULL */
+static void *fb_map(struct popup_fb *fb, size_t *len)
+{
+	struct fb_var_screeninfo var;
+	struct fb_fix_screeninfo fix;
+	struct stat st;
+	const char *path;
+	unsigned char *map;
+	size_t off = 0;
+	int fd;
+
+	path = getenv(POPUP_EMERG_FB_ENV);
+	if (path == NULL || path[0] == '\0')
+		path = POPUP_EMERG_FB_DEV;
+
+	fd = open(path, O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		popup_log(POPUP_LOG_ERR, "emerg: cannot open %s: %d", path, errno);
+		return NULL;
+	}
+
+	if (ioctl(fd, FBIOGET_VSCREENINFO, &var) == 0 &&
+	    ioctl(fd, FBIOGET_FSCREENINFO, &fix) == 0) {
+		fb->width = var.xres;
+		fb->height = var.yres;
+		fb->bpp = var.bits_per_pixel;
+		fb->stride = fix.line_length;
+		*len = fix.smem_len;
+		/* Draw into the page being scanned out */
+		off = (size_t)var.yoffset * fix.line_length +
+			(size_t)var.xoffset * (var.bits_per_pixel / 8);
+	} else if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		/* Fake device: packed XRGB8888 at the screen size */
+		fb->width = screen_w;
+		fb->height = screen_h;
+		fb->bpp = 32;
+		fb->stride = screen_w * 4;
+		*len = (size_t)fb->stride * fb->height;
+		if ((size_t)st.st_size < *len && ftruncate(fd, *len) < 0) {
+			close(fd);
+			return NULL;
+		}
+	} else {
+		popup_log(POPUP_LOG_ERR, "emerg: %s is not a framebuffer", path);
+		close(fd);
+		return NULL;
+	}
+
+	if (fb->width <= 0 || fb->height <= 0 || *len == 0 ||
+	    off + (size_t)fb->stride * fb->height > *len) {
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, *len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	fb->mem = map + off;
+	return map;
+}
+
+static long elapsed_us(const struct timespec *a, const struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) * 1000000L +
+		(b->tv_nsec - a->tv_nsec) / 1000;
+}
+
+static void *watchdog_main(void *arg)
+{
+	struct popup_fb fb;
+	struct timespec t0, t1;
+	void *map;
+	size_t len = 0;
+	int rc = 0, fire;
+
+	pthread_mutex_lock(&lock);
+	while (!presented && rc != ETIMEDOUT)
+		rc = pthread_cond_timedwait(&cond, &lock, &deadline);
+	fire = !presented;
+	pthread_mutex_unlock(&lock);
+
+	if (!fire)
+		return NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	map = fb_map(&fb, &len);
+	if (map == NULL || popup_emerg_draw(&fb, message) < 0) {
+		if (map)
+			munmap(map, len);
+		popup_stats_inc(POPUP_STAT_EMERG_FAIL);
+		popup_log(POPUP_LOG_ERR, "emerg: no frame in budget, fallback failed");
+		return NULL;
+	}
+	munmap(map, len);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	popup_stats_inc(POPUP_STAT_EMERG_RENDER);
+	popup_log(POPUP_LOG_WARN, "emerg: no frame in budget, drew %dx%d/%d in %ldus",
+		  fb.width, fb.height, fb.bpp, elapsed_us(&t0, &t1));
+	return NULL;
+}
+
+static void first_render(void *data, Evas *e, void *event_info)
+{
+	popup_emerg_disarm();
+}
+
+/* Before the window is shown: draw msg ourselves unless a frame comes */
+int popup_emerg_arm(Evas_Object *win, const char *msg, int budget_ms)
+{
+	pthread_condattr_t attr;
+
+	if (win == NULL || msg == NULL)
+		return -1;
+
+	popup_emerg_disarm();
+
+	if (!cond_ready) {
+		pthread_condattr_init(&attr);
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+		pthread_cond_init(&cond, &attr);
+		pthread_condattr_destroy(&attr);
+		cond_ready = 1;
+	}
+
+	/*
+	 * Only sizes a fake device, a real one reports its own. Never ask
+	 * the server here, it may be the thing that is stuck.
+	 */
+	if (popup_screen_cached(&screen_w, &screen_h, NULL) < 0)
+		screen_w = screen_h = 0;
+	snprintf(message, sizeof(message), "%s", msg);
+
+	render_evas = evas_object_evas_get(win);
+	if (render_evas == NULL)
+		return -1;
+	evas_event_callback_add(render_evas, EVAS_CALLBACK_RENDER_POST,
+				first_render, NULL);
+
+	if (budget_ms <= 0)
+		budget_ms = POPUP_EMERG_BUDGET_MS;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += budget_ms / 1000;
+	deadline.tv_nsec += (budget_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	presented = 0;
+	if (pthread_create(&watchdog, NULL, watchdog_main, NULL) != 0) {
+		evas_event_callback_del(render_evas, EVAS_CALLBACK_RENDER_POST,
+					first_render);
+		render_evas = NULL;
+		return -1;
+	}
+	running = 1;
+	return 0;
+}
+
+/* The window is on screen, stop the watchdog */
+void popup_emerg_disarm(void)
+{
+	if (render_evas) {
+		evas_event_callback_del(render_evas, EVAS_CALLBACK_RENDER_POST,
+					first_render);
+		render_evas = NULL;
+	}
+	if (!running)
+		return;
+
+	pthread_mutex_lock(&lock);
+	presented = 1;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(watchdog, NULL);
+	running = 0;
+}
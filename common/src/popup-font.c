@@ -0,0 +1,112 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Per-locale font fallback from a shared cache.
+ *
+ * Hangul, Kana, Han or Arabic text in a popup makes evas sort the whole
+ * fontconfig set for a fallback on the first frame of every cold start.
+ * popup-fontcache resolves, once per locale, the shortest list of
+ * families covering every popup string and stores it in a small file
+ * that the popups map read-only. Appending that list to the edje fontset
+ * lets the first lookup find the glyphs without the sort.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <Edje.h>
+#include "popup-font.h"
+#include "popup-log.h"
+
+static char applied[POPUP_FONT_LOCALE];
+
+/* Exact locale first, then the language alone */
+static const struct popup_font_ent *lookup(const struct popup_font_hdr *h,
+					   const char *locale, int lang)
+{
+	const struct popup_font_ent *ent = (const void *)(h + 1);
+	const struct popup_font_ent *best = NULL;
+	int i;
+
+	for (i = 0; i < h->nent; i++) {
+		if (strncmp(ent[i].locale, locale, POPUP_FONT_LOCALE) == 0)
+			return &ent[i];
+		if (best == NULL && strncmp(ent[i].locale, locale, lang) == 0 &&
+		    ent[i].locale[lang] == '\0')
+			best = &ent[i];
+	}
+	return best;
+}
+
+/* From app_create(), after the locale is set; 0 when a list was applied */
+int popup_font_apply(void)
+{
+	const struct popup_font_hdr *h;
+	const struct popup_font_ent *ent;
+	const char *path, *cur;
+	char locale[POPUP_FONT_LOCALE], fonts[POPUP_FONT_FAMILIES + 1];
+	struct stat st;
+	void *map = MAP_FAILED;
+	int fd, lang, ret = -1;
+
+	cur = setlocale(LC_MESSAGES, NULL);
+	if (cur == NULL || strcmp(cur, "C") == 0 || strcmp(cur, "POSIX") == 0)
+		cur = getenv("LANG");
+	lang = popup_font_locale(cur, locale, sizeof(locale));
+	if (locale[0] == '\0')
+		return -1;
+	if (strcmp(locale, applied) == 0)
+		return 0;
+
+	path = getenv(POPUP_FONT_ENV);
+	if (path == NULL)
+		path = POPUP_FONT_PATH;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(*h))
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	h = map;
+	if (h->magic != POPUP_FONT_MAGIC || h->version != POPUP_FONT_VERSION ||
+	    sizeof(*h) + h->nent * sizeof(*ent) > (size_t)st.st_size)
+		goto out;
+
+	ent = lookup(h, locale, lang);
+	if (ent == NULL)
+		goto out;
+
+	memcpy(fonts, ent->families, POPUP_FONT_FAMILIES);
+	fonts[POPUP_FONT_FAMILIES] = '\0';
+	edje_fontset_append_set(fonts);
+	snprintf(applied, sizeof(applied), "%s", locale);
+	system_print("\n System-popup : fonts for %s: %s \n", locale, fonts);
+	ret = 0;
+
+out:
+	munmap(map, st.st_size);
+	return ret;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Linger mode for dismissed popups.
+ *
+ * Instead of exiting, a dismissed popup hides its window, drops its
+ * widgets and caches and waits for the configured idle period. A new
+ * request in that period reaches app_reset() with syspopup_has_popup()
+ * set and shows the warm window again. Hits, misses and the show
+ * latency of cold and warm launches are logged when the process exits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <malloc.h>
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-timer.h"
+#include "popup-vconf.h"
+
+struct linger {
+	const char *name;
+	int lingering;
+	int resident;			/* never exit on dismiss */
+	struct popup_timer idle;
+
+	double start;			/* process start or reuse time */
+	int warm;
+	unsigned int hits;
+	unsigned int shows;
+	double cold_ms;
+	double warm_ms_sum;
+};
+
+static struct linger lg;
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void report(void)
+{
+	if (lg.shows == 0)
+		return;
+
+	system_print("\n %s : linger hits %u of %u shows, cold %.1fms, warm avg %.1fms \n",
+		     lg.name, lg.hits, lg.shows, lg.cold_ms,
+		     lg.hits ? lg.warm_ms_sum / lg.hits : 0.0);
+}
+
+static void idle_cb(void *data)
+{
+	system_print("\n %s : linger period over \n", lg.name);
+	exit(0);
+}
+
+/* Call first thing in main() so the cold show latency is complete */
+void popup_linger_init(const char *name)
+{
+	lg.name = name;
+	lg.start = now_ms();
+	atexit(report);
+}
+
+/* Hide a dismissed popup and wait for reuse, or exit */
+void popup_linger_dismiss(Evas_Object *win, popup_release_fn release,
+			  void *data)
+{
+	int sec = 0;
+
+	if (!lg.resident &&
+	    (popup_vconf_get(POPUP_VCONF_LINGER_SEC, &sec) < 0 || sec <= 0))
+		exit(0);
+	if (sec > POPUP_LINGER_MAX_SEC)
+		sec = POPUP_LINGER_MAX_SEC;
+
+	if (release)
+		release(data);
+	if (win)
+		evas_object_hide(win);
+
+	/* Give back what only the visible popup needed */
+	elm_cache_all_flush();
+	malloc_trim(0);
+
+	if (lg.resident) {
+		lg.lingering = 1;
+		return;
+	}
+	if (popup_timer_arm(&lg.idle, sec * 1000, idle_cb, NULL) < 0)
+		exit(0);
+	lg.lingering = 1;
+}
+
+/* Keep the process after a dismissal for as long as it has other work */
+void popup_linger_resident(int on)
+{
+	lg.resident = on;
+	if (on)
+		popup_timer_cancel(&lg.idle);
+	else if (lg.lingering)
+		idle_cb(NULL);
+}
+
+/* From app_reset(): non-zero if a lingering window is to be shown again */
+int popup_linger_reuse(void)
+{
+	if (!lg.lingering)
+		return 0;
+
+	popup_timer_cancel(&lg.idle);
+	lg.lingering = 0;
+	lg.warm = 1;
+	lg.hits++;
+	popup_stats_inc(POPUP_STAT_LINGER_REUSE);
+	lg.start = now_ms();
+	return 1;
+}
+
+/* The popup is on screen */
+void popup_linger_shown(void)
+{
+	double ms = now_ms() - lg.start;
+
+	lg.shows++;
+	popup_stats_gauge_set(POPUP_GAUGE_SHOW_MS, (int64_t)ms);
+	if (lg.warm)
+		lg.warm_ms_sum += ms;
+	else
+		lg.cold_ms = ms;
+	lg.warm = 0;
+}
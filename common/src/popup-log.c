@@ -0,0 +1,355 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Binary ring logger.
+ *
+ * A log call claims a slot with one atomic add and copies the format
+ * address and the raw arguments into a fixed-size record, nothing is
+ * formatted. The ring is written to POPUP_LOG_DUMP_FMT when the process
+ * crashes, or when it exits with the debug level selected, and
+ * popup-logdump turns it back into text. The level comes from the
+ * log_level vconf key, read at init and followed through its change
+ * notification on the main loop; logging threads only load it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <vconf.h>
+#include "popup-log.h"
+#include "popup-vconf.h"
+
+#define RING_MASK	(POPUP_LOG_RING - 1)
+
+static struct popup_log_rec ring[POPUP_LOG_RING];
+static uint64_t head = 0;
+
+static char dump_path[96];
+static char name[36];
+
+static int level = POPUP_LOG_DEFAULT;
+
+static __thread uint32_t tid = 0;
+
+static const int crash_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+
+static uint64_t clock_ns(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Current level, safe from any thread */
+int popup_log_level(void)
+{
+	return __atomic_load_n(&level, __ATOMIC_RELAXED);
+}
+
+static void set_level(int val)
+{
+	__atomic_store_n(&level, val > 0 ? val : POPUP_LOG_DEFAULT,
+			 __ATOMIC_RELAXED);
+}
+
+/* Change notification from vconf, runs on the main loop */
+static void level_changed(keynode_t *node, void *data)
+{
+	if (node)
+		set_level(vconf_keynode_get_int(node));
+}
+
+static int put(struct popup_log_rec *r, const void *src, size_t n)
+{
+	if (r->len + n > POPUP_LOG_PAYLOAD)
+		return -1;
+	memcpy(r->payload + r->len, src, n);
+	r->len += n;
+	return 0;
+}
+
+static int put_str(struct popup_log_rec *r, const char *s)
+{
+	uint8_t n = 0;
+
+	if (s == NULL)
+		s = "(null)";
+	while (n < POPUP_LOG_STR_MAX && s[n])
+		n++;
+	if (r->len + 1 + n > POPUP_LOG_PAYLOAD)
+		return -1;
+	r->payload[r->len++] = n;
+	memcpy(r->payload + r->len, s, n);
+	r->len += n;
+	return 0;
+}
+
+/* Copy the arguments in format order */
+static void pack(struct popup_log_rec *r, const char *fmt, va_list ap)
+{
+	struct popup_log_spec s;
+	int64_t i;
+	double d;
+	int err = 0;
+
+	while (*fmt && !err) {
+		if (*fmt++ != '%')
+			continue;
+
+		fmt = popup_log_parse(fmt, &s);
+		for (; s.stars > 0 && !err; s.stars--) {
+			i = va_arg(ap, int);
+			err = put(r, &i, sizeof(i));
+		}
+		if (err)
+			break;
+
+		switch (s.arg) {
+		case POPUP_LOG_ARG_INT:
+			i = s.is_unsigned ? (int64_t)va_arg(ap, unsigned int) :
+				(int64_t)va_arg(ap, int);
+			err = put(r, &i, sizeof(i));
+			break;
+		case POPUP_LOG_ARG_LONG:
+			i = s.is_unsigned ? (int64_t)va_arg(ap, unsigned long) :
+				(int64_t)va_arg(ap, long);
+			err = put(r, &i, sizeof(i));
+			break;
+		case POPUP_LOG_ARG_LLONG:
+			i = va_arg(ap, long long);
+			err = put(r, &i, sizeof(i));
+			break;
+		case POPUP_LOG_ARG_SIZE:
+			i = (int64_t)va_arg(ap, size_t);
+			err = put(r, &i, sizeof(i));
+			break;
+		case POPUP_LOG_ARG_DOUBLE:
+			d = va_arg(ap, double);
+			err = put(r, &d, sizeof(d));
+			break;
+		case POPUP_LOG_ARG_LDOUBLE:
+			d = (double)va_arg(ap, long double);
+			err = put(r, &d, sizeof(d));
+			break;
+		case POPUP_LOG_ARG_STR:
+			err = put_str(r, va_arg(ap, const char *));
+			break;
+		case POPUP_LOG_ARG_PTR:
+			i = (int64_t)(uintptr_t)va_arg(ap, void *);
+			err = put(r, &i, sizeof(i));
+			break;
+		case POPUP_LOG_ARG_SKIP:
+			(void)va_arg(ap, void *);
+			break;
+		default:
+			break;
+		}
+	}
+
+	r->truncated = err ? 1 : 0;
+}
+
+void popup_log_v(int lvl, const char *fmt, va_list ap)
+{
+	struct popup_log_rec *r;
+	uint64_t idx;
+
+	if (fmt == NULL || lvl <= POPUP_LOG_OFF || lvl > popup_log_level())
+		return;
+
+	if (tid == 0)
+		tid = (uint32_t)syscall(SYS_gettid);
+
+	idx = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+	r = &ring[idx & RING_MASK];
+
+	/* Invalidate first so a dump never sees a half written record */
+	__atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	r->level = lvl;
+	r->len = 0;
+	r->tid = tid;
+	r->ts_ns = clock_ns(CLOCK_MONOTONIC);
+	r->fmt = (uint64_t)(uintptr_t)fmt;
+	pack(r, fmt, ap);
+
+	__atomic_store_n(&r->seq, (uint32_t)(idx + 1), __ATOMIC_RELEASE);
+}
+
+void popup_log(int lvl, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	popup_log_v(lvl, fmt, ap);
+	va_end(ap);
+}
+
+void system_print(const char *format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	popup_log_v(POPUP_LOG_INFO, format, ap);
+	va_end(ap);
+}
+
+static int write_all(int fd, const void *buf, size_t n)
+{
+	const char *p = buf;
+	ssize_t r;
+
+	while (n > 0) {
+		r = write(fd, p, n);
+		if (r <= 0)
+			return -1;
+		p += r;
+		n -= r;
+	}
+	return 0;
+}
+
+/* Write the ring and its format strings, async-signal-safe */
+int popup_log_dump(int fd, int signo)
+{
+	struct popup_log_hdr h;
+	uint64_t addr, end = 0;
+	uint32_t len;
+	const char *s;
+	int i, j;
+
+	memset(&h, 0, sizeof(h));
+	h.magic = POPUP_LOG_MAGIC;
+	h.version = POPUP_LOG_VERSION;
+	h.rec_size = sizeof(struct popup_log_rec);
+	h.nrec = POPUP_LOG_RING;
+	h.pid = getpid();
+	h.head = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+	h.mono_ns = clock_ns(CLOCK_MONOTONIC);
+	h.real_ns = clock_ns(CLOCK_REALTIME);
+	h.signo = signo;
+	memcpy(h.name, name, sizeof(h.name));
+
+	if (write_all(fd, &h, sizeof(h)) < 0 ||
+	    write_all(fd, ring, sizeof(ring)) < 0)
+		return -1;
+
+	/* Each distinct format once, in order of first use */
+	for (i = 0; i < POPUP_LOG_RING; i++) {
+		if (ring[i].seq == 0 || ring[i].fmt == 0)
+			continue;
+		addr = ring[i].fmt;
+		for (j = 0; j < i; j++)
+			if (ring[j].seq && ring[j].fmt == addr)
+				break;
+		if (j < i)
+			continue;
+
+		s = (const char *)(uintptr_t)addr;
+		len = strlen(s);
+		if (write_all(fd, &addr, sizeof(addr)) < 0 ||
+		    write_all(fd, &len, sizeof(len)) < 0 ||
+		    write_all(fd, s, len) < 0)
+			return -1;
+	}
+
+	len = 0;
+	if (write_all(fd, &end, sizeof(end)) < 0 ||
+	    write_all(fd, &len, sizeof(len)) < 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Create or replace a file in POPUP_PRIVATE_DIR for writing. Only root
+ * can write there, and a symlink in place of the file is refused.
+ * Async-signal-safe.
+ */
+int popup_private_open(const char *path)
+{
+	mkdir(POPUP_PRIVATE_DIR, 0755);
+	return open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC,
+		    0640);
+}
+
+static void dump_to_file(int signo)
+{
+	int fd;
+
+	if (dump_path[0] == '\0')
+		return;
+
+	fd = popup_private_open(dump_path);
+	if (fd < 0)
+		return;
+	popup_log_dump(fd, signo);
+	close(fd);
+}
+
+/* A normal exit is only dumped when debug output was asked for */
+static void dump_at_exit(void)
+{
+	if (__atomic_load_n(&level, __ATOMIC_RELAXED) >= POPUP_LOG_DEBUG)
+		dump_to_file(0);
+}
+
+static void crash_handler(int signo)
+{
+	dump_to_file(signo);
+
+	/* SA_RESETHAND put the default action back */
+	raise(signo);
+}
+
+/* Call first thing in main(), before anything logs */
+void popup_log_init(const char *app)
+{
+	struct sigaction sa;
+	int i, val;
+
+	if (app == NULL || name[0])
+		return;
+
+	strncpy(name, app, sizeof(name) - 1);
+	snprintf(dump_path, sizeof(dump_path), POPUP_LOG_DUMP_FMT, app);
+
+	/* The level lives in the shared snapshot, read it here once */
+	popup_vconf_init();
+	if (popup_vconf_get(POPUP_VCONF_LOG_LEVEL, &val) == 0)
+		set_level(val);
+	vconf_notify_key_changed(VCONFKEY_SYSPOPUP_LOG_LEVEL, level_changed,
+				 NULL);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = crash_handler;
+	sa.sa_flags = SA_RESETHAND | SA_NODEFER;
+	sigemptyset(&sa.sa_mask);
+	for (i = 0; i < (int)(sizeof(crash_signals) / sizeof(crash_signals[0])); i++)
+		sigaction(crash_signals[i], &sa, NULL);
+
+	atexit(dump_at_exit);
+}
@@ -0,0 +1,376 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Per-phase memory profiler.
+ *
+ * Each phase takes one sample: Rss and Pss from smaps_rollup, the fault
+ * counts from getrusage() and a walk of smaps that splits Rss and Pss
+ * between libraries, theme, fonts, heap and the rest. The last sample
+ * also keeps Pss per mapped file, so the report names the dependencies
+ * worth cutting. Phases are recorded once each, the first call wins, and
+ * the report goes to POPUP_MEMPROF_FILE_FMT after the first frame and
+ * again at exit if more phases came in. The profiler's own reads show up
+ * in the time column, so it is off unless the memprof vconf key is set.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "popup-memprof.h"
+#include "popup-vconf.h"
+#include "popup-log.h"
+
+#define MAX_FILES	64
+#define LINE_MAX_LEN	512
+
+struct mem_sample {
+	const char *phase;
+	uint64_t ts;			/* us since init */
+	unsigned long rss;		/* kB */
+	unsigned long pss;
+	unsigned long swap;
+	long minflt;
+	long majflt;
+	unsigned long kind_rss[POPUP_MEMPROF_KINDS];
+	unsigned long kind_pss[POPUP_MEMPROF_KINDS];
+};
+
+struct mem_file {
+	char path[96];
+	unsigned long pss;
+	int kind;
+};
+
+static struct mem_sample samples[POPUP_MEMPROF_PHASES];
+static int nsamples = 0;
+static int reported = 0;
+
+/* Pss per file, from the latest sample */
+static struct mem_file files[MAX_FILES];
+static int nfiles = 0;
+
+static int enabled = 0;
+static const char *proc_name = "popup";
+static uint64_t t0 = 0;
+static Evas *render_evas = NULL;
+
+static const char *kind_name[POPUP_MEMPROF_KINDS] = {
+	"lib", "theme", "font", "heap", "other"
+};
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int ends_with(const char *s, const char *suffix)
+{
+	size_t n = strlen(s), m = strlen(suffix);
+
+	return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static int classify(const char *path)
+{
+	const char *so;
+
+	if (path[0] == '\0' || strcmp(path, "[heap]") == 0 ||
+	    strncmp(path, "[anon:", 6) == 0)
+		return POPUP_MEMPROF_HEAP;
+	if (path[0] == '[')
+		return POPUP_MEMPROF_OTHER;
+	if (ends_with(path, ".edj"))
+		return POPUP_MEMPROF_THEME;
+	if (strstr(path, "/fonts/") || ends_with(path, ".ttf") ||
+	    ends_with(path, ".otf") || ends_with(path, ".ttc") ||
+	    ends_with(path, ".pcf.gz"))
+		return POPUP_MEMPROF_FONT;
+
+	/* libfoo.so and libfoo.so.1.2 */
+	for (so = strstr(path, ".so"); so; so = strstr(so + 3, ".so"))
+		if (so[3] == '\0' || so[3] == '.')
+			return POPUP_MEMPROF_LIB;
+
+	return POPUP_MEMPROF_OTHER;
+}
+
+static int field_kb(const char *line, const char *key, unsigned long *val)
+{
+	size_t n = strlen(key);
+
+	if (strncmp(line, key, n) != 0)
+		return 0;
+	*val = strtoul(line + n, NULL, 10);
+	return 1;
+}
+
+/* Mapping lines start with the address range, field lines with a name */
+static const char *mapping_path(char *line)
+{
+	char *p = line;
+	int i;
+
+	if (!isxdigit((unsigned char)*p) || isupper((unsigned char)*p))
+		return NULL;
+
+	/* Skip address, perms, offset, dev and inode */
+	for (i = 0; i < 5; i++) {
+		while (*p && !isspace((unsigned char)*p))
+			p++;
+		while (*p == ' ' || *p == '\t')
+			p++;
+	}
+	p[strcspn(p, "\n")] = '\0';
+	if (ends_with(p, " (deleted)"))
+		p[strlen(p) - 10] = '\0';
+
+	return p;
+}
+
+static void file_add(const char *path, int kind, unsigned long pss)
+{
+	int i;
+
+	if (kind == POPUP_MEMPROF_HEAP || path[0] == '[' || pss == 0)
+		return;
+
+	for (i = 0; i < nfiles; i++)
+		if (strncmp(files[i].path, path, sizeof(files[i].path) - 1) == 0)
+			break;
+	if (i == nfiles) {
+		if (nfiles == MAX_FILES)
+			return;
+		snprintf(files[i].path, sizeof(files[i].path), "%s", path);
+		files[i].kind = kind;
+		files[i].pss = 0;
+		nfiles++;
+	}
+	files[i].pss += pss;
+}
+
+static int read_line(FILE *fp, char *buf, int size)
+{
+	int c;
+
+	if (fgets(buf, size, fp) == NULL)
+		return -1;
+
+	/* Drop the tail of an over-long line */
+	if (strchr(buf, '\n') == NULL)
+		while ((c = fgetc(fp)) != EOF && c != '\n')
+			;
+	return 0;
+}
+
+/* Walk every mapping, also summing the totals for kernels without rollup */
+static void sample_smaps(struct mem_sample *s)
+{
+	char line[LINE_MAX_LEN];
+	const char *path;
+	char cur[96] = "";
+	unsigned long val;
+	int kind = POPUP_MEMPROF_OTHER;
+	FILE *fp;
+
+	fp = fopen("/proc/self/smaps", "r");
+	if (fp == NULL)
+		return;
+
+	nfiles = 0;
+	while (read_line(fp, line, sizeof(line)) == 0) {
+		path = mapping_path(line);
+		if (path) {
+			kind = classify(path);
+			snprintf(cur, sizeof(cur), "%s", path);
+			continue;
+		}
+
+		if (field_kb(line, "Rss:", &val)) {
+			s->kind_rss[kind] += val;
+			s->rss += val;
+		} else if (field_kb(line, "Pss:", &val)) {
+			s->kind_pss[kind] += val;
+			s->pss += val;
+			file_add(cur, kind, val);
+		} else if (field_kb(line, "Swap:", &val)) {
+			s->swap += val;
+		}
+	}
+
+	fclose(fp);
+}
+
+static void sample_rollup(struct mem_sample *s)
+{
+	char line[LINE_MAX_LEN];
+	unsigned long rss = 0, pss = 0, swap = 0;
+	FILE *fp;
+
+	fp = fopen("/proc/self/smaps_rollup", "r");
+	if (fp == NULL)
+		return;
+
+	while (read_line(fp, line, sizeof(line)) == 0) {
+		if (!field_kb(line, "Rss:", &rss) &&
+		    !field_kb(line, "Pss:", &pss))
+			field_kb(line, "Swap:", &swap);
+	}
+	fclose(fp);
+
+	if (rss) {
+		s->rss = rss;
+		s->pss = pss;
+		s->swap = swap;
+	}
+}
+
+static void write_report(void)
+{
+	struct mem_sample *s;
+	struct mem_file *f, tmp;
+	char path[128];
+	unsigned long prev = 0;
+	FILE *fp;
+	int fd, i, j, k;
+
+	if (nsamples == reported)
+		return;
+	reported = nsamples;
+
+	snprintf(path, sizeof(path), POPUP_MEMPROF_FILE_FMT, proc_name, getpid());
+	fd = popup_private_open(path);
+	fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (fp == NULL) {
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+
+	fprintf(fp, "# %s pid %d, kB\n", proc_name, getpid());
+	fprintf(fp, "%-13s %8s %7s %7s %6s %6s %6s", "phase", "ms", "rss",
+		"pss", "+pss", "minflt", "majflt");
+	for (k = 0; k < POPUP_MEMPROF_KINDS; k++)
+		fprintf(fp, " %6s", kind_name[k]);
+	fputc('\n', fp);
+
+	for (i = 0; i < nsamples; i++) {
+		s = &samples[i];
+		fprintf(fp, "%-13s %8.1f %7lu %7lu %6ld %6ld %6ld", s->phase,
+			s->ts / 1000.0, s->rss, s->pss,
+			i ? (long)s->pss - (long)prev : 0L, s->minflt, s->majflt);
+		for (k = 0; k < POPUP_MEMPROF_KINDS; k++)
+			fprintf(fp, " %6lu", s->kind_pss[k]);
+		fputc('\n', fp);
+		prev = s->pss;
+	}
+
+	/* Largest files of the last sample first */
+	for (i = 1; i < nfiles; i++) {
+		tmp = files[i];
+		for (j = i; j > 0 && files[j - 1].pss < tmp.pss; j--)
+			files[j] = files[j - 1];
+		files[j] = tmp;
+	}
+
+	fprintf(fp, "# pss by file at %s\n", samples[nsamples - 1].phase);
+	for (i = 0; i < nfiles && i < POPUP_MEMPROF_TOP; i++) {
+		f = &files[i];
+		fprintf(fp, "%7lu %-5s %s\n", f->pss, kind_name[f->kind], f->path);
+	}
+
+	fclose(fp);
+
+	s = &samples[nsamples - 1];
+	system_print("\n %s : memprof pss %lu kB rss %lu kB at %s \n",
+		     proc_name, s->pss, s->rss, s->phase);
+}
+
+/* Off unless db/private/system-popup/memprof is non-zero */
+void popup_memprof_init(const char *name)
+{
+	int val = 0;
+
+	if (name)
+		proc_name = name;
+	if (popup_vconf_get(POPUP_VCONF_MEMPROF, &val) < 0 || val == 0)
+		return;
+
+	enabled = 1;
+	t0 = now_us();
+	atexit(write_report);
+	popup_memprof_phase("start");
+}
+
+/* phase must be a string literal, it is written out later */
+void popup_memprof_phase(const char *phase)
+{
+	struct mem_sample *s;
+	struct rusage ru;
+	int i;
+
+	if (!enabled || nsamples == POPUP_MEMPROF_PHASES)
+		return;
+
+	for (i = 0; i < nsamples; i++)
+		if (strcmp(samples[i].phase, phase) == 0)
+			return;
+
+	s = &samples[nsamples];
+	memset(s, 0, sizeof(*s));
+	s->phase = phase;
+	s->ts = now_us() - t0;
+
+	/* Faults first, before the walk adds its own */
+	if (getrusage(RUSAGE_SELF, &ru) == 0) {
+		s->minflt = ru.ru_minflt;
+		s->majflt = ru.ru_majflt;
+	}
+
+	sample_smaps(s);
+	sample_rollup(s);
+	nsamples++;
+}
+
+static void first_render(void *data, Evas *e, void *event_info)
+{
+	evas_event_callback_del(e, EVAS_CALLBACK_RENDER_POST, first_render);
+	render_evas = NULL;
+	popup_memprof_phase("first_render");
+	write_report();
+}
+
+/* Sample the first frame the window renders, then write the report */
+void popup_memprof_watch(Evas_Object *win)
+{
+	if (!enabled || win == NULL || render_evas)
+		return;
+
+	render_evas = evas_object_evas_get(win);
+	if (render_evas)
+		evas_event_callback_add(render_evas, EVAS_CALLBACK_RENDER_POST,
+					first_render, NULL);
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Pool of popup widgets.
+ *
+ * Every show used to build an elm_popup and its styled buttons and every
+ * dismissal deleted them again, which a lingering or resident popup
+ * repeats for each request. The pool keeps one popup per window and
+ * button count. Buttons are created once with their style and a fixed
+ * "clicked" handler that forwards to whatever the current show set, so
+ * reuse only changes texts. The first build of each layout is timed and
+ * its heap growth measured, and every reuse is logged with the time and
+ * bytes it saved. With every slot taken a popup is still built the same
+ * way, on the heap, and deleted rather than kept when it is put back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "popup-pool.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+
+/* mallinfo() is deprecated from glibc 2.33 and its int fields wrap */
+#if defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2
+#endif
+#endif
+
+struct slot_btn {
+	Evas_Object *obj;
+	Evas_Smart_Cb cb;
+	void *data;
+};
+
+struct slot {
+	Evas_Object *win;
+	Evas_Object *popup;
+	int nbtn;
+	int busy;
+	int unpooled;			/* overflow, freed with the popup */
+	struct slot_btn btn[POPUP_POOL_BUTTONS];
+
+	double build_ms;		/* first construction */
+	long build_bytes;
+	unsigned int reuses;
+};
+
+static struct slot slots[POPUP_POOL_SLOTS];
+static Eina_List *overflow;
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void clicked(void *data, Evas_Object *obj, void *event_info)
+{
+	struct slot_btn *b = data;
+
+	if (b->cb)
+		b->cb(b->data, obj, event_info);
+}
+
+/* The window went away and took the popup with it */
+static void popup_gone(void *data, Evas *e, Evas_Object *obj, void *event_info)
+{
+	struct slot *s = data;
+
+	if (s->unpooled) {
+		overflow = eina_list_remove(overflow, s);
+		free(s);
+		return;
+	}
+	memset(s, 0, sizeof(*s));
+}
+
+static struct slot *find(Evas_Object *popup)
+{
+	struct slot *s;
+	Eina_List *l;
+	int i;
+
+	for (i = 0; i < POPUP_POOL_SLOTS; i++)
+		if (slots[i].popup && slots[i].popup == popup)
+			return &slots[i];
+	EINA_LIST_FOREACH(overflow, l, s)
+		if (s->popup == popup)
+			return s;
+	return NULL;
+}
+
+/* Bytes in use on the heap */
+static long heap_used(void)
+{
+#ifdef HAVE_MALLINFO2
+	return (long)mallinfo2().uordblks;
+#else
+	return (long)mallinfo().uordblks;
+#endif
+}
+
+static int build(struct slot *s, Evas_Object *win, int nbtn)
+{
+	long before;
+	char part[16];
+	double t;
+	int i;
+
+	t = now_ms();
+	before = heap_used();
+
+	s->popup = elm_popup_add(win);
+	if (s->popup == NULL)
+		return -1;
+	evas_object_size_hint_weight_set(s->popup, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+
+	for (i = 0; i < nbtn; i++) {
+		s->btn[i].obj = elm_button_add(s->popup);
+		elm_object_style_set(s->btn[i].obj, POPUP_POOL_BTN_STYLE);
+		snprintf(part, sizeof(part), "button%d", i + 1);
+		elm_object_part_content_set(s->popup, part, s->btn[i].obj);
+		evas_object_smart_callback_add(s->btn[i].obj, "clicked", clicked,
+					       &s->btn[i]);
+	}
+	evas_object_event_callback_add(s->popup, EVAS_CALLBACK_DEL, popup_gone, s);
+
+	s->win = win;
+	s->nbtn = nbtn;
+	s->build_ms = now_ms() - t;
+	s->build_bytes = heap_used() - before;
+
+	popup_stats_inc(POPUP_STAT_POOL_BUILD);
+	popup_log(POPUP_LOG_INFO, "pool: built popup+%d buttons in %dus, %ld bytes",
+		  nbtn, (int)(s->build_ms * 1000), s->build_bytes);
+	return 0;
+}
+
+/* A hidden popup with nbtn styled buttons, built on first use */
+Evas_Object *popup_pool_get(Evas_Object *win, int nbtn)
+{
+	struct slot *s, *free_slot = NULL;
+	int i;
+
+	if (win == NULL || nbtn < 0 || nbtn > POPUP_POOL_BUTTONS)
+		return NULL;
+
+	for (i = 0; i < POPUP_POOL_SLOTS; i++) {
+		s = &slots[i];
+		if (s->popup == NULL) {
+			if (free_slot == NULL)
+				free_slot = s;
+			continue;
+		}
+		if (s->busy || s->win != win || s->nbtn != nbtn)
+			continue;
+
+		s->busy = 1;
+		s->reuses++;
+		popup_stats_inc(POPUP_STAT_POOL_REUSE);
+		if (s->build_bytes > 0)
+			popup_stats_add(POPUP_STAT_POOL_SAVED_BYTES, s->build_bytes);
+		popup_log(POPUP_LOG_INFO, "pool: reuse %u of popup+%d buttons, saved %dus, %ld bytes",
+			  s->reuses, nbtn, (int)(s->build_ms * 1000), s->build_bytes);
+		return s->popup;
+	}
+
+	/* No spare layout slot, build one that is not kept */
+	if (free_slot == NULL) {
+		s = calloc(1, sizeof(*s));
+		if (s == NULL)
+			return NULL;
+		s->unpooled = 1;
+		if (build(s, win, nbtn) < 0) {
+			free(s);
+			return NULL;
+		}
+		s->busy = 1;
+		overflow = eina_list_append(overflow, s);
+		return s->popup;
+	}
+
+	if (build(free_slot, win, nbtn) < 0) {
+		memset(free_slot, 0, sizeof(*free_slot));
+		return NULL;
+	}
+	free_slot->busy = 1;
+	return free_slot->popup;
+}
+
+void popup_pool_button_set(Evas_Object *popup, int idx, const char *text,
+			   Evas_Smart_Cb cb, void *data)
+{
+	struct slot *s = find(popup);
+
+	if (s == NULL || idx < 0 || idx >= s->nbtn)
+		return;
+
+	elm_object_text_set(s->btn[idx].obj, text);
+	s->btn[idx].cb = cb;
+	s->btn[idx].data = data;
+}
+
+/* Instead of evas_object_del(): hide and keep for the next show */
+void popup_pool_put(Evas_Object *popup)
+{
+	struct slot *s;
+	int i;
+
+	if (popup == NULL)
+		return;
+
+	s = find(popup);
+	if (s == NULL || s->unpooled) {
+		evas_object_del(popup);
+		return;
+	}
+
+	evas_object_hide(popup);
+	for (i = 0; i < s->nbtn; i++) {
+		s->btn[i].cb = NULL;
+		s->btn[i].data = NULL;
+	}
+	s->busy = 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Screen geometry shared between popup launches.
+ *
+ * create_win() used to ask the X server for the root window size on
+ * every launch. The geometry is now kept in a small shared segment
+ * under a sequence lock. A launch reads the segment without talking to
+ * the server as long as the publisher is alive or the entry is recent,
+ * otherwise it queries once and publishes the result. Only a process
+ * that published listens for RandR screen changes and root rotation
+ * changes and republishes them, so a launch served from the segment
+ * sends no request at all.
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <Ecore.h>
+#include <Ecore_X.h>
+#include "popup-screen.h"
+#include "popup-stats.h"
+
+#define POPUP_SCREEN_MAGIC	0x52435053	/* "SPCR" */
+#define POPUP_SCREEN_SPINS	1000	/* lock retries before giving up */
+
+struct popup_screen_shm {
+	uint32_t magic;
+	uint32_t seq;			/* odd while being updated */
+	pid_t publisher;		/* last writer, set first */
+	uint32_t root;
+	int32_t w;
+	int32_t h;
+	int32_t angle;
+	int64_t stamp;			/* CLOCK_MONOTONIC seconds */
+};
+
+static struct popup_screen_shm *shm = NULL;
+static int listening = 0;
+static int queries = 0;			/* round trips made */
+static int cached = 0;			/* round trips avoided */
+
+static int64_t now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
+
+static int alive(pid_t pid)
+{
+	if (pid <= 0)
+		return 0;
+	return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static struct popup_screen_shm *map_shm(void)
+{
+	struct popup_screen_shm *p;
+	int fd;
+
+	fd = shm_open(POPUP_SCREEN_SHM_NAME, O_RDWR | O_CREAT, 0660);
+	if (fd < 0)
+		return NULL;
+
+	if (ftruncate(fd, sizeof(*p)) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	p = mmap(NULL, sizeof(*p), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	return p;
+}
+
+/*
+ * Any popup may publish, so writers take the odd count in turn. A writer
+ * killed inside an update leaves seq odd; once its pid is gone the next
+ * writer takes the update over instead of waiting for it forever.
+ */
+static void publish(Ecore_X_Window root, int w, int h, int angle)
+{
+	pid_t self = getpid();
+	pid_t prev;
+	uint32_t seq, next;
+	int spins;
+
+	if (shm == NULL)
+		return;
+
+	for (spins = 0;; spins++) {
+		if (spins == POPUP_SCREEN_SPINS)
+			return;
+		seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+		next = seq + 1;
+		if (seq & 1) {
+			prev = __atomic_load_n(&shm->publisher, __ATOMIC_RELAXED);
+			if (prev != self && alive(prev))
+				continue;
+			next = seq + 2;
+		}
+		if (__atomic_compare_exchange_n(&shm->seq, &seq, next, 0,
+						__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			break;
+	}
+
+	__atomic_store_n(&shm->publisher, self, __ATOMIC_RELAXED);
+	shm->root = root;
+	shm->w = w;
+	shm->h = h;
+	shm->angle = angle;
+	shm->stamp = now_sec();
+	__atomic_store_n(&shm->magic, POPUP_SCREEN_MAGIC, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->seq, next + 1, __ATOMIC_RELEASE);
+}
+
+static int read_angle(Ecore_X_Window root)
+{
+	unsigned int angle = 0;
+
+	if (ecore_x_window_prop_card32_get(root,
+				ECORE_X_ATOM_E_ILLUME_ROTATE_ROOT_ANGLE,
+				&angle, 1) != 1)
+		return 0;
+	return angle;
+}
+
+/* Synchronous query, kept off the show path when the cache is good */
+static void query(Ecore_X_Window root, int *w, int *h, int *angle)
+{
+	queries++;
+	popup_stats_inc(POPUP_STAT_SCREEN_QUERY);
+	ecore_x_window_size_get(root, w, h);
+	*angle = read_angle(root);
+}
+
+static Eina_Bool screen_changed(void *data, int type, void *event)
+{
+	Ecore_X_Window root = ecore_x_window_root_first_get();
+	int w, h, angle;
+
+	query(root, &w, &h, &angle);
+	publish(root, w, h, angle);
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+static Eina_Bool root_prop_changed(void *data, int type, void *event)
+{
+	Ecore_X_Event_Window_Property *ev = event;
+
+	if (ev->atom != ECORE_X_ATOM_E_ILLUME_ROTATE_ROOT_ANGLE ||
+	    ev->win != ecore_x_window_root_first_get())
+		return ECORE_CALLBACK_PASS_ON;
+
+	return screen_changed(data, type, event);
+}
+
+/*
+ * Selecting property events reads the root attributes first to keep the
+ * existing mask, one more round trip, so only the publisher pays it.
+ */
+static void listen_changes(Ecore_X_Window root)
+{
+	if (listening)
+		return;
+	listening = 1;
+
+	ecore_x_randr_events_select(root, EINA_TRUE);
+	ecore_x_event_mask_set(root, ECORE_X_EVENT_MASK_WINDOW_PROPERTY);
+	ecore_event_handler_add(ECORE_X_EVENT_SCREEN_CHANGE, screen_changed, NULL);
+	ecore_event_handler_add(ECORE_X_EVENT_WINDOW_PROPERTY,
+				root_prop_changed, NULL);
+}
+
+/* A stuck update makes the caller query the server instead */
+static int read_cache(Ecore_X_Window root, int *w, int *h, int *angle)
+{
+	struct popup_screen_shm c;
+	uint32_t seq;
+	int spins = 0;
+
+	if (shm == NULL ||
+	    __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != POPUP_SCREEN_MAGIC)
+		return -1;
+
+	do {
+		if (spins++ == POPUP_SCREEN_SPINS)
+			return -1;
+		seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+		c = *shm;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((seq & 1) || seq != __atomic_load_n(&shm->seq, __ATOMIC_RELAXED));
+
+	if (c.root != root || c.w <= 0 || c.h <= 0)
+		return -1;
+	if (!alive(c.publisher) && now_sec() - c.stamp > POPUP_SCREEN_TRUST_SEC)
+		return -1;
+
+	*w = c.w;
+	*h = c.h;
+	*angle = c.angle;
+	return 0;
+}
+
+/* Root window geometry for create_win() */
+int popup_screen_get(int *w, int *h, int *angle)
+{
+	Ecore_X_Window root = ecore_x_window_root_first_get();
+	int sw, sh, sa;
+
+	if (shm == NULL)
+		shm = map_shm();
+
+	if (read_cache(root, &sw, &sh, &sa) == 0) {
+		cached++;
+		popup_stats_inc(POPUP_STAT_SCREEN_CACHED);
+	} else {
+		query(root, &sw, &sh, &sa);
+		publish(root, sw, sh, sa);
+		listen_changes(root);
+	}
+
+	if (w)
+		*w = sw;
+	if (h)
+		*h = sh;
+	if (angle)
+		*angle = sa;
+	return 0;
+}
+
+/* Geometry from the segment only, -1 rather than asking the server */
+int popup_screen_cached(int *w, int *h, int *angle)
+{
+	int sw, sh, sa;
+
+	if (shm == NULL)
+		shm = map_shm();
+
+	if (read_cache(ecore_x_window_root_first_get(), &sw, &sh, &sa) < 0)
+		return -1;
+
+	if (w)
+		*w = sw;
+	if (h)
+		*h = sh;
+	if (angle)
+		*angle = sa;
+	return 0;
+}
+
+/* Root queries made and avoided in this process */
+void popup_screen_stats(int *nqueries, int *ncached)
+{
+	if (nqueries)
+		*nqueries = queries;
+	if (ncached)
+		*ncached = cached;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Per popup type counters in shared memory.
+ *
+ * Every popup process maps the same segment and bumps its own block with
+ * relaxed atomic adds, so counting costs no syscall and no lock. The
+ * segment outlives the processes and tools/popup-stats reads it.
+ * Processes also claim a pid slot in their block, so the number of
+ * running popups stays right when one is killed without running exit
+ * handlers.
+ */
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "popup-stats.h"
+#include "popup-log.h"
+
+static struct popup_stats_block *blk = NULL;
+static int32_t *slot = NULL;
+
+/* Take a free slot or one left by a process that died */
+static void claim_slot(void)
+{
+	int32_t self = getpid();
+	int32_t cur;
+	int i;
+
+	for (i = 0; i < POPUP_STATS_PIDS; i++) {
+		cur = __atomic_load_n(&blk->pid[i], __ATOMIC_RELAXED);
+		if (popup_stats_pid_alive(cur))
+			continue;
+		if (__atomic_compare_exchange_n(&blk->pid[i], &cur, self, 0,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			slot = &blk->pid[i];
+			return;
+		}
+	}
+}
+
+static void stats_exit(void)
+{
+	int32_t self = getpid();
+
+	if (slot)
+		__atomic_compare_exchange_n(slot, &self, 0, 0,
+					    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static struct popup_stats_shm *map_shm(void)
+{
+	struct popup_stats_shm *p;
+	struct stat st;
+	uint32_t zero = 0;
+	int fd;
+
+	fd = shm_open(POPUP_STATS_SHM_NAME, O_RDWR | O_CREAT, 0664);
+	if (fd < 0)
+		return NULL;
+
+	/* Never shrink a segment another build may still be using */
+	if (fstat(fd, &st) < 0 ||
+	    (st.st_size < (off_t)sizeof(*p) && ftruncate(fd, sizeof(*p)) < 0)) {
+		close(fd);
+		return NULL;
+	}
+
+	p = mmap(NULL, sizeof(*p), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	/* First user stamps the layout, a fresh segment reads as zero */
+	if (__atomic_load_n(&p->magic, __ATOMIC_ACQUIRE) != POPUP_STATS_MAGIC) {
+		p->version = POPUP_STATS_VERSION;
+		p->ntypes = POPUP_TYPE_MAX;
+		p->nctr = POPUP_STAT_MAX;
+		p->ngauge = POPUP_GAUGE_MAX;
+		p->npid = POPUP_STATS_PIDS;
+		__atomic_compare_exchange_n(&p->magic, &zero, POPUP_STATS_MAGIC,
+					    0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+	}
+
+	if (p->version != POPUP_STATS_VERSION || p->ntypes != POPUP_TYPE_MAX ||
+	    p->nctr != POPUP_STAT_MAX || p->ngauge != POPUP_GAUGE_MAX ||
+	    p->npid != POPUP_STATS_PIDS) {
+		/*
+		 * Left by an older build that may still be running, so leave
+		 * it alone and go without counters until it is gone.
+		 */
+		system_print("\n popup-stats : segment layout mismatch \n");
+		munmap(p, sizeof(*p));
+		return NULL;
+	}
+
+	return p;
+}
+
+/* Attach and count this process as a launch of the given type */
+int popup_stats_init(int type)
+{
+	struct popup_stats_shm *p;
+
+	if (blk)
+		return 0;
+	if (type < 0 || type >= POPUP_TYPE_MAX)
+		return -1;
+
+	p = map_shm();
+	if (p == NULL)
+		return -1;
+
+	blk = &p->type[type];
+	claim_slot();
+	atexit(stats_exit);
+
+	return 0;
+}
+
+void popup_stats_add(int ctr, uint64_t n)
+{
+	if (blk == NULL || ctr < 0 || ctr >= POPUP_STAT_MAX)
+		return;
+	__atomic_fetch_add(&blk->ctr[ctr], n, __ATOMIC_RELAXED);
+}
+
+void popup_stats_gauge_set(int gauge, int64_t val)
+{
+	if (blk == NULL || gauge < 0 || gauge >= POPUP_GAUGE_MAX)
+		return;
+	__atomic_store_n(&blk->gauge[gauge], val, __ATOMIC_RELAXED);
+}
+
+void popup_stats_gauge_add(int gauge, int64_t delta)
+{
+	if (blk == NULL || gauge < 0 || gauge >= POPUP_GAUGE_MAX)
+		return;
+	__atomic_fetch_add(&blk->gauge[gauge], delta, __ATOMIC_RELAXED);
+}
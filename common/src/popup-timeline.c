@@ -0,0 +1,173 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Shutdown timeline recorder.
+ *
+ * Each run takes the next slot of a small ring file, a pair of records,
+ * and every mark rewrites the older record of the pair with pwrite() and
+ * fdatasync(). Whatever was reached before the power went away is there
+ * after the next boot, and a write torn by it leaves the other record.
+ * popup-timeline reads the file back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "popup-timeline.h"
+#include "popup-log.h"
+
+#define BOOT_ID_PATH	"/proc/sys/kernel/random/boot_id"
+
+static struct popup_timeline_rec rec;
+static off_t rec_off;			/* first record of the pair */
+static int fd = -1;
+
+static uint64_t clock_ns(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int valid(const struct popup_timeline_rec *r)
+{
+	struct popup_timeline_rec tmp;
+
+	if (r->magic != POPUP_TIMELINE_MAGIC ||
+	    r->version != POPUP_TIMELINE_VERSION ||
+	    r->nstage > POPUP_TIMELINE_STAGES)
+		return 0;
+	tmp = *r;
+	tmp.crc = 0;
+	return popup_timeline_crc(&tmp, sizeof(tmp)) == r->crc;
+}
+
+static void read_boot_id(char *buf, size_t n)
+{
+	ssize_t len;
+	int bfd;
+
+	buf[0] = '\0';
+	bfd = open(BOOT_ID_PATH, O_RDONLY | O_CLOEXEC);
+	if (bfd < 0)
+		return;
+	len = read(bfd, buf, n - 1);
+	close(bfd);
+	if (len <= 0)
+		len = 0;
+	buf[len] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+}
+
+static void flush(void)
+{
+	off_t off;
+
+	rec.crc = 0;
+	rec.crc = popup_timeline_crc(&rec, sizeof(rec));
+	off = rec_off + (off_t)(rec.nstage % POPUP_TIMELINE_COPIES) * sizeof(rec);
+	if (pwrite(fd, &rec, sizeof(rec), off) != sizeof(rec) ||
+	    fdatasync(fd) < 0)
+		popup_log(POPUP_LOG_WARN, "timeline: write failed");
+}
+
+/* Claim the slot after the newest run */
+int popup_timeline_begin(void)
+{
+	struct popup_timeline_rec r;
+	const char *path;
+	struct stat st;
+	uint32_t seq = 0;
+	int i;
+
+	if (fd >= 0)
+		return 0;
+
+	path = getenv(POPUP_TIMELINE_ENV);
+	if (path == NULL || path[0] == '\0') {
+		path = POPUP_TIMELINE_PATH;
+		mkdir(POPUP_TIMELINE_DIR, 0755);
+	}
+
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0640);
+	if (fd < 0) {
+		system_print("timeline: cannot open %s\n", path);
+		return -1;
+	}
+
+	if (fstat(fd, &st) == 0 &&
+	    st.st_size < (off_t)(POPUP_TIMELINE_SLOTS * POPUP_TIMELINE_COPIES *
+				 sizeof(rec))) {
+		if (ftruncate(fd, POPUP_TIMELINE_SLOTS * POPUP_TIMELINE_COPIES *
+			      sizeof(rec)) < 0 ||
+		    fsync(fd) < 0) {
+			close(fd);
+			fd = -1;
+			return -1;
+		}
+	}
+
+	for (i = 0; i < POPUP_TIMELINE_SLOTS * POPUP_TIMELINE_COPIES; i++) {
+		if (pread(fd, &r, sizeof(r), i * sizeof(r)) != sizeof(r))
+			break;
+		if (valid(&r) && r.seq > seq)
+			seq = r.seq;
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	rec.magic = POPUP_TIMELINE_MAGIC;
+	rec.version = POPUP_TIMELINE_VERSION;
+	rec.seq = seq + 1;
+	rec.pid = getpid();
+	rec.real_ns = clock_ns(CLOCK_REALTIME);
+	rec.mono_ns = clock_ns(CLOCK_MONOTONIC);
+	read_boot_id(rec.boot_id, sizeof(rec.boot_id));
+	rec_off = (off_t)(rec.seq % POPUP_TIMELINE_SLOTS) *
+		POPUP_TIMELINE_COPIES * sizeof(rec);
+
+	return 0;
+}
+
+/* Record a stage and make it durable before returning */
+void popup_timeline_mark(const char *stage)
+{
+	struct popup_timeline_stage *s;
+
+	if (fd < 0 || stage == NULL || rec.nstage >= POPUP_TIMELINE_STAGES)
+		return;
+
+	s = &rec.stage[rec.nstage++];
+	s->us = (uint32_t)((clock_ns(CLOCK_MONOTONIC) - rec.mono_ns) / 1000);
+	strncpy(s->name, stage, sizeof(s->name) - 1);
+	flush();
+}
+
+void popup_timeline_end(void)
+{
+	if (fd < 0)
+		return;
+	close(fd);
+	fd = -1;
+}
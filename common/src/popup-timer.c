@@ -0,0 +1,239 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Hashed timer wheel for popup timeouts.
+ *
+ * Timers hang off POPUP_TIMER_SLOTS doubly linked slots and are armed
+ * and cancelled in constant time. A timerfd in the Ecore main loop
+ * advances the wheel every POPUP_TIMER_TICK_MS while timers are armed
+ * and is disarmed when the wheel is empty. Late firing is measured
+ * against the due time of every timer.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/timerfd.h>
+#include <Ecore.h>
+#include "popup-timer.h"
+
+struct wheel {
+	struct popup_timer slot[POPUP_TIMER_SLOTS];	/* list heads */
+	unsigned int cur;
+	uint64_t tick_time;		/* ms of the slot being processed */
+	int armed;
+	int fd;
+	Ecore_Fd_Handler *handler;
+
+	struct popup_timer_stats st;
+	uint64_t late_sum;
+};
+
+static struct wheel w = { .fd = -1 };
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void fd_arm(int on)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	if (on) {
+		its.it_value.tv_nsec = POPUP_TIMER_TICK_MS * 1000000L;
+		its.it_interval.tv_nsec = POPUP_TIMER_TICK_MS * 1000000L;
+	}
+	timerfd_settime(w.fd, 0, &its, NULL);
+}
+
+static void unlink_timer(struct popup_timer *t)
+{
+	t->prev->next = t->next;
+	t->next->prev = t->prev;
+	t->next = t->prev = NULL;
+	w.armed--;
+}
+
+static void move_timer(struct popup_timer *t, struct popup_timer *head)
+{
+	t->prev->next = t->next;
+	t->next->prev = t->prev;
+	t->prev = head->prev;
+	t->next = head;
+	head->prev->next = t;
+	head->prev = t;
+}
+
+static void expire_slot(uint64_t now)
+{
+	struct popup_timer *head = &w.slot[w.cur];
+	struct popup_timer done;
+	struct popup_timer *t, *next;
+	unsigned int late;
+
+	/*
+	 * Detach the expired timers first, callbacks may arm or cancel
+	 * any timer including the ones still waiting to fire here.
+	 */
+	done.next = done.prev = &done;
+	for (t = head->next; t != head; t = next) {
+		next = t->next;
+		if (t->rounds) {
+			t->rounds--;
+			continue;
+		}
+		move_timer(t, &done);
+	}
+
+	while (done.next != &done) {
+		t = done.next;
+		unlink_timer(t);
+		late = now > t->due ? now - t->due : 0;
+		w.st.fired++;
+		w.late_sum += late;
+		if (late > w.st.late_max_ms)
+			w.st.late_max_ms = late;
+		t->cb(t->data);
+	}
+}
+
+static Eina_Bool tick_cb(void *data, Ecore_Fd_Handler *fd_handler)
+{
+	uint64_t expirations = 0;
+	uint64_t now;
+
+	if (read(w.fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+		return ECORE_CALLBACK_RENEW;
+
+	/* Catch up on every tick missed while the loop was busy */
+	now = now_ms();
+	while (expirations-- && w.armed) {
+		w.cur = (w.cur + 1) & (POPUP_TIMER_SLOTS - 1);
+		w.tick_time += POPUP_TIMER_TICK_MS;
+		expire_slot(now);
+	}
+
+	if (!w.armed)
+		fd_arm(0);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+int popup_timer_init(void)
+{
+	int i;
+
+	if (w.fd >= 0)
+		return 0;
+
+	for (i = 0; i < POPUP_TIMER_SLOTS; i++)
+		w.slot[i].next = w.slot[i].prev = &w.slot[i];
+
+	w.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (w.fd < 0)
+		return -1;
+
+	w.handler = ecore_main_fd_handler_add(w.fd, ECORE_FD_READ, tick_cb,
+					      NULL, NULL, NULL);
+	if (w.handler == NULL) {
+		close(w.fd);
+		w.fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+void popup_timer_fini(void)
+{
+	if (w.fd < 0)
+		return;
+
+	ecore_main_fd_handler_del(w.handler);
+	close(w.fd);
+	memset(&w, 0, sizeof(w));
+	w.fd = -1;
+}
+
+/* Arm or re-arm a timer to fire once after ms */
+int popup_timer_arm(struct popup_timer *t, unsigned int ms,
+		    popup_timer_cb cb, void *data)
+{
+	struct popup_timer *head;
+	unsigned int ticks;
+
+	if (t == NULL || cb == NULL || (w.fd < 0 && popup_timer_init() < 0))
+		return -1;
+
+	if (t->next)
+		unlink_timer(t);
+
+	if (!w.armed) {
+		/* Restart the wheel from the current time */
+		w.tick_time = now_ms();
+		fd_arm(1);
+	}
+
+	ticks = (ms + POPUP_TIMER_TICK_MS - 1) / POPUP_TIMER_TICK_MS;
+	if (ticks == 0)
+		ticks = 1;
+
+	t->cb = cb;
+	t->data = data;
+	t->due = now_ms() + ms;
+	t->rounds = (ticks - 1) / POPUP_TIMER_SLOTS;
+
+	head = &w.slot[(w.cur + ticks) & (POPUP_TIMER_SLOTS - 1)];
+	t->prev = head->prev;
+	t->next = head;
+	head->prev->next = t;
+	head->prev = t;
+	w.armed++;
+
+	return 0;
+}
+
+void popup_timer_cancel(struct popup_timer *t)
+{
+	if (t == NULL || t->next == NULL)
+		return;
+
+	unlink_timer(t);
+	w.st.cancelled++;
+	if (!w.armed && w.fd >= 0)
+		fd_arm(0);
+}
+
+int popup_timer_armed(const struct popup_timer *t)
+{
+	return t && t->next != NULL;
+}
+
+void popup_timer_stats_get(struct popup_timer_stats *st)
+{
+	if (st == NULL)
+		return;
+
+	*st = w.st;
+	st->late_avg_ms = w.st.fired ? w.late_sum / w.st.fired : 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Chrome trace-event recorder for the popup show pipeline.
+ *
+ * Spans are kept in a fixed table and written as trace-event JSON at
+ * exit, ready for chrome://tracing or ui.perfetto.dev. Every request
+ * gets a trace id, taken from the requester's bundle when it sent one,
+ * and all spans of that request carry it. An async span with the same
+ * id runs from app_reset() to the first frame rendered, so it lines up
+ * with a trace of the requesting process, and that first frame is timed
+ * as a span of its own. Tracing is off unless the trace vconf key is set.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "popup-trace.h"
+#include "popup-vconf.h"
+#include "popup-log.h"
+
+enum {
+	EV_COMPLETE,
+	EV_INSTANT,
+	EV_ASYNC_BEGIN,
+	EV_ASYNC_END,
+};
+
+struct trace_event {
+	const char *name;
+	uint64_t ts;			/* us, CLOCK_MONOTONIC */
+	uint64_t dur;
+	uint64_t id;			/* request trace id */
+	uint32_t tid;
+	int type;
+};
+
+static struct trace_event events[POPUP_TRACE_MAX_EVENTS];
+static unsigned int nevents = 0;
+static unsigned int dropped = 0;
+
+static int enabled = 0;
+static const char *proc_name = "popup";
+static uint64_t cur_id = 0;
+static unsigned int nrequests = 0;
+static Evas *render_evas = NULL;
+static uint64_t frame_start = 0;
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void add(int type, const char *name, uint64_t ts, uint64_t dur)
+{
+	struct trace_event *e;
+	unsigned int i;
+
+	i = __atomic_fetch_add(&nevents, 1, __ATOMIC_RELAXED);
+	if (i >= POPUP_TRACE_MAX_EVENTS) {
+		__atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	e = &events[i];
+	e->type = type;
+	e->name = name;
+	e->ts = ts;
+	e->dur = dur;
+	e->id = cur_id;
+	e->tid = (uint32_t)syscall(SYS_gettid);
+}
+
+static void write_json(void)
+{
+	static const char ph[] = { 'X', 'i', 'b', 'e' };
+	struct trace_event *e;
+	char path[128];
+	unsigned int i, n;
+	FILE *fp;
+	int fd, pid = getpid();
+
+	n = nevents < POPUP_TRACE_MAX_EVENTS ? nevents : POPUP_TRACE_MAX_EVENTS;
+	if (n == 0)
+		return;
+
+	snprintf(path, sizeof(path), POPUP_TRACE_FILE_FMT, proc_name, pid);
+	fd = popup_private_open(path);
+	fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (fp == NULL) {
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(fp, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+		"\"args\":{\"name\":\"%s\"}}", pid, proc_name);
+
+	for (i = 0; i < n; i++) {
+		e = &events[i];
+		fprintf(fp, ",\n{\"ph\":\"%c\",\"cat\":\"syspopup\",\"name\":\"%s\","
+			"\"pid\":%d,\"tid\":%u,\"ts\":%llu",
+			ph[e->type], e->name, pid, e->tid,
+			(unsigned long long)e->ts);
+		if (e->type == EV_COMPLETE)
+			fprintf(fp, ",\"dur\":%llu", (unsigned long long)e->dur);
+		else if (e->type == EV_INSTANT)
+			fprintf(fp, ",\"s\":\"t\"");
+		else
+			fprintf(fp, ",\"id\":\"0x%llx\"", (unsigned long long)e->id);
+		fprintf(fp, ",\"args\":{\"trace_id\":\"0x%llx\"}}",
+			(unsigned long long)e->id);
+	}
+
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+
+	if (dropped)
+		system_print("\n %s : trace full, %u events dropped \n",
+			     proc_name, dropped);
+}
+
+/* Off unless db/private/system-popup/trace is non-zero */
+void popup_trace_init(const char *name)
+{
+	int val = 0;
+
+	if (name)
+		proc_name = name;
+	if (popup_vconf_get(POPUP_VCONF_TRACE, &val) < 0 || val == 0)
+		return;
+
+	enabled = 1;
+	atexit(write_json);
+}
+
+static void frame_begin(void *data, Evas *e, void *event_info)
+{
+	evas_event_callback_del(e, EVAS_CALLBACK_RENDER_PRE, frame_begin);
+	frame_start = now_us();
+}
+
+/* The first frame holds the text layout and glyph loads of the popup */
+static void first_render(void *data, Evas *e, void *event_info)
+{
+	uint64_t now = now_us();
+
+	evas_event_callback_del(e, EVAS_CALLBACK_RENDER_POST, first_render);
+	render_evas = NULL;
+	if (frame_start) {
+		add(EV_COMPLETE, "first_frame", frame_start, now - frame_start);
+		frame_start = 0;
+	}
+	add(EV_ASYNC_END, "request", now, 0);
+}
+
+/* From app_reset(): start the request span, ended by the next frame */
+void popup_trace_request(bundle *b, Evas_Object *win)
+{
+	const char *id = NULL;
+
+	if (!enabled)
+		return;
+
+	if (b)
+		id = bundle_get_val(b, POPUP_TRACE_BUNDLE_KEY);
+	if (id)
+		cur_id = strtoull(id, NULL, 0);
+	else
+		cur_id = ((uint64_t)getpid() << 16) | (++nrequests & 0xffff);
+
+	add(EV_ASYNC_BEGIN, "request", now_us(), 0);
+
+	if (win && render_evas == NULL) {
+		render_evas = evas_object_evas_get(win);
+		if (render_evas) {
+			evas_event_callback_add(render_evas, EVAS_CALLBACK_RENDER_PRE,
+						frame_begin, NULL);
+			evas_event_callback_add(render_evas, EVAS_CALLBACK_RENDER_POST,
+						first_render, NULL);
+		}
+	}
+}
+
+uint64_t popup_trace_begin(void)
+{
+	return enabled ? now_us() : 0;
+}
+
+/* name must be a string literal, it is written out at exit */
+void popup_trace_end(const char *name, uint64_t start)
+{
+	if (!enabled || start == 0)
+		return;
+	add(EV_COMPLETE, name, start, now_us() - start);
+}
+
+void popup_trace_instant(const char *name)
+{
+	if (!enabled)
+		return;
+	add(EV_INSTANT, name, now_us(), 0);
+}
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Read-mostly snapshot of the vconf keys used by the popups.
+ *
+ * The first popup process that finds no live snapshot owns it. Keys are
+ * read from vconf only when a popup first asks for them; the owner then
+ * publishes the value in a shared memory segment and keeps it current
+ * through a change notification on that key alone. Other launches read
+ * published keys under a sequence lock and go to vconf for the rest, so
+ * no launch makes more round trips than it would without the snapshot.
+ *
+ * The segment is only trusted when this user created it and nobody else
+ * can write it, and keys that decide whether a popup shows at all are
+ * never taken from it.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <vconf.h>
+#include <vconf-keys.h>
+#include "popup-vconf.h"
+#include "popup-log.h"
+
+#define POPUP_VCONF_MAGIC	0x53505643	/* "SPVC" */
+#define POPUP_VCONF_VERSION	1
+#define POPUP_VCONF_SPINS	1000	/* reader retries before giving up */
+
+#ifndef VCONFKEY_TESTMODE_LOW_BATT_POPUP
+#define VCONFKEY_TESTMODE_LOW_BATT_POPUP	"db/testmode/low_batt_popup"
+#endif
+
+/* Appending keys changes 'size', so older readers ignore the segment */
+struct popup_vconf_shm {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t size;			/* sizeof(struct popup_vconf_shm) */
+	uint32_t seq;			/* odd while the owner updates */
+	pid_t owner;			/* process holding the notifications */
+	uint32_t valid;			/* bit per key published */
+	int val[POPUP_VCONF_MAX];
+};
+
+/* One bit per key in 'valid' */
+typedef char popup_vconf_keys_fit[POPUP_VCONF_MAX <= 32 ? 1 : -1];
+
+enum {
+	KEY_INT,
+	KEY_BOOL,
+	KEY_DIRECT = 0x10,		/* always read from vconf */
+};
+
+static const struct {
+	const char *key;
+	int type;
+} keys[POPUP_VCONF_MAX] = {
+	/* Suppresses the shutdown popup, not to be taken from shared memory */
+	[POPUP_VCONF_TESTMODE_LOWBATT] = { VCONFKEY_TESTMODE_LOW_BATT_POPUP,
+					   KEY_INT | KEY_DIRECT },
+	[POPUP_VCONF_SOUND_ON] = { VCONFKEY_SETAPPL_SOUND_STATUS_BOOL, KEY_BOOL },
+	[POPUP_VCONF_VIBRATION_ON] = { VCONFKEY_SETAPPL_VIBRATION_STATUS_BOOL, KEY_BOOL },
+	[POPUP_VCONF_LINGER_SEC] = { VCONFKEY_SYSPOPUP_LINGER_SEC, KEY_INT },
+	[POPUP_VCONF_LOG_LEVEL] = { VCONFKEY_SYSPOPUP_LOG_LEVEL, KEY_INT },
+	[POPUP_VCONF_TRACE] = { VCONFKEY_SYSPOPUP_TRACE, KEY_INT },
+	[POPUP_VCONF_BATT_MONITOR] = { VCONFKEY_SYSPOPUP_BATT_MONITOR, KEY_INT },
+	[POPUP_VCONF_MEMPROF] = { VCONFKEY_SYSPOPUP_MEMPROF, KEY_INT },
+	[POPUP_VCONF_USB_MONITOR] = { VCONFKEY_SYSPOPUP_USB_MONITOR, KEY_INT },
+};
+
+static struct popup_vconf_shm *shm = NULL;
+static int attached = 0;		/* init ran */
+static int owner = 0;			/* this process keeps values current */
+static uint32_t watched = 0;		/* keys with a change notification */
+static int reads = 0;			/* vconf round trips made */
+static int hits = 0;			/* reads served by the snapshot */
+
+/* Owner copy used when shared memory is not available */
+static int local_val[POPUP_VCONF_MAX];
+
+static int read_key(int id, int *val)
+{
+	reads++;
+	if ((keys[id].type & ~KEY_DIRECT) == KEY_BOOL)
+		return vconf_get_bool(keys[id].key, val);
+	return vconf_get_int(keys[id].key, val);
+}
+
+static void store(int id, int val)
+{
+	if (shm == NULL) {
+		local_val[id] = val;
+		return;
+	}
+
+	__atomic_add_fetch(&shm->seq, 1, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&shm->val[id], val, __ATOMIC_RELAXED);
+	__atomic_or_fetch(&shm->valid, 1U << id, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&shm->seq, 1, __ATOMIC_RELEASE);
+}
+
+/* Change notification from vconf */
+static void key_changed(keynode_t *node, void *data)
+{
+	int id = (int)(intptr_t)data;
+
+	if (node == NULL || id < 0 || id >= POPUP_VCONF_MAX)
+		return;
+
+	if ((keys[id].type & ~KEY_DIRECT) == KEY_BOOL)
+		store(id, vconf_keynode_get_bool(node));
+	else
+		store(id, vconf_keynode_get_int(node));
+}
+
+/* Publish a key read from vconf and follow its changes */
+static void watch(int id, int val)
+{
+	store(id, val);
+	if (vconf_notify_key_changed(keys[id].key, key_changed,
+				     (void *)(intptr_t)id) == 0)
+		watched |= 1U << id;
+	else if (shm)
+		__atomic_and_fetch(&shm->valid, ~(1U << id), __ATOMIC_RELEASE);
+}
+
+static int owner_alive(pid_t pid)
+{
+	if (pid <= 0)
+		return 0;
+	if (kill(pid, 0) == 0 || errno == EPERM)
+		return 1;
+	return 0;
+}
+
+static int layout_ok(const struct popup_vconf_shm *p)
+{
+	return __atomic_load_n(&p->magic, __ATOMIC_ACQUIRE) == POPUP_VCONF_MAGIC &&
+		p->version == POPUP_VCONF_VERSION && p->size == sizeof(*p);
+}
+
+static struct popup_vconf_shm *map_shm(void)
+{
+	struct popup_vconf_shm *p;
+	struct stat st;
+	int fd;
+
+	fd = shm_open(POPUP_VCONF_SHM_NAME, O_RDWR | O_CREAT, 0600);
+	if (fd < 0)
+		return NULL;
+
+	/* /dev/shm is world writable, anyone could have made it first */
+	if (fstat(fd, &st) < 0 || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH))) {
+		system_print("\n system-popup : %s not ours, ignored \n",
+			     POPUP_VCONF_SHM_NAME);
+		close(fd);
+		return NULL;
+	}
+
+	/* Never shrink a segment a newer layout may still be using */
+	if (st.st_size < (off_t)sizeof(*p) && ftruncate(fd, sizeof(*p)) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	p = mmap(NULL, sizeof(*p), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	return p;
+}
+
+/* Attach to the snapshot, becoming its owner if nobody keeps it current */
+int popup_vconf_init(void)
+{
+	pid_t cur;
+	pid_t self = getpid();
+	uint32_t seq;
+
+	if (attached)
+		return 0;
+	attached = 1;
+
+	shm = map_shm();
+	if (shm == NULL) {
+		/* Keep a private copy current instead */
+		owner = 1;
+		atexit(popup_vconf_fini);
+		return 0;
+	}
+
+	cur = __atomic_load_n(&shm->owner, __ATOMIC_ACQUIRE);
+	if (owner_alive(cur))
+		return 0;
+
+	/* Take over a missing or dead owner */
+	if (!__atomic_compare_exchange_n(&shm->owner, &cur, self, 0,
+					 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		return 0;
+
+	owner = 1;
+	atexit(popup_vconf_fini);
+
+	/*
+	 * Values of the previous owner are no longer followed. It may have
+	 * died inside an update, so make seq odd rather than bump it.
+	 */
+	__atomic_store_n(&shm->magic, 0, __ATOMIC_RELEASE);
+	seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE) | 1;
+	__atomic_store_n(&shm->seq, seq, __ATOMIC_RELEASE);
+	shm->version = POPUP_VCONF_VERSION;
+	shm->size = sizeof(*shm);
+	__atomic_store_n(&shm->valid, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&shm->magic, POPUP_VCONF_MAGIC, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/* Drop notifications and release ownership */
+void popup_vconf_fini(void)
+{
+	pid_t self = getpid();
+	int i;
+
+	for (i = 0; i < POPUP_VCONF_MAX; i++) {
+		if (watched & (1U << i))
+			vconf_ignore_key_changed(keys[i].key, key_changed);
+	}
+	watched = 0;
+
+	if (shm) {
+		if (owner) {
+			__atomic_store_n(&shm->magic, 0, __ATOMIC_RELEASE);
+			__atomic_compare_exchange_n(&shm->owner, &self, 0, 0,
+						    __ATOMIC_ACQ_REL,
+						    __ATOMIC_ACQUIRE);
+		}
+		munmap(shm, sizeof(*shm));
+		shm = NULL;
+	}
+
+	owner = 0;
+	attached = 0;
+}
+
+/*
+ * Read a published key under the sequence lock. An owner killed inside
+ * an update leaves seq odd until the next takeover, so give up after a
+ * while and let the caller go to vconf.
+ */
+static int snapshot_get(int id, int *val)
+{
+	uint32_t seq, valid;
+	int v, spins = 0;
+
+	if (shm == NULL || !layout_ok(shm))
+		return -1;
+
+	do {
+		if (spins++ == POPUP_VCONF_SPINS)
+			return -1;
+		seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+		valid = __atomic_load_n(&shm->valid, __ATOMIC_RELAXED);
+		v = __atomic_load_n(&shm->val[id], __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((seq & 1) || seq != __atomic_load_n(&shm->seq, __ATOMIC_RELAXED));
+
+	if (!(valid & (1U << id)))
+		return -1;
+	*val = v;
+	return 0;
+}
+
+/* Read one key from the snapshot, falling back to vconf */
+int popup_vconf_get(int id, int *val)
+{
+	int v;
+
+	if (id < 0 || id >= POPUP_VCONF_MAX || val == NULL)
+		return -1;
+
+	if (keys[id].type & KEY_DIRECT)
+		return read_key(id, val);
+
+	if (snapshot_get(id, val) == 0) {
+		hits++;
+		return 0;
+	}
+
+	if (shm == NULL && (watched & (1U << id))) {
+		*val = local_val[id];
+		hits++;
+		return 0;
+	}
+
+	if (read_key(id, &v) < 0)
+		return -1;
+	if (owner && !(watched & (1U << id)))
+		watch(id, v);
+
+	*val = v;
+	return 0;
+}
+
+/* vconf round trips made and eliminated in this process */
+void popup_vconf_stats(int *nreads, int *nsaved)
+{
+	if (nreads)
+		*nreads = reads;
+	if (nsaved)
+		*nsaved = hits;
+}
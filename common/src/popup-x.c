@@ -0,0 +1,146 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * X request accounting and window setup for the show path.
+ *
+ * Xlib numbers every request, so NextRequest() before and after a step
+ * gives the requests it queued. LastKnownRequestProcessed() only moves
+ * when Xlib reads from the server, which on these paths means it waited
+ * for a reply: a step that sees it reach one of its own requests made
+ * at least one round trip. The totals since the first mark, and each
+ * step, are logged and added to the popup counters by popup_x_report().
+ *
+ * popup_x_prepare() sets the window type and the key grab while the
+ * window is still unmapped, so they travel with the map request instead
+ * of making the window manager re-evaluate a mapped window.
+ */
+
+#include <string.h>
+#include <X11/Xlib.h>
+#include <Ecore_X.h>
+#include <Elementary.h>
+#include <utilX.h>
+#include "popup-x.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+
+struct x_step {
+	const char *name;
+	unsigned int calls;
+	unsigned long requests;
+	unsigned int roundtrips;
+};
+
+static struct x_step steps[POPUP_X_MAX_STEPS];
+static int nsteps = 0;
+static unsigned long first_next = 0;
+static unsigned int total_roundtrips = 0;
+static unsigned long reported = 0;
+static unsigned int reported_roundtrips = 0;
+
+static Display *display(void)
+{
+	return (Display *)ecore_x_display_get();
+}
+
+void popup_x_mark(struct popup_x_mark *m)
+{
+	Display *dpy = display();
+
+	m->next = dpy ? NextRequest(dpy) : 0;
+	m->trace = popup_trace_begin();
+	if (first_next == 0)
+		first_next = m->next;
+}
+
+void popup_x_step(const char *name, const struct popup_x_mark *m)
+{
+	Display *dpy = display();
+	struct x_step *s = NULL;
+	int i;
+
+	popup_trace_end(name, m->trace);
+	if (dpy == NULL)
+		return;
+
+	for (i = 0; i < nsteps; i++) {
+		if (steps[i].name == name || !strcmp(steps[i].name, name)) {
+			s = &steps[i];
+			break;
+		}
+	}
+	if (s == NULL) {
+		if (nsteps == POPUP_X_MAX_STEPS)
+			return;
+		s = &steps[nsteps++];
+		s->name = name;
+	}
+
+	s->calls++;
+	s->requests += NextRequest(dpy) - m->next;
+	if ((long)(LastKnownRequestProcessed(dpy) - m->next) >= 0) {
+		s->roundtrips++;
+		total_roundtrips++;
+	}
+}
+
+/* Window type and key grab, queued before the first map */
+int popup_x_prepare(Evas_Object *win, int grab_keys)
+{
+	Ecore_X_Window xwin;
+
+	if (win == NULL)
+		return -1;
+
+	xwin = elm_win_xwindow_get(win);
+	if (xwin == 0)
+		return -1;
+
+	POPUP_X("netwm_window_type_set",
+		ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION));
+	if (grab_keys)
+		POPUP_X("utilx_grab_key",
+			utilx_grab_key(display(), xwin, KEY_SELECT, SHARED_GRAB));
+
+	return 0;
+}
+
+/* Log what showing the popup cost in X traffic */
+void popup_x_report(void)
+{
+	Display *dpy = display();
+	unsigned long requests;
+	int i;
+
+	if (dpy == NULL || first_next == 0)
+		return;
+
+	requests = NextRequest(dpy) - first_next;
+	system_print("\n popup-x : %lu requests, %u round trips \n",
+		     requests, total_roundtrips);
+	for (i = 0; i < nsteps; i++)
+		system_print("\n popup-x : %s x%u: %lu requests, %u round trips \n",
+			     steps[i].name, steps[i].calls, steps[i].requests,
+			     steps[i].roundtrips);
+
+	popup_stats_add(POPUP_STAT_X_REQUEST, requests - reported);
+	reported = requests;
+	popup_stats_add(POPUP_STAT_X_ROUNDTRIP,
+			total_roundtrips - reported_roundtrips);
+	reported_roundtrips = total_roundtrips;
+}
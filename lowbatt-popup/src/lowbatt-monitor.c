@@ -0,0 +1,383 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Battery monitor for lowbatt-popup.
+ *
+ * Normally an outside component launches the popup for every threshold
+ * crossing. With db/private/system-popup/batt_monitor set, a resident
+ * lowbatt reads the power_supply class itself and decides locally.
+ * Samples are taken on power_supply uevents, a burst of them coalesced
+ * into one read, and on a poll timer that shortens as the projected time
+ * to the next threshold does. Capacity and its rate of change are
+ * smoothed, a warning is rearmed only LOWBATT_HYST percent above its
+ * level, and power-off needs consecutive raw samples at the bottom.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <Ecore.h>
+#include "lowbatt-monitor.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-timer.h"
+
+#define UEVENT_BUF	2048
+
+struct monitor {
+	int running;
+	lowbatt_monitor_cb cb;
+	void *data;
+	const char *root;
+	char dir[PATH_MAX];		/* battery found under root */
+	struct lowbatt_state st;
+	struct popup_timer poll;
+	struct popup_timer coalesce;
+	int fd;
+	Ecore_Fd_Handler *handler;
+};
+
+static const int warn_levels[LOWBATT_NWARN] = LOWBATT_WARN_LEVELS;
+
+static struct monitor mon = { .fd = -1 };
+
+/* Feed one sample, returns the decision it triggers if any */
+int lowbatt_monitor_update(struct lowbatt_state *st,
+			   const struct lowbatt_sample *s)
+{
+	int cap = s->capacity * 16;
+	int prev, inst, ev = LOWBATT_EV_NONE;
+	int64_t dt;
+
+	if (!st->valid) {
+		st->valid = 1;
+		st->smooth = cap;
+		st->rate = 0;
+	} else {
+		prev = st->smooth;
+		st->smooth += (cap - st->smooth) / 4;
+		dt = (int64_t)(s->ms - st->last_ms);
+		if (dt > 0) {
+			inst = (int)((int64_t)(st->smooth - prev) * 60000 / dt);
+			st->rate += (inst - st->rate) / 4;
+		}
+	}
+	st->last_ms = s->ms;
+
+	/* Rearm the warnings the level has climbed clear of */
+	while (st->warned > 0 &&
+	       st->smooth >= (warn_levels[st->warned - 1] + LOWBATT_HYST) * 16)
+		st->warned--;
+
+	if (s->charging) {
+		st->low_count = 0;
+		st->poweroff = 0;
+		if (!s->health_ok && !st->charge_error) {
+			st->charge_error = 1;
+			return LOWBATT_EV_CHARGE_ERROR;
+		}
+		if (s->health_ok)
+			st->charge_error = 0;
+		return LOWBATT_EV_NONE;
+	}
+	st->charge_error = 0;
+
+	/* Raw value, smoothing must not delay the shutdown */
+	if (s->capacity <= LOWBATT_POWEROFF_LEVEL) {
+		if (++st->low_count >= LOWBATT_POWEROFF_CONFIRM && !st->poweroff) {
+			st->poweroff = 1;
+			return LOWBATT_EV_POWEROFF;
+		}
+	} else {
+		st->low_count = 0;
+	}
+
+	/* One warning however many levels a sample skips */
+	while (st->warned < LOWBATT_NWARN &&
+	       st->smooth <= warn_levels[st->warned] * 16) {
+		st->warned++;
+		ev = LOWBATT_EV_WARNING;
+	}
+
+	return ev;
+}
+
+/* Poll at a quarter of the projected time to the next threshold */
+unsigned int lowbatt_monitor_next_ms(const struct lowbatt_state *st)
+{
+	int64_t ms;
+	int target;
+
+	/* Smoothing never delays a shutdown, nor does the poll interval */
+	if (st->low_count > 0 && !st->poweroff)
+		return LOWBATT_POLL_MIN_MS;
+
+	if (!st->valid || st->rate >= 0)
+		return LOWBATT_POLL_MAX_MS;
+
+	target = st->warned < LOWBATT_NWARN ?
+		warn_levels[st->warned] : LOWBATT_POWEROFF_LEVEL;
+	ms = (int64_t)(st->smooth - target * 16) * 60000 / -st->rate / 4;
+
+	if (ms < LOWBATT_POLL_MIN_MS)
+		return LOWBATT_POLL_MIN_MS;
+	if (ms > LOWBATT_POLL_MAX_MS)
+		return LOWBATT_POLL_MAX_MS;
+	return (unsigned int)ms;
+}
+
+static int read_attr(const char *dir, const char *attr, char *buf, size_t len)
+{
+	char path[PATH_MAX];
+	ssize_t n;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, attr);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	n = read(fd, buf, len - 1);
+	close(fd);
+	if (n < 0)
+		return -1;
+
+	while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' '))
+		n--;
+	buf[n] = '\0';
+	return 0;
+}
+
+/* First supply of type Battery under root */
+int lowbatt_battery_dir(const char *root, char *dir, size_t len)
+{
+	struct dirent *e;
+	char path[PATH_MAX], type[32];
+	DIR *d;
+
+	d = opendir(root);
+	if (d == NULL)
+		return -1;
+
+	while ((e = readdir(d)) != NULL) {
+		if (e->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", root, e->d_name);
+		if (read_attr(path, "type", type, sizeof(type)) == 0 &&
+		    strcmp(type, "Battery") == 0) {
+			snprintf(dir, len, "%s", path);
+			closedir(d);
+			return 0;
+		}
+	}
+
+	closedir(d);
+	return -1;
+}
+
+/* Read the battery under root, looked up again when it disappears */
+int lowbatt_monitor_read(const char *root, struct lowbatt_sample *s)
+{
+	struct timespec ts;
+	char buf[32];
+
+	if (mon.dir[0] == '\0' &&
+	    lowbatt_battery_dir(root, mon.dir, sizeof(mon.dir)) < 0)
+		return -1;
+
+	if (read_attr(mon.dir, "capacity", buf, sizeof(buf)) < 0) {
+		mon.dir[0] = '\0';
+		return -1;
+	}
+	s->capacity = atoi(buf);
+	if (s->capacity < 0)
+		s->capacity = 0;
+	if (s->capacity > 100)
+		s->capacity = 100;
+
+	/* Anything but Discharging means a charger is attached */
+	s->charging = read_attr(mon.dir, "status", buf, sizeof(buf)) == 0 &&
+		strcmp(buf, "Discharging") != 0 && strcmp(buf, "Unknown") != 0;
+
+	/* Charging pauses on temperature, the only error with a message */
+	s->health_ok = read_attr(mon.dir, "health", buf, sizeof(buf)) < 0 ||
+		(strcmp(buf, "Overheat") != 0 && strcmp(buf, "Cold") != 0);
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	s->ms = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+	return 0;
+}
+
+static void poll_cb(void *data);
+
+static void sample(void)
+{
+	struct lowbatt_sample s;
+	int ev = LOWBATT_EV_NONE;
+
+	popup_timer_cancel(&mon.poll);
+	popup_timer_cancel(&mon.coalesce);
+
+	if (lowbatt_monitor_read(mon.root, &s) == 0) {
+		popup_stats_inc(POPUP_STAT_BATT_SAMPLE);
+		ev = lowbatt_monitor_update(&mon.st, &s);
+		popup_log(POPUP_LOG_DEBUG, "batt: %d%% smooth %d rate %d per min (1/16 %%)",
+			  s.capacity, mon.st.smooth, mon.st.rate);
+	}
+
+	if (ev != LOWBATT_EV_NONE && mon.cb)
+		mon.cb(ev, mon.data);
+
+	/* The callback may have stopped us */
+	if (mon.running)
+		popup_timer_arm(&mon.poll, lowbatt_monitor_next_ms(&mon.st),
+				poll_cb, NULL);
+}
+
+static void poll_cb(void *data)
+{
+	sample();
+}
+
+static void coalesce_cb(void *data)
+{
+	sample();
+}
+
+/* Payload is "action@devpath" then KEY=value strings, NUL separated */
+static int is_power_supply(const char *buf, ssize_t len)
+{
+	const char *p = buf, *end = buf + len;
+
+	while (p < end) {
+		if (strcmp(p, "SUBSYSTEM=power_supply") == 0)
+			return 1;
+		p += strlen(p) + 1;
+	}
+	return 0;
+}
+
+static Eina_Bool uevent_cb(void *data, Ecore_Fd_Handler *h)
+{
+	char buf[UEVENT_BUF];
+	ssize_t n;
+	int hits = 0;
+
+	while ((n = recv(mon.fd, buf, sizeof(buf) - 1, MSG_DONTWAIT)) > 0) {
+		buf[n] = '\0';
+		if (is_power_supply(buf, n))
+			hits++;
+	}
+
+	if (hits) {
+		popup_stats_add(POPUP_STAT_BATT_UEVENT, hits);
+		if (!popup_timer_armed(&mon.coalesce))
+			popup_timer_arm(&mon.coalesce, LOWBATT_COALESCE_MS,
+					coalesce_cb, NULL);
+	}
+	return ECORE_CALLBACK_RENEW;
+}
+
+static int uevent_open(void)
+{
+	struct sockaddr_nl sa;
+	int fd;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+		    NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+		return -1;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.nl_family = AF_NETLINK;
+	sa.nl_groups = 1;		/* kernel events */
+	if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int lowbatt_monitor_start(lowbatt_monitor_cb cb, void *data)
+{
+	const char *root;
+
+	if (mon.running)
+		return 0;
+
+	root = getenv(LOWBATT_SYSFS_ENV);
+	if (root == NULL || root[0] == '\0')
+		root = LOWBATT_SYSFS_ROOT;
+
+	mon.root = root;
+	mon.dir[0] = '\0';
+	mon.cb = cb;
+	mon.data = data;
+	memset(&mon.st, 0, sizeof(mon.st));
+
+	if (lowbatt_battery_dir(root, mon.dir, sizeof(mon.dir)) < 0) {
+		system_print("\n System-popup : no battery under %s \n", root);
+		return -1;
+	}
+
+	/* A fake tree gets no uevents, the poll timer drives it */
+	if (strcmp(root, LOWBATT_SYSFS_ROOT) == 0) {
+		mon.fd = uevent_open();
+		if (mon.fd >= 0)
+			mon.handler = ecore_main_fd_handler_add(mon.fd, ECORE_FD_READ,
+								uevent_cb, NULL,
+								NULL, NULL);
+	}
+
+	system_print("\n System-popup : monitoring %s%s \n", mon.dir,
+		     mon.handler ? "" : ", polling only");
+	mon.running = 1;
+	sample();
+	return 0;
+}
+
+int lowbatt_monitor_running(void)
+{
+	return mon.running;
+}
+
+void lowbatt_monitor_stop(void)
+{
+	if (!mon.running)
+		return;
+
+	popup_timer_cancel(&mon.poll);
+	popup_timer_cancel(&mon.coalesce);
+	if (mon.handler) {
+		ecore_main_fd_handler_del(mon.handler);
+		mon.handler = NULL;
+	}
+	if (mon.fd >= 0) {
+		close(mon.fd);
+		mon.fd = -1;
+	}
+	mon.running = 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_lowbatt_monitor_H_
+#define __DEF_lowbatt_monitor_H_
+
+#include <stdint.h>
+
+#define LOWBATT_SYSFS_ROOT		"/sys/class/power_supply"
+#define LOWBATT_SYSFS_ENV		"LOWBATT_SYSFS_ROOT"	/* fake tree */
+
+/* Warning thresholds in percent, highest first */
+#define LOWBATT_WARN_LEVELS		{ 15, 5 }
+#define LOWBATT_NWARN			2
+#define LOWBATT_POWEROFF_LEVEL		1
+#define LOWBATT_HYST			3	/* percent above a level to rearm */
+#define LOWBATT_POWEROFF_CONFIRM	2	/* samples at the poweroff level */
+
+#define LOWBATT_COALESCE_MS		500	/* uevent burst to one sample */
+#define LOWBATT_POLL_MIN_MS		5000
+#define LOWBATT_POLL_MAX_MS		60000
+
+/* Decisions, handed to the callback */
+enum {
+	LOWBATT_EV_NONE = 0,
+	LOWBATT_EV_WARNING,
+	LOWBATT_EV_POWEROFF,
+	LOWBATT_EV_CHARGE_ERROR,
+};
+
+struct lowbatt_sample {
+	int capacity;			/* percent */
+	int charging;			/* charger attached */
+	int health_ok;
+	uint64_t ms;			/* monotonic */
+};
+
+/* Smoothed battery state, capacity and rate in 1/16 percent */
+struct lowbatt_state {
+	int valid;
+	int smooth;
+	int rate;			/* per minute, negative discharging */
+	uint64_t last_ms;
+	int warned;			/* thresholds crossed, 0..LOWBATT_NWARN */
+	int low_count;
+	int poweroff;
+	int charge_error;
+};
+
+typedef void (*lowbatt_monitor_cb)(int ev, void *data);
+
+int lowbatt_monitor_update(struct lowbatt_state *st,
+			   const struct lowbatt_sample *s);
+unsigned int lowbatt_monitor_next_ms(const struct lowbatt_state *st);
+int lowbatt_battery_dir(const char *root, char *dir, size_t len);
+int lowbatt_monitor_read(const char *root, struct lowbatt_sample *s);
+
+int lowbatt_monitor_start(lowbatt_monitor_cb cb, void *data);
+int lowbatt_monitor_running(void);
+void lowbatt_monitor_stop(void);
+
+#endif				/* __DEF_lowbatt_monitor_H__ */
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Thermal watch for the charge-error popup.
+ *
+ * The charger pauses on extreme temperature and used to get a popup
+ * that dismissed itself after a few seconds. While the popup is up this
+ * samples the battery thermal zones and the battery's own sensor. The
+ * files are opened once and re-read with pread() in one pass per sample
+ * into a fixed ring. The callback gets the average of the last few
+ * samples whenever the displayed degree changes, and once more when the
+ * average has stayed in range long enough for charging to resume. The
+ * poll interval doubles while the average stays put, so a long pause
+ * costs a read every LOWBATT_THERMAL_MAX_MS.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "lowbatt-thermal.h"
+#include "lowbatt-monitor.h"
+#include "popup-log.h"
+#include "popup-timer.h"
+
+struct source {
+	int fd;
+	int scale;			/* to milli-degrees */
+};
+
+struct thermal {
+	int running;
+	lowbatt_thermal_cb cb;
+	void *data;
+
+	struct source src[LOWBATT_THERMAL_SOURCES];
+	int nsrc;
+
+	struct lowbatt_thermal_sample ring[LOWBATT_THERMAL_RING];
+	uint64_t head;			/* samples ever taken */
+	int avg_hot;
+	int avg_cold;
+	int shown;			/* last degree reported */
+	int in_range;
+	unsigned int interval;
+	struct popup_timer poll;
+
+	uint64_t start_ms;
+	int peak;
+};
+
+static struct thermal th;
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int read_line(const char *path, char *buf, size_t len)
+{
+	ssize_t n;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	n = read(fd, buf, len - 1);
+	close(fd);
+	if (n < 0)
+		return -1;
+	while (n > 0 && buf[n - 1] == '\n')
+		n--;
+	buf[n] = '\0';
+	return 0;
+}
+
+static void add_source(const char *path, int scale)
+{
+	int fd;
+
+	if (th.nsrc >= LOWBATT_THERMAL_SOURCES)
+		return;
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return;
+	th.src[th.nsrc].fd = fd;
+	th.src[th.nsrc].scale = scale;
+	th.nsrc++;
+}
+
+/* Zones whose type names the battery, then the battery's own sensor */
+static void find_sources(void)
+{
+	char path[PATH_MAX], type[64], dir[PATH_MAX];
+	const char *root;
+	struct dirent *e;
+	DIR *d;
+
+	root = getenv(LOWBATT_THERMAL_ENV);
+	if (root == NULL || root[0] == '\0')
+		root = LOWBATT_THERMAL_ROOT;
+
+	d = opendir(root);
+	if (d) {
+		while ((e = readdir(d)) != NULL) {
+			if (strncmp(e->d_name, "thermal_zone", 12) != 0)
+				continue;
+			if (snprintf(path, sizeof(path), "%s/%s/type", root,
+				     e->d_name) >= (int)sizeof(path) ||
+			    read_line(path, type, sizeof(type)) < 0 ||
+			    strcasestr(type, "batt") == NULL)
+				continue;
+			if (snprintf(path, sizeof(path), "%s/%s/temp", root,
+				     e->d_name) < (int)sizeof(path))
+				add_source(path, 1);
+		}
+		closedir(d);
+	}
+
+	/* power_supply reports tenths of a degree */
+	root = getenv(LOWBATT_SYSFS_ENV);
+	if (root == NULL || root[0] == '\0')
+		root = LOWBATT_SYSFS_ROOT;
+	/* A truncated path could name some other attribute */
+	if (lowbatt_battery_dir(root, dir, sizeof(dir)) == 0 &&
+	    snprintf(path, sizeof(path), "%s/temp", dir) < (int)sizeof(path))
+		add_source(path, 100);
+}
+
+static int read_source(const struct source *s, int *val)
+{
+	char buf[24];
+	ssize_t n;
+
+	n = pread(s->fd, buf, sizeof(buf) - 1, 0);
+	if (n <= 0)
+		return -1;
+	buf[n] = '\0';
+	*val = atoi(buf) * s->scale;
+	return 0;
+}
+
+/* Mean of the newest LOWBATT_THERMAL_AVG ring entries */
+static void average(void)
+{
+	const struct lowbatt_thermal_sample *s;
+	int64_t hot = 0, cold = 0;
+	int i, n;
+
+	n = th.head < LOWBATT_THERMAL_AVG ? (int)th.head : LOWBATT_THERMAL_AVG;
+	for (i = 1; i <= n; i++) {
+		s = &th.ring[(th.head - i) & (LOWBATT_THERMAL_RING - 1)];
+		hot += s->hot;
+		cold += s->cold;
+	}
+	th.avg_hot = hot / n;
+	th.avg_cold = cold / n;
+}
+
+static void sample_cb(void *data)
+{
+	struct lowbatt_thermal_sample *s;
+	int i, val, n = 0, prev, temp, cleared;
+	int hot = INT_MIN, cold = INT_MAX;
+
+	/* One pass over the descriptors kept open since start */
+	for (i = 0; i < th.nsrc; i++) {
+		if (read_source(&th.src[i], &val) < 0)
+			continue;
+		if (val > hot)
+			hot = val;
+		if (val < cold)
+			cold = val;
+		n++;
+	}
+	if (n == 0) {
+		popup_timer_arm(&th.poll, LOWBATT_THERMAL_MAX_MS, sample_cb, NULL);
+		return;
+	}
+
+	s = &th.ring[th.head & (LOWBATT_THERMAL_RING - 1)];
+	s->ms = now_ms();
+	s->hot = hot;
+	s->cold = cold;
+	th.head++;
+	if (hot > th.peak)
+		th.peak = hot;
+
+	prev = th.avg_hot;
+	average();
+
+	if (th.avg_hot <= LOWBATT_TEMP_HOT_CLEAR &&
+	    th.avg_cold >= LOWBATT_TEMP_COLD_CLEAR)
+		th.in_range++;
+	else
+		th.in_range = 0;
+	cleared = th.in_range >= LOWBATT_THERMAL_CLEAR_N;
+
+	/* Back off while nothing moves, confirm a clear at full rate */
+	if (th.in_range || abs(th.avg_hot - prev) >= LOWBATT_THERMAL_STEADY)
+		th.interval = LOWBATT_THERMAL_MIN_MS;
+	else if (th.interval < LOWBATT_THERMAL_MAX_MS / 2)
+		th.interval *= 2;
+	else
+		th.interval = LOWBATT_THERMAL_MAX_MS;
+
+	temp = th.avg_cold < LOWBATT_TEMP_COLD_CLEAR ? th.avg_cold : th.avg_hot;
+	popup_log(POPUP_LOG_DEBUG, "thermal: %d/%d avg %d/%d next %ums",
+		  hot, cold, th.avg_hot, th.avg_cold, th.interval);
+
+	if (cleared) {
+		lowbatt_thermal_cb cb = th.cb;
+		void *cb_data = th.data;
+
+		lowbatt_thermal_stop();
+		if (cb)
+			cb(temp, 1, cb_data);
+		return;
+	}
+
+	if (temp / 1000 != th.shown) {
+		th.shown = temp / 1000;
+		if (th.cb)
+			th.cb(temp, 0, th.data);
+	}
+
+	if (th.running)
+		popup_timer_arm(&th.poll, th.interval, sample_cb, NULL);
+}
+
+/* Watch until the temperature is back in range, first sample now */
+int lowbatt_thermal_start(lowbatt_thermal_cb cb, void *data)
+{
+	if (th.running)
+		return 0;
+
+	memset(&th, 0, sizeof(th));
+	find_sources();
+	if (th.nsrc == 0) {
+		system_print("\n System-popup : no battery temperature to watch \n");
+		return -1;
+	}
+
+	th.cb = cb;
+	th.data = data;
+	th.shown = INT_MIN;
+	th.peak = INT_MIN;
+	th.interval = LOWBATT_THERMAL_MIN_MS;
+	th.start_ms = now_ms();
+	th.running = 1;
+
+	sample_cb(NULL);
+	return 0;
+}
+
+int lowbatt_thermal_running(void)
+{
+	return th.running;
+}
+
+void lowbatt_thermal_stop(void)
+{
+	int i;
+
+	if (!th.running)
+		return;
+
+	popup_timer_cancel(&th.poll);
+	for (i = 0; i < th.nsrc; i++)
+		close(th.src[i].fd);
+	th.nsrc = 0;
+	th.running = 0;
+
+	system_print("\n System-popup : thermal watch %llus, %llu samples, peak %d \n",
+		     (unsigned long long)(now_ms() - th.start_ms) / 1000,
+		     (unsigned long long)th.head, th.peak);
+}
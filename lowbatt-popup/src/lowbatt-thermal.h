@@ -0,0 +1,55 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_lowbatt_thermal_H_
+#define __DEF_lowbatt_thermal_H_
+
+#include <stdint.h>
+
+#define LOWBATT_THERMAL_ROOT		"/sys/class/thermal"
+#define LOWBATT_THERMAL_ENV		"LOWBATT_THERMAL_ROOT"	/* fake tree */
+
+#define LOWBATT_THERMAL_SOURCES		8
+#define LOWBATT_THERMAL_RING		64	/* samples, power of two */
+#define LOWBATT_THERMAL_AVG		4	/* samples averaged */
+
+/* Range charging resumes in, milli-degrees C */
+#define LOWBATT_TEMP_HOT_CLEAR		42000
+#define LOWBATT_TEMP_COLD_CLEAR		3000
+#define LOWBATT_THERMAL_CLEAR_N		3	/* averages in range */
+
+/* Poll interval doubles while the average moves less than STEADY */
+#define LOWBATT_THERMAL_MIN_MS		1000
+#define LOWBATT_THERMAL_MAX_MS		30000
+#define LOWBATT_THERMAL_STEADY		500
+
+struct lowbatt_thermal_sample {
+	uint64_t ms;
+	int hot;			/* hottest source, milli-degrees C */
+	int cold;			/* coldest source */
+};
+
+/* temp is the averaged reading out of range, cleared once back in it */
+typedef void (*lowbatt_thermal_cb)(int temp, int cleared, void *data);
+
+int lowbatt_thermal_start(lowbatt_thermal_cb cb, void *data);
+int lowbatt_thermal_running(void);
+void lowbatt_thermal_stop(void);
+
+#endif				/* __DEF_lowbatt_thermal_H__ */
@@ -29,14 +29,46 @@
 #include <notification.h>
 #include <syspopup.h>
 #include <svi.h>
+#include "popup-dispatch.h"
+#include "popup-vconf.h"
+#include "popup-timer.h"
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-screen.h"
+#include "popup-x.h"
+#include "popup-trace.h"
+#include "popup-emerg.h"
+#include "popup-pool.h"
+#include "popup-memprof.h"
+#include "popup-font.h"
+#include "lowbatt-monitor.h"
+#include "lowbatt-thermal.h"
 
 #define CHECK_ACT 			0
 #define WARNING_ACT 		1
 #define POWER_OFF_ACT 		2
 #define CHARGE_ERROR_ACT 	3
 
+/* Drawn straight to the framebuffer if the window never shows */
+#define EMERG_MSG_POWER_OFF	"BATTERY EMPTY\nPOWERING OFF"
+
 
 static int option = -1;
+static struct popup_timer dismiss_timer;
+static int countdown = 0;
+
+void lowbatt_timeout_func(void *data);
+int lowbatt_start(void *data);
+static void lowbatt_release(void *data);
+
+/* Launch options, placed by option hash */
+#define LOWBATT_OPTS(X)						\
+	X("warning", 'w', 'g', WARNING_ACT, NULL, 0, NULL)		\
+	X("poweroff", 'p', 'f', POWER_OFF_ACT, NULL, 0, NULL)		\
+	X("chargeerr", 'c', 'r', CHARGE_ERROR_ACT, NULL, 0, NULL)
+
+POPUP_OPT_TABLE(lowbatt_opts, LOWBATT_OPTS);
 
 int myterm(bundle *b, void *data)
 {
@@ -45,6 +77,7 @@ int myterm(bundle *b, void *data)
 
 int mytimeout(bundle *b, void *data)
 {
+	popup_stats_inc(POPUP_STAT_TIMEOUT);
 	lowbatt_timeout_func(data);
 	return 0;
 }
@@ -101,15 +134,18 @@ static Evas_Object *create_win(const char *name)
 	Evas_Object *eo;
 	int w, h;
 
-	eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC);
+	POPUP_X("elm_win_add", eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC));
 	if (eo) {
 		elm_win_title_set(eo, name);
 		elm_win_borderless_set(eo, EINA_TRUE);
 		evas_object_smart_callback_add(eo, "delete,request", win_del, NULL);
 		elm_win_alpha_set(eo, EINA_TRUE);
-		ecore_x_window_size_get(ecore_x_window_root_first_get(), &w,
-					&h);
+		/* Cached geometry, no round trip on a warm start */
+		popup_screen_get(&w, &h, NULL);
 		evas_object_resize(eo, w, h);
+
+		/* Queued ahead of the map request */
+		popup_x_prepare(eo, 0);
 	}
 
 	return eo;
@@ -142,6 +178,8 @@ static int app_terminate(void *data)
 {
 	struct appdata *ad = data;
 
+	lowbatt_monitor_stop();
+
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
 
@@ -164,55 +202,144 @@ static int app_resume(void *data)
 }
 
 
+/*
+ * The device goes down either way, make sure the user sees why. Only
+ * armed right before a new frame is due, a popup already on screen
+ * would never produce the frame that disarms it.
+ */
+static void lowbatt_emerg_arm(struct appdata *ad)
+{
+	if (option == POWER_OFF_ACT)
+		popup_emerg_arm(ad->win_main, EMERG_MSG_POWER_OFF,
+				POPUP_EMERG_BUDGET_MS);
+}
+
+/* Local decision from the battery monitor, shown like a launch */
+static void lowbatt_monitor_event(int ev, void *data)
+{
+	struct appdata *ad = data;
+	int act;
+
+	switch (ev) {
+	case LOWBATT_EV_WARNING:
+		act = WARNING_ACT;
+		break;
+	case LOWBATT_EV_POWEROFF:
+		act = POWER_OFF_ACT;
+		break;
+	case LOWBATT_EV_CHARGE_ERROR:
+		act = CHARGE_ERROR_ACT;
+		break;
+	default:
+		return;
+	}
+
+	/* Already on screen, or a shutdown is counting down */
+	if (ad->popup && (act == option || option == POWER_OFF_ACT))
+		return;
+
+	if (ad->popup)
+		lowbatt_release(ad);
+	else
+		popup_linger_reuse();
+
+	option = act;
+	lowbatt_emerg_arm(ad);
+	evas_object_show(ad->win_main);
+	lowbatt_start(ad);
+}
+
+/* The batt_monitor key asks for a resident monitor */
+static int lowbatt_monitor_wanted(void)
+{
+	int val = 0;
+
+	return popup_vconf_get(POPUP_VCONF_BATT_MONITOR, &val) == 0 && val;
+}
+
+/* Stay resident and watch the battery if the key asks for it */
+static int lowbatt_monitor_begin(struct appdata *ad)
+{
+	if (lowbatt_monitor_running())
+		return 0;
+	if (!lowbatt_monitor_wanted())
+		return -1;
+
+	popup_linger_resident(1);
+	if (lowbatt_monitor_start(lowbatt_monitor_event, ad) < 0) {
+		popup_linger_resident(0);
+		return -1;
+	}
+	return 0;
+}
+
 /* Reset */
 static int app_reset(bundle *b, void *data)
 {
 	struct appdata *ad = data;
-	char *opt = NULL;
+	const struct popup_opt *entry = NULL;
+	uint64_t start;
+	int ret;
+
+	popup_stats_inc(POPUP_STAT_LAUNCH);
+	popup_trace_request(b, ad->win_main);
+	start = popup_trace_begin();
+
+	/* Missing or unknown option only checks for a running popup */
+	POPUP_TRACE("option_parse",
+		    ret = popup_dispatch(lowbatt_opts, b, ad, &entry, NULL));
+
+	/* The resident monitor makes the warning decisions itself */
+	if (ret == POPUP_DISPATCH_OK && entry->id == WARNING_ACT &&
+	    lowbatt_monitor_running()) {
+		system_print("\n System-popup : warning left to the monitor \n");
+		popup_trace_end("app_reset", start);
+		return 0;
+	}
 
-	opt = bundle_get_val(b, "_SYSPOPUP_CONTENT_");
-	if (opt == NULL)
-		option = CHECK_ACT;
-	else if (!strcmp(opt,"warning"))
-		option = WARNING_ACT;
-	else if (!strcmp(opt,"poweroff"))
-		option = POWER_OFF_ACT;
-	else if (!strcmp(opt,"chargeerr"))
-		option = CHARGE_ERROR_ACT;
+	if (ret == POPUP_DISPATCH_OK)
+		option = entry->id;
 	else
 		option = CHECK_ACT;
 
 	if (syspopup_has_popup(b)) {
 		if (option == CHECK_ACT) {
+			popup_trace_end("app_reset", start);
 			return 0;
 		}
 		syspopup_reset(b);
+
+		/* Show the lingering window again */
+		if (popup_linger_reuse()) {
+			lowbatt_emerg_arm(ad);
+			evas_object_show(ad->win_main);
+			lowbatt_start((void *)ad);
+		}
 	} else {
 		if(option == CHECK_ACT) {
-			exit(0);
+			/* Nothing to show, stay only to watch the battery */
+			if (!lowbatt_monitor_wanted())
+				exit(0);
+			syspopup_create(b, &handler, ad->win_main, ad);
+			if (lowbatt_monitor_begin(ad) < 0)
+				exit(0);
+			popup_trace_end("app_reset", start);
+			return 0;
 		}
-		syspopup_create(b, &handler, ad->win_main, ad);
-		evas_object_show(ad->win_main);
+		POPUP_X("syspopup_create",
+			syspopup_create(b, &handler, ad->win_main, ad));
+		lowbatt_emerg_arm(ad);
+		POPUP_X("win_show", evas_object_show(ad->win_main));
 
 		/* Start Main UI */
 		lowbatt_start((void *)ad);
+		lowbatt_monitor_begin(ad);
 	}
 
+	popup_trace_end("app_reset", start);
 	return 0;
 }
 
-/* Customized print */
-void system_print(const char *format, ...)
-{
-	/* Un-comment return to disable logs */
-	return;
-
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-}
-
 /* Cleanup objects to avoid mem-leak */
 void lowbatt_cleanup(struct appdata *ad)
 {
@@ -220,21 +347,29 @@ void lowbatt_cleanup(struct appdata *ad)
 		return;
 
 	if (ad->popup)
-		evas_object_del(ad->popup);
+		popup_pool_put(ad->popup);
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
+	ad->popup = NULL;
+	ad->layout_main = NULL;
 }
 
-/* Background clicked noti */
-static void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
+static void lowbatt_release(void *data)
 {
-	system_print("\n system-popup : Inside bg clicked \n");
-	exit(0);
+	popup_emerg_disarm();
+	lowbatt_thermal_stop();
+	popup_timer_cancel(&dismiss_timer);
+	lowbatt_cleanup(data);
 }
 
-static void bg_noti_cb(void *data)
+/* Background clicked noti */
+static void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
-	ui_bgimg_reload((Evas_Object *) data);
+	struct appdata *ad = data;
+
+	system_print("\n system-popup : Inside bg clicked \n");
+	popup_stats_inc(POPUP_STAT_DISMISS);
+	popup_linger_dismiss(ad->win_main, lowbatt_release, ad);
 }
 
 /* Create indicator bar */
@@ -247,58 +382,127 @@ static int lowbatt_create_indicator(struct appdata *ad)
 
 void lowbatt_timeout_func(void *data)
 {
+	struct popup_timer_stats st;
+
 	system_print("\n System-popup : In Lowbatt timeout\n");
-	lowbatt_cleanup(data);
+	popup_timer_cancel(&dismiss_timer);
+	popup_timer_stats_get(&st);
+	system_print("\n System-popup : timers fired %u, late max %ums avg %ums \n",
+		     st.fired, st.late_max_ms, st.late_avg_ms);
 
 	/* If poweroff requested */
 	if (option == POWER_OFF_ACT) {
+		lowbatt_cleanup(data);
 		if (sysman_call_predef_action(PREDEF_POWEROFF, 0) == -1) {
 			system_print
 				("System-popup : failed to request poweroff to system_server \n");
 			fflush(stdout);
+			popup_stats_inc(POPUP_STAT_POWEROFF_FALLBACK);
 			system("poweroff");
 		}
+		/* Now get lost */
+		exit(0);
 	}
-	/* Now get lost */
-	exit(0);
+
+	/* Warnings are frequent, keep the process around for the next one */
+	popup_linger_dismiss(((struct appdata *)data)->win_main,
+			     lowbatt_release, data);
+}
+
+static void lowbatt_dismiss_cb(void *data)
+{
+	popup_stats_inc(POPUP_STAT_TIMEOUT);
+	lowbatt_timeout_func(data);
+}
+
+static void lowbatt_ok_clicked_cb(void *data, Evas_Object *obj, void *event_info)
+{
+	popup_stats_inc(POPUP_STAT_CHOICE_OK);
+	lowbatt_timeout_func(data);
+}
+
+/* Update the shutdown message once a second until it reaches zero */
+static void lowbatt_countdown_cb(void *data)
+{
+	struct appdata *ad = data;
+	char buf[256];
+
+	if (countdown <= 0) {
+		popup_stats_inc(POPUP_STAT_TIMEOUT);
+		lowbatt_timeout_func(ad);
+		return;
+	}
+
+	snprintf(buf, sizeof(buf), "%s (%d)",
+		 _("IDS_COM_POP_LOW_BATTERY_PHONE_WILL_SHUT_DOWN"), countdown);
+	elm_object_text_set(ad->popup, buf);
+	countdown--;
+	popup_timer_arm(&dismiss_timer, 1000, lowbatt_countdown_cb, ad);
+}
+
+/* Show the temperature while charging is paused, close once it resumes */
+static void lowbatt_thermal_update(int temp, int cleared, void *data)
+{
+	struct appdata *ad = data;
+	char buf[256];
+
+	if (ad->popup == NULL || option != CHARGE_ERROR_ACT)
+		return;
+
+	if (cleared) {
+		popup_stats_inc(POPUP_STAT_THERMAL_CLEAR);
+		lowbatt_timeout_func(ad);
+		return;
+	}
+
+	snprintf(buf, sizeof(buf), "%s (%d°C)",
+		 _("IDS_COM_BODY_CHARGING_PAUSED_DUE_TO_EXTREME_TEMPERATURE"),
+		 temp / 1000);
+	elm_object_text_set(ad->popup, buf);
 }
 
 /* Basic popup widget */
 static int lowbatt_create_and_show_basic_popup(struct appdata *ad)
 {
-	Evas_Object *btn1;
+	uint64_t t;
 
 	/* Add beat ui popup */
 	/* No need to pass main window ptr */
-	ad->popup = elm_popup_add(ad->win_main);
+	POPUP_TRACE("popup_pool_get", ad->popup = popup_pool_get(ad->win_main, 1));
 	if (ad->popup == NULL) {
 		system_print("\n System-popup : Add popup failed \n");
 		return -1;
 	}
-	evas_object_size_hint_weight_set(ad->popup, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
-	
-	elm_popup_timeout_set(ad->layout_main, 3);
 
 	/* Check launch option */
+	t = popup_trace_begin();
 	if (option == CHARGE_ERROR_ACT)
 		elm_object_text_set(ad->popup, _("IDS_COM_BODY_CHARGING_PAUSED_DUE_TO_EXTREME_TEMPERATURE"));
 	else if (option == WARNING_ACT)
 		elm_object_text_set(ad->popup, _("IDS_COM_POP_BATTERYLOW"));
-	else
-		elm_object_text_set(ad->popup, _("IDS_COM_POP_LOW_BATTERY_PHONE_WILL_SHUT_DOWN"));
-	elm_object_part_text_set(ad->popup, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
 
-	btn1 = elm_button_add(ad->popup);
-	elm_object_text_set(btn1, _("IDS_COM_SK_OK"));
-	elm_object_part_content_set(ad->popup, "button1", btn1);
-	elm_object_style_set(btn1, "popup_button/default");
-	evas_object_smart_callback_add(btn1, "clicked", lowbatt_timeout_func, ad);
+	/* Shutdown counts down visibly, other messages dismiss themselves */
+	if (option == POWER_OFF_ACT) {
+		countdown = POWEROFF_COUNTDOWN_SEC;
+		lowbatt_countdown_cb(ad);
+	} else if (option == CHARGE_ERROR_ACT &&
+		   lowbatt_thermal_start(lowbatt_thermal_update, ad) == 0) {
+		/* Stays up until the temperature is back in range */
+	} else {
+		popup_timer_arm(&dismiss_timer, DISMISS_SEC * 1000,
+				lowbatt_dismiss_cb, ad);
+	}
+	elm_object_part_text_set(ad->popup, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
+	popup_trace_end("text_set", t);
 
+	POPUP_TRACE("button_set",
+		    popup_pool_button_set(ad->popup, 0, _("IDS_COM_SK_OK"),
+					  lowbatt_ok_clicked_cb, ad));
 
-	Ecore_X_Window xwin;
-	xwin = elm_win_xwindow_get(ad->popup);
-	ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION);
-	evas_object_show(ad->popup);
+	POPUP_TRACE("popup_show", evas_object_show(ad->popup));
+	popup_linger_shown();
+	popup_stats_inc(POPUP_STAT_SHOW);
+	popup_x_report();
 
 	return 0;
 }
@@ -310,15 +514,18 @@ static int lowbatt_svi_play(void)
 
 	if ( r != SVI_SUCCESS ) {
 		system_print("Cannot initialize SVI.\n");
+		popup_stats_inc(POPUP_STAT_SVI_FAIL);
 		return 0;
 	} else {
 		r = svi_play(handle, SVI_VIB_OPERATION_LOWBATT, SVI_SND_OPERATION_LOWBATT);
 		if (r != SVI_SUCCESS) {
 			system_print("Cannot play sound or vibration.\n");
+			popup_stats_inc(POPUP_STAT_SVI_FAIL);
 		}
 		r = svi_fini(handle); //Finalize SVI
 		if (r != SVI_SUCCESS) {
 			system_print("Cannot close SVI.\n");
+			popup_stats_inc(POPUP_STAT_SVI_FAIL);
 			return 0;
 		}
 	}
@@ -333,11 +540,14 @@ int lowbatt_start(void *data)
 	ret_val = lowbatt_create_and_show_basic_popup(ad);
 	if (ret_val != 0)
 		return -1;
-	lowbatt_svi_play();
+	popup_memprof_phase("popup_build");
+	POPUP_TRACE("svi_play", lowbatt_svi_play());
 	/* Change LCD brightness */
-	ret_val = pm_change_state(LCD_NORMAL);
-	if (ret_val != 0)
+	POPUP_TRACE("pm_change_state", ret_val = pm_change_state(LCD_NORMAL));
+	if (ret_val != 0) {
+		popup_stats_inc(POPUP_STAT_PM_FAIL);
 		return -1;
+	}
 
 	return 0;
 }
@@ -348,14 +558,22 @@ int app_create(void *data)
 	Evas_Object *win;
 	struct appdata *ad = data;
 
+	popup_memprof_phase("efl_init");
+
 	/* create window */
 	win = create_win(PACKAGE);
 	if (win == NULL)
 		return -1;
 
 	ad->win_main = win;
+	popup_memprof_phase("create_win");
+	popup_memprof_watch(win);
 
 	elm_theme_overlay_add(NULL,EDJ_NAME);
+	popup_memprof_phase("theme");
+	POPUP_TRACE("font_apply", popup_font_apply());
+
+	POPUP_OPT_TABLE_ASSERT(lowbatt_opts);
 
 	return 0;
 }
@@ -373,12 +591,19 @@ int main(int argc, char *argv[])
 		.reset = app_reset,
 	};
 
+	popup_log_init(PACKAGE);
+	popup_trace_init(PACKAGE);
+	popup_memprof_init(PACKAGE);
+	popup_linger_init(PACKAGE);
+	popup_stats_init(POPUP_TYPE_LOWBATT);
+
 	memset(&ad, 0x0, sizeof(struct appdata));
 	ops.data = &ad;
 
 	int val = -1, ret = -1;
 
-	ret = vconf_get_int(VCONFKEY_TESTMODE_LOW_BATT_POPUP, &val);
+	popup_vconf_init();
+	ret = popup_vconf_get(POPUP_VCONF_TESTMODE_LOWBATT, &val);
 	if(ret == 0 && val == 1) {
 		system_print("Testmode without launching popup");
 		return 0;
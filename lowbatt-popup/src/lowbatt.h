@@ -38,6 +38,8 @@
 #define NEW_INDI
 #define APPLICATION_BG			1
 #define INDICATOR_HEIGHT		(38)
+#define DISMISS_SEC			3	/* warning auto-dismiss */
+#define POWEROFF_COUNTDOWN_SEC		5	/* shutdown countdown */
 
 #ifndef PREDEF_POWEROFF
 #define PREDEF_POWEROFF			"poweroff"
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Emergency framebuffer drawing against in-memory surfaces.
+ *
+ * popup_emerg_draw() only writes to the popup_fb it is given, so a
+ * malloc'd buffer stands in for /dev/fb0 and no display is needed.
+ * Buffers start filled with FILL so stray writes show up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "popup-emerg.h"
+
+#define FILL		0xa5
+
+static int failures = 0;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);	\
+			fprintf(stderr, __VA_ARGS__);			\
+			fprintf(stderr, "\n");				\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Foreground pixels and their bounding box */
+struct ink {
+	int count;
+	int others;			/* neither background nor foreground */
+	int x0, y0, x1, y1;
+};
+
+static void fb_new(struct popup_fb *fb, int w, int h, int bpp, int pad)
+{
+	fb->width = w;
+	fb->height = h;
+	fb->bpp = bpp;
+	fb->stride = w * bpp / 8 + pad;
+	fb->mem = malloc((size_t)fb->stride * h);
+	memset(fb->mem, FILL, (size_t)fb->stride * h);
+}
+
+static uint32_t pixel(const struct popup_fb *fb, int x, int y)
+{
+	const unsigned char *line = fb->mem + (size_t)y * fb->stride;
+
+	if (fb->bpp == 32)
+		return ((const uint32_t *)line)[x];
+	return ((const uint16_t *)line)[x];
+}
+
+static void scan(const struct popup_fb *fb, struct ink *k)
+{
+	uint32_t fg = fb->bpp == 32 ? 0xffffff : 0xffff;
+	uint32_t v;
+	int x, y;
+
+	memset(k, 0, sizeof(*k));
+	k->x0 = fb->width;
+	k->y0 = fb->height;
+	for (y = 0; y < fb->height; y++) {
+		for (x = 0; x < fb->width; x++) {
+			v = pixel(fb, x, y);
+			if (v == 0)
+				continue;
+			if (v != fg) {
+				k->others++;
+				continue;
+			}
+			k->count++;
+			if (x < k->x0)
+				k->x0 = x;
+			if (x > k->x1)
+				k->x1 = x;
+			if (y < k->y0)
+				k->y0 = y;
+			if (y > k->y1)
+				k->y1 = y;
+		}
+	}
+}
+
+/* The bytes past each line belong to nobody and must be left alone */
+static int padding_intact(const struct popup_fb *fb)
+{
+	int y, i, used = fb->width * fb->bpp / 8;
+
+	for (y = 0; y < fb->height; y++)
+		for (i = used; i < fb->stride; i++)
+			if (fb->mem[(size_t)y * fb->stride + i] != FILL)
+				return 0;
+	return 1;
+}
+
+/* Cleared to black, white text centred within a glyph cell */
+static void test_centred(int bpp, int pad)
+{
+	struct popup_fb fb;
+	struct ink k;
+	int cx, cy;
+
+	fb_new(&fb, 480, 800, bpp, pad);
+	CHECK(popup_emerg_draw(&fb, "LOW BATTERY") == 0, "%dbpp: draw failed", bpp);
+	scan(&fb, &k);
+
+	CHECK(k.others == 0, "%dbpp: %d pixels neither black nor white",
+	      bpp, k.others);
+	CHECK(k.count > 0, "%dbpp: nothing drawn", bpp);
+	CHECK(padding_intact(&fb), "%dbpp: wrote past the line", bpp);
+
+	/* 480 px holds 20 cells of 6 px at scale 4, a cell is 24 px */
+	cx = (k.x0 + k.x1) / 2 - fb.width / 2;
+	cy = (k.y0 + k.y1) / 2 - fb.height / 2;
+	CHECK(cx > -24 && cx < 24, "%dbpp: text off centre by %d px", bpp, cx);
+	CHECK(cy > -40 && cy < 40, "%dbpp: text off centre by %d px", bpp, cy);
+	CHECK(k.x1 - k.x0 + 1 == 11 * 24 - 4,
+	      "%dbpp: text is %d px wide", bpp, k.x1 - k.x0 + 1);
+
+	free(fb.mem);
+}
+
+/* A message wider than the screen goes onto several lines */
+static void test_wrap(void)
+{
+	struct popup_fb fb;
+	struct ink one, many;
+
+	fb_new(&fb, 480, 800, 32, 0);
+	popup_emerg_draw(&fb, "BATTERY");
+	scan(&fb, &one);
+	popup_emerg_draw(&fb, "BATTERY CRITICALLY LOW. THE DEVICE WILL "
+			 "POWER OFF NOW");
+	scan(&fb, &many);
+
+	CHECK(many.x1 < fb.width && many.x0 >= 0, "wrapped text clipped");
+	CHECK(many.y1 - many.y0 > 2 * (one.y1 - one.y0),
+	      "long message not wrapped: %d px high", many.y1 - many.y0);
+	free(fb.mem);
+}
+
+/* Lower case is drawn as upper case, anything unknown as '?' */
+static void test_glyphs(void)
+{
+	struct popup_fb a, b;
+	size_t len;
+
+	fb_new(&a, 240, 320, 32, 0);
+	fb_new(&b, 240, 320, 32, 0);
+	len = (size_t)a.stride * a.height;
+
+	popup_emerg_draw(&a, "off");
+	popup_emerg_draw(&b, "OFF");
+	CHECK(memcmp(a.mem, b.mem, len) == 0, "lower case differs");
+
+	popup_emerg_draw(&a, "~");
+	popup_emerg_draw(&b, "?");
+	CHECK(memcmp(a.mem, b.mem, len) == 0, "unknown glyph is not '?'");
+
+	free(a.mem);
+	free(b.mem);
+}
+
+/* Surfaces it cannot draw on are refused untouched */
+static void test_refused(void)
+{
+	struct popup_fb fb;
+	unsigned char *mem;
+
+	fb_new(&fb, 480, 800, 32, 0);
+	mem = fb.mem;
+
+	fb.bpp = 24;
+	CHECK(popup_emerg_draw(&fb, "X") < 0, "24bpp accepted");
+	fb.bpp = 32;
+	fb.width = 4;
+	CHECK(popup_emerg_draw(&fb, "X") < 0, "surface narrower than a cell accepted");
+	fb.width = 480;
+	CHECK(popup_emerg_draw(&fb, NULL) < 0, "NULL message accepted");
+	CHECK(mem[0] == FILL && mem[(size_t)fb.stride * fb.height - 1] == FILL,
+	      "refused surface was written");
+	fb.mem = NULL;
+	CHECK(popup_emerg_draw(&fb, "X") < 0, "NULL surface accepted");
+
+	free(mem);
+}
+
+int main(void)
+{
+	test_centred(32, 0);
+	test_centred(16, 0);
+	test_centred(16, 6);
+	test_wrap();
+	test_glyphs();
+	test_refused();
+
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("lowbatt emerg: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Battery monitor decisions against synthetic discharge curves.
+ *
+ * Samples are fed to lowbatt_monitor_update() one minute apart, and the
+ * sysfs reader is run against a fake power_supply tree, so nothing here
+ * needs a battery or a main loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "src/lowbatt-monitor.h"
+
+#define MINUTE_MS	60000
+
+static int failures = 0;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);	\
+			fprintf(stderr, __VA_ARGS__);			\
+			fprintf(stderr, "\n");				\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Events raised by one curve */
+struct run {
+	int warnings;
+	int poweroffs;
+	int charge_errors;
+	int first_warning_at;		/* capacity of the first warning */
+	int poweroff_at;		/* sample index of the power-off */
+};
+
+static void feed(struct lowbatt_state *st, const int *cap, int n,
+		 int charging, int health_ok, struct run *r)
+{
+	struct lowbatt_sample s;
+	static uint64_t ms = 0;
+	int i, ev;
+
+	for (i = 0; i < n; i++) {
+		ms += MINUTE_MS;
+		s.capacity = cap[i];
+		s.charging = charging;
+		s.health_ok = health_ok;
+		s.ms = ms;
+
+		ev = lowbatt_monitor_update(st, &s);
+		if (ev == LOWBATT_EV_WARNING) {
+			if (r->warnings++ == 0)
+				r->first_warning_at = cap[i];
+		} else if (ev == LOWBATT_EV_POWEROFF) {
+			r->poweroffs++;
+			r->poweroff_at = i;
+		} else if (ev == LOWBATT_EV_CHARGE_ERROR) {
+			r->charge_errors++;
+		}
+	}
+}
+
+/* 1% a minute from 20% down to empty */
+static void test_steady_discharge(void)
+{
+	struct lowbatt_state st;
+	struct run r;
+	int cap[21], i;
+
+	memset(&st, 0, sizeof(st));
+	memset(&r, 0, sizeof(r));
+	for (i = 0; i <= 20; i++)
+		cap[i] = 20 - i;
+
+	feed(&st, cap, 21, 0, 1, &r);
+	CHECK(r.warnings == LOWBATT_NWARN, "steady: %d warnings", r.warnings);
+	CHECK(r.first_warning_at <= 15 && r.first_warning_at >= 10,
+	      "steady: first warning at %d%%", r.first_warning_at);
+	CHECK(r.poweroffs == 1, "steady: %d power-offs", r.poweroffs);
+	/* Raw capacity, so two samples after reaching 1% */
+	CHECK(cap[r.poweroff_at] <= LOWBATT_POWEROFF_LEVEL &&
+	      cap[r.poweroff_at - 1] <= LOWBATT_POWEROFF_LEVEL,
+	      "steady: power-off at %d%%", cap[r.poweroff_at]);
+	CHECK(st.rate < 0, "steady: rate %d", st.rate);
+}
+
+/* Jitter around a level warns once, climbing clear of it rearms */
+static void test_hysteresis(void)
+{
+	static const int down[] = { 20, 18, 16, 14, 12, 12, 12 };
+	static const int jitter[] = { 13, 15, 13, 16, 14, 16, 13, 15 };
+	static const int up[] = { 18, 22, 26, 30, 30, 30 };
+	static const int hold[] = { 12, 12, 12, 12, 12, 12, 12, 12 };
+	struct lowbatt_state st;
+	struct run r;
+
+	memset(&st, 0, sizeof(st));
+	memset(&r, 0, sizeof(r));
+
+	feed(&st, down, sizeof(down) / sizeof(down[0]), 0, 1, &r);
+	CHECK(r.warnings == 1, "hyst: %d warnings going down", r.warnings);
+
+	feed(&st, jitter, sizeof(jitter) / sizeof(jitter[0]), 0, 1, &r);
+	CHECK(r.warnings == 1, "hyst: jitter raised %d warnings", r.warnings);
+
+	/* Charged back up, the 15% warning is armed again */
+	feed(&st, up, sizeof(up) / sizeof(up[0]), 1, 1, &r);
+	CHECK(st.warned == 0, "hyst: %d levels still warned", st.warned);
+
+	feed(&st, down, sizeof(down) / sizeof(down[0]), 0, 1, &r);
+	feed(&st, hold, sizeof(hold) / sizeof(hold[0]), 0, 1, &r);
+	CHECK(r.warnings == 2, "hyst: %d warnings after rearm", r.warnings);
+	CHECK(r.poweroffs == 0, "hyst: unexpected power-off");
+}
+
+/* A single bad reading at the bottom must not shut the device down */
+static void test_poweroff_confirm(void)
+{
+	static const int glitch[] = { 10, 10, 1, 10, 10 };
+	static const int empty[] = { 1, 1 };
+	struct lowbatt_state st;
+	struct run r;
+
+	memset(&st, 0, sizeof(st));
+	memset(&r, 0, sizeof(r));
+
+	feed(&st, glitch, 3, 0, 1, &r);
+	CHECK(st.low_count == 1, "confirm: low count %d", st.low_count);
+	CHECK(lowbatt_monitor_next_ms(&st) == LOWBATT_POLL_MIN_MS,
+	      "confirm: next sample in %u ms", lowbatt_monitor_next_ms(&st));
+
+	feed(&st, glitch + 3, 2, 0, 1, &r);
+	CHECK(r.poweroffs == 0, "confirm: glitch powered off");
+
+	/* Plugging in cancels a pending confirmation */
+	feed(&st, empty, 1, 0, 1, &r);
+	feed(&st, empty, 1, 1, 1, &r);
+	CHECK(st.low_count == 0 && r.poweroffs == 0, "confirm: charger ignored");
+
+	feed(&st, empty, 2, 0, 1, &r);
+	CHECK(r.poweroffs == 1, "confirm: %d power-offs", r.poweroffs);
+	feed(&st, empty, 2, 0, 1, &r);
+	CHECK(r.poweroffs == 1, "confirm: power-off repeated");
+}
+
+/* Charging stopped on temperature reports once until health recovers */
+static void test_charge_error(void)
+{
+	static const int cap[] = { 50, 50, 50 };
+	struct lowbatt_state st;
+	struct run r;
+
+	memset(&st, 0, sizeof(st));
+	memset(&r, 0, sizeof(r));
+
+	feed(&st, cap, 3, 1, 0, &r);
+	CHECK(r.charge_errors == 1, "charge: %d errors", r.charge_errors);
+	feed(&st, cap, 1, 1, 1, &r);
+	feed(&st, cap, 1, 1, 0, &r);
+	CHECK(r.charge_errors == 2, "charge: %d errors after recovery",
+	      r.charge_errors);
+}
+
+static int write_attr(const char *dir, const char *attr, const char *val)
+{
+	char path[PATH_MAX];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, attr);
+	fp = fopen(path, "w");
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "%s\n", val);
+	return fclose(fp);
+}
+
+static void remove_attr(const char *dir, const char *attr)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", dir, attr);
+	unlink(path);
+}
+
+/* The reader against a fake power_supply tree */
+static void test_sysfs(void)
+{
+	char root[] = "/tmp/lowbatt-test.XXXXXX";
+	char ac[PATH_MAX], bat[PATH_MAX], dir[PATH_MAX];
+	struct lowbatt_sample s;
+
+	if (mkdtemp(root) == NULL) {
+		CHECK(0, "sysfs: no temp dir");
+		return;
+	}
+	snprintf(ac, sizeof(ac), "%s/ac", root);
+	snprintf(bat, sizeof(bat), "%s/battery", root);
+	mkdir(ac, 0755);
+	mkdir(bat, 0755);
+	write_attr(ac, "type", "Mains");
+	write_attr(bat, "type", "Battery");
+	write_attr(bat, "capacity", "4");
+	write_attr(bat, "status", "Discharging");
+	write_attr(bat, "health", "Good");
+
+	CHECK(lowbatt_battery_dir(root, dir, sizeof(dir)) == 0 &&
+	      strcmp(dir, bat) == 0, "sysfs: battery not found");
+
+	CHECK(lowbatt_monitor_read(root, &s) == 0, "sysfs: read failed");
+	CHECK(s.capacity == 4 && !s.charging && s.health_ok,
+	      "sysfs: read %d%% charging %d health %d",
+	      s.capacity, s.charging, s.health_ok);
+
+	write_attr(bat, "capacity", "120");
+	write_attr(bat, "status", "Charging");
+	write_attr(bat, "health", "Overheat");
+	CHECK(lowbatt_monitor_read(root, &s) == 0 && s.capacity == 100 &&
+	      s.charging && !s.health_ok, "sysfs: charging overheat misread");
+
+	remove_attr(ac, "type");
+	remove_attr(bat, "type");
+	remove_attr(bat, "capacity");
+	remove_attr(bat, "status");
+	remove_attr(bat, "health");
+	rmdir(ac);
+	rmdir(bat);
+	rmdir(root);
+}
+
+int main(void)
+{
+	test_steady_discharge();
+	test_hysteresis();
+	test_poweroff_confirm();
+	test_charge_error();
+	test_sysfs();
+
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("lowbatt monitor: all checks passed\n");
+	return 0;
+}
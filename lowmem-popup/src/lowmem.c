@@ -25,6 +25,18 @@
 #include "lowmem.h"
 #include <Ecore_X.h>
 #include <utilX.h>
+#include "popup-vconf.h"
+#include "popup-timer.h"
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-screen.h"
+#include "popup-x.h"
+#include "popup-trace.h"
+#include "popup-arena.h"
+#include "popup-pool.h"
+#include "popup-memprof.h"
+#include "popup-font.h"
 
 #define APPLICATION_BG		1
 #define INDICATOR_HEIGHT	(38)	/* the case of 480*800 */
@@ -36,7 +48,12 @@
 #include <sys/acct.h>
 #endif /* ACCT_PROF */
 
+/* Strings and buffers of the request on screen, dropped on close */
+static struct popup_arena req_arena = POPUP_ARENA_INIT;
 static const char *process_name = NULL;
+static struct popup_timer dismiss_timer;
+
+int lowmem_start(void *data);
 
 #include <syspopup.h>
 
@@ -112,15 +129,18 @@ static Evas_Object *create_win(const char *name)
 	Evas_Object *eo;
 	int w, h;
 
-	eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC);
+	POPUP_X("elm_win_add", eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC));
 	if (eo) {
 		elm_win_title_set(eo, name);
 		elm_win_borderless_set(eo, EINA_TRUE);
 		evas_object_smart_callback_add(eo, "delete,request", win_del, NULL);
 		elm_win_alpha_set(eo, EINA_TRUE);
-		ecore_x_window_size_get(ecore_x_window_root_first_get(), &w,
-				&h);
+		/* Cached geometry, no round trip on a warm start */
+		popup_screen_get(&w, &h, NULL);
 		evas_object_resize(eo, w, h);
+
+		/* Queued ahead of the map request */
+		popup_x_prepare(eo, 0);
 	}
 
 	return eo;
@@ -159,6 +179,7 @@ static int app_terminate(void *data)
 	if (ad->win_main)
 		evas_object_del(ad->win_main);
 
+	popup_arena_fini(&req_arena);
 	return 0;
 }
 
@@ -180,13 +201,30 @@ static int app_reset(bundle *b, void *data)
 {
 	struct appdata *ad = data;
 	int ret = 0;
+	uint64_t start;
+
+	popup_stats_inc(POPUP_STAT_LAUNCH);
+	popup_trace_request(b, ad->win_main);
+	start = popup_trace_begin();
 
 	if (syspopup_has_popup(b)) {
 		syspopup_reset(b);
+
+		/* Show the lingering window again */
+		if (popup_linger_reuse()) {
+			evas_object_show(ad->win_main);
+			process_name = popup_arena_strdup(&req_arena,
+					bundle_get_val(b, "_APP_NAME_"));
+			if (process_name == NULL)
+				process_name = "unknown_app";
+			lowmem_start((void *)ad);
+		}
 	} else {
-		ret = syspopup_create(b, &handler, ad->win_main, ad);
-		evas_object_show(ad->win_main);
-		process_name = bundle_get_val(b, "_APP_NAME_"); 
+		POPUP_X("syspopup_create",
+			ret = syspopup_create(b, &handler, ad->win_main, ad));
+		POPUP_X("win_show", evas_object_show(ad->win_main));
+		process_name = popup_arena_strdup(&req_arena,
+						  bundle_get_val(b, "_APP_NAME_"));
 		if (process_name == NULL)
 			process_name = "unknown_app";
 
@@ -194,39 +232,41 @@ static int app_reset(bundle *b, void *data)
 		lowmem_start((void *)ad);
 	}
 
+	popup_trace_end("app_reset", start);
 	return 0;
 }
 
-/* Customized print */
-void system_print(const char *format, ...)
-{
-	/* Un-comment return to disable logs */
-	return;
-
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-}
-
 /* Cleanup objects to avoid mem-leak */
 void lowmem_cleanup(struct appdata *ad)
 {
 	if (ad == NULL)
 		return;
 
+	popup_timer_cancel(&dismiss_timer);
 	if (ad->popup)
-		evas_object_del(ad->popup);
+		popup_pool_put(ad->popup);
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
+	ad->popup = NULL;
+	ad->layout_main = NULL;
+}
+
+static void lowmem_release(void *data)
+{
+	lowmem_cleanup(data);
+	process_name = NULL;
+	popup_arena_reset(&req_arena);
 }
 
 /* Background clicked noti */
 void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
+	struct appdata *ad = data;
+
 	system_print("\n system-popup : In BG Noti \n");
 	fflush(stdout);
-	exit(0);
+	popup_stats_inc(POPUP_STAT_CHOICE_OK);
+	popup_linger_dismiss(ad->win_main, lowmem_release, ad);
 }
 
 void lowmem_clicked_cb(void *data, Evas * e, Evas_Object * obj,
@@ -254,68 +294,72 @@ int lowmem_play_vibration()
 
 	/* Open the haptic device */
 	dev_handle = device_haptic_open(DEV_IDX_0, mode);
-	if (dev_handle < 0)
+	if (dev_handle < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	/* Play a monotone pattern for 1s */
 	ret_val = device_haptic_play_monotone(dev_handle, 1000);
 	device_haptic_close(dev_handle);
-	if (ret_val < 0)
+	if (ret_val < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	return 0;
 }
 
 void lowmem_timeout_func(void *data)
 {
-	system_print("\n System-popup : In Lowmem timeout\n");
-
-	/* Cleanup */
-	lowmem_cleanup(data);
+	struct popup_timer_stats st;
 
-	/* Now get lost */
-	exit(0);
+	system_print("\n System-popup : In Lowmem timeout\n");
+	popup_stats_inc(POPUP_STAT_TIMEOUT);
+	popup_timer_stats_get(&st);
+	system_print("\n System-popup : timers fired %u, late max %ums avg %ums \n",
+		     st.fired, st.late_max_ms, st.late_avg_ms);
+
+	/* Cleanup, then wait for reuse or get lost */
+	popup_linger_dismiss(((struct appdata *)data)->win_main,
+			     lowmem_release, data);
 }
 
 /* Basic popup widget */
 int lowmem_create_and_show_basic_popup(struct appdata *ad)
 {
-	Evas_Object *btn1;
-
 	/* Initialization */
-	char *note = (char *)malloc(MAX_PROCESS_NAME * (sizeof(char)));
+	char *note;
 	char note_buf[MAX_PROCESS_NAME] = {0, };
 	int ret_val = 0;
 
+	system_print("\n System-popup : process name is %s \n", process_name);
+	snprintf(note_buf, MAX_PROCESS_NAME, _("IDS_IDLE_POP_PS_CLOSED"), process_name);
+	note = popup_arena_printf(&req_arena, "%s %s",
+				  _("IDS_COM_POP_NOT_ENOUGH_MEMORY"), note_buf);
 	if (!note) {
 		system_print("\n System-popup : can not malloc \n");
 		return -1;
 	}
-	system_print("\n System-popup : process name is %s \n", process_name);
-	snprintf(note_buf, MAX_PROCESS_NAME, _("IDS_IDLE_POP_PS_CLOSED"), process_name);
-	snprintf(note, MAX_PROCESS_NAME, "%s %s", _("IDS_COM_POP_NOT_ENOUGH_MEMORY"),note_buf);
 
 	/* Add notify */
 	/* No need to give main window, it will create internally */
-	ad->popup = elm_popup_add(ad->win_main);
-	evas_object_size_hint_weight_set(ad->popup, EVAS_HINT_EXPAND,
-					 EVAS_HINT_EXPAND);
-	elm_popup_timeout_set(ad->layout_main, 3);
+	ad->popup = popup_pool_get(ad->win_main, 1);
+	if (ad->popup == NULL) {
+		system_print("\n System-popup : Add popup failed \n");
+		return -1;
+	}
+	popup_timer_arm(&dismiss_timer, DISMISS_SEC * 1000,
+			lowmem_timeout_func, ad);
 	elm_object_text_set(ad->popup, note);
 	elm_object_part_text_set(ad->popup, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
 
-	btn1 = elm_button_add(ad->popup);
-	elm_object_text_set(btn1, _("IDS_COM_SK_OK"));
-	elm_object_part_content_set(ad->popup, "button1", btn1);
-	elm_object_style_set(btn1, "popup_button/default");
-	evas_object_smart_callback_add(btn1, "clicked", bg_clicked_cb, ad);
+	popup_pool_button_set(ad->popup, 0, _("IDS_COM_SK_OK"), bg_clicked_cb, ad);
 
-	Ecore_X_Window xwin;
-	xwin = elm_win_xwindow_get(ad->popup);
-	ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION);
 	evas_object_show(ad->popup);
-
-	free(note);
+	popup_linger_shown();
+	popup_stats_inc(POPUP_STAT_SHOW);
+	popup_x_report();
 
 	return 0;
 }
@@ -324,26 +368,45 @@ int lowmem_start(void *data)
 {
 	struct appdata *ad = data;
 	int ret_val = 0;
+	int vib_on, snd_on;
+	int reads, saved;
 
 	/* Create and show popup */
-	ret_val = lowmem_create_and_show_basic_popup(ad);
+	POPUP_TRACE("popup_create",
+		    ret_val = lowmem_create_and_show_basic_popup(ad));
 	if (ret_val != 0)
 		return -1;
+	popup_memprof_phase("popup_build");
 
 	/* Change LCD brightness */
-	ret_val = pm_change_state(LCD_NORMAL);
-	if (ret_val != 0)
+	POPUP_TRACE("pm_change_state", ret_val = pm_change_state(LCD_NORMAL));
+	if (ret_val != 0) {
+		popup_stats_inc(POPUP_STAT_PM_FAIL);
 		return -1;
+	}
 
 	/* Play vibration */
-	ret_val = lowmem_play_vibration();
-	if (ret_val == -1)
-		system_print("\n Lowmem : Play vibration failed \n");
+	if (popup_vconf_get(POPUP_VCONF_VIBRATION_ON, &vib_on) < 0)
+		vib_on = 1;
+	if (vib_on) {
+		POPUP_TRACE("haptic_play", ret_val = lowmem_play_vibration());
+		if (ret_val == -1)
+			system_print("\n Lowmem : Play vibration failed \n");
+	}
 
 	/* Play the sound alert */
-	ret_val = mm_sound_play_keysound(SOUND_PATH, 1);
-	if (ret_val != 0)
-		system_print("\n Lowmem : Play vibration failed \n");
+	if (popup_vconf_get(POPUP_VCONF_SOUND_ON, &snd_on) < 0)
+		snd_on = 1;
+	if (snd_on) {
+		POPUP_TRACE("keysound_play",
+			    ret_val = mm_sound_play_keysound(SOUND_PATH, 1));
+		if (ret_val != 0)
+			system_print("\n Lowmem : Play vibration failed \n");
+	}
+
+	popup_vconf_stats(&reads, &saved);
+	system_print("\n Lowmem : vconf %d reads, %d from snapshot \n",
+		     reads, saved);
 
 	return 0;
 }
@@ -354,12 +417,20 @@ int app_create(void *data)
 	Evas_Object *win;
 	struct appdata *ad = data;
 
+	popup_memprof_phase("efl_init");
+
 	/* create window */
 	win = create_win(PACKAGE);
 	if (win == NULL)
 		return -1;
 
 	ad->win_main = win;
+	popup_memprof_phase("create_win");
+	popup_memprof_watch(win);
+	POPUP_TRACE("font_apply", popup_font_apply());
+
+	/* Settings read on the show path */
+	popup_vconf_init();
 
 	return 0;
 
@@ -379,6 +450,12 @@ int main(int argc, char *argv[])
 		.reset = app_reset,
 	};
 
+	popup_log_init(PACKAGE);
+	popup_trace_init(PACKAGE);
+	popup_memprof_init(PACKAGE);
+	popup_linger_init(PACKAGE);
+	popup_stats_init(POPUP_TYPE_LOWMEM);
+
 	memset(&ad, 0x0, sizeof(struct appdata));
 	ops.data = &ad;
 
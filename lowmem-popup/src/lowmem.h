@@ -41,6 +41,7 @@
 #define GRP_POPUP		"popup"
 #define MAX_PROCESS_NAME	100
 #define PROCESS_NAME_FILE	"/tmp/processname.txt"
+#define DISMISS_SEC		3	/* auto-dismiss */
 #define BEAT
 
 struct appdata {
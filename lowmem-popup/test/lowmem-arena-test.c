@@ -0,0 +1,150 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Request-scoped arena bookkeeping across popup requests.
+ *
+ * Each request takes the copies lowmem makes for one launch, the app
+ * name and the note, and is then reset as on dismissal. The counters
+ * must describe that request alone and the second request must be
+ * served from the chunk the first one left behind.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "popup-arena.h"
+
+#define REQUESTS	4
+
+static int failures = 0;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);	\
+			fprintf(stderr, __VA_ARGS__);			\
+			fprintf(stderr, "\n");				\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* One lowmem launch: app name, note, returns the first allocation */
+static void *request(struct popup_arena *a, int i)
+{
+	char name[32], want[64];
+	char *p, *note;
+
+	snprintf(name, sizeof(name), "org.example.app%d", i);
+	snprintf(want, sizeof(want), "Not enough memory. %s closed", name);
+	p = popup_arena_strdup(a, name);
+	note = popup_arena_printf(a, "%s %s closed", "Not enough memory.", p);
+
+	CHECK(p && strcmp(p, name) == 0, "request %d: name not copied", i);
+	CHECK(note && strcmp(note, want) == 0, "request %d: note not formatted", i);
+	CHECK(((uintptr_t)note & (POPUP_ARENA_ALIGN - 1)) == 0,
+	      "request %d: note not aligned", i);
+	return p;
+}
+
+static void test_requests(void)
+{
+	struct popup_arena a = POPUP_ARENA_INIT;
+	size_t name_len = strlen("org.example.app0") + 1;
+	size_t note_len = strlen("Not enough memory. org.example.app0 closed") + 1;
+	void *first = NULL, *p;
+	int i;
+
+	for (i = 0; i < REQUESTS; i++) {
+		p = request(&a, i);
+
+		CHECK(a.nalloc == 2, "request %d: %u allocations", i, a.nalloc);
+		CHECK(a.used == name_len + note_len, "request %d: %zu bytes", i,
+		      a.used);
+		CHECK(a.nchunk == 1, "request %d: %u chunks", i, a.nchunk);
+		if (i == 0)
+			first = p;
+		else
+			CHECK(p == first, "request %d: first chunk not reused", i);
+
+		popup_arena_reset(&a);
+		CHECK(a.nalloc == 0 && a.used == 0,
+		      "request %d: counters not cleared", i);
+		CHECK(a.chunks != NULL, "request %d: first chunk dropped", i);
+		CHECK(a.nreset == (unsigned int)i + 1, "request %d: %u resets", i,
+		      a.nreset);
+	}
+
+	popup_arena_fini(&a);
+	CHECK(a.chunks == NULL, "fini kept a chunk");
+}
+
+/* Overflow and oversized chunks go away on reset, the first stays */
+static void test_overflow(void)
+{
+	struct popup_arena a = POPUP_ARENA_INIT;
+	void *first, *p;
+	int i;
+
+	first = popup_arena_alloc(&a, 1);
+	for (i = 0; i < 3; i++)
+		popup_arena_alloc(&a, POPUP_ARENA_CHUNK / 2);
+	p = popup_arena_alloc(&a, POPUP_ARENA_CHUNK * 3);
+
+	CHECK(p != NULL, "oversized allocation failed");
+	CHECK(a.nalloc == 5, "%u allocations", a.nalloc);
+	CHECK(a.used == 1 + 3 * (POPUP_ARENA_CHUNK / 2) + POPUP_ARENA_CHUNK * 3,
+	      "%zu bytes", a.used);
+	CHECK(a.nchunk == 3, "%u chunks", a.nchunk);
+
+	popup_arena_reset(&a);
+	CHECK(popup_arena_alloc(&a, 1) == first, "reset did not keep the first chunk");
+	CHECK(a.nchunk == 3, "reset took a new chunk: %u", a.nchunk);
+
+	/* A full first chunk again spills into exactly one new one */
+	popup_arena_alloc(&a, POPUP_ARENA_CHUNK - 1);
+	CHECK(a.nchunk == 4, "%u chunks after refilling", a.nchunk);
+
+	popup_arena_fini(&a);
+}
+
+/* NULL bundle values copy through as NULL and allocate nothing */
+static void test_null(void)
+{
+	struct popup_arena a = POPUP_ARENA_INIT;
+
+	CHECK(popup_arena_strdup(&a, NULL) == NULL, "NULL not kept");
+	CHECK(a.nalloc == 0 && a.nchunk == 0, "NULL allocated");
+	popup_arena_reset(&a);
+	CHECK(a.chunks == NULL, "reset of an empty arena made a chunk");
+	popup_arena_fini(&a);
+}
+
+int main(void)
+{
+	test_requests();
+	test_overflow();
+	test_null();
+
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("lowmem arena: all checks passed\n");
+	return 0;
+}
@@ -7,6 +7,7 @@ License:    Flora Software License
 Source0:    %{name}-%{version}.tar.bz2
 BuildRequires:  pkgconfig(evas)
 BuildRequires:  pkgconfig(ecore-input)
+BuildRequires:  pkgconfig(ecore-x)
 BuildRequires:  pkgconfig(ethumb)
 BuildRequires:  pkgconfig(elementary)
 BuildRequires:  pkgconfig(efreet)
@@ -23,6 +24,11 @@ BuildRequires:  pkgconfig(notification)
 BuildRequires:  pkgconfig(pmapi)
 BuildRequires:  pkgconfig(appsvc)
 BuildRequires:  pkgconfig(svi)
+BuildRequires:  pkgconfig(bundle)
+BuildRequires:  pkgconfig(vconf)
+BuildRequires:  pkgconfig(x11)
+BuildRequires:  pkgconfig(edje)
+BuildRequires:  pkgconfig(fontconfig)
 
 BuildRequires:  cmake
 BuildRequires:  edje-bin
@@ -90,6 +96,11 @@ rm -rf %{buildroot}
 
 %files
 %defattr(-,root,root,-)
+/usr/bin/popup-logdump
+/usr/bin/popup-stats
+/usr/bin/popup-timeline
+/usr/bin/popup-readahead
+/usr/bin/popup-fontcache
 
 
 %files -n org.tizen.poweroff-syspopup
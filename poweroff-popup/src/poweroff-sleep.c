@@ -0,0 +1,233 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Sleep from the poweroff popup, with the suspend path timed.
+ *
+ * The popup syncs, asks sysman for entersleep and then watches for the
+ * gap CLOCK_MONOTONIC opens against CLOCK_BOOTTIME while the system is
+ * suspended. Once it is thawed it reads the kernel log written in the
+ * meantime for the sync, task freezing and device phases. Setting
+ * POWEROFF_SLEEP_STANDIN makes the popup write "mem" to that path itself
+ * instead, a local stand-in for system-server on development targets.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sysman.h>
+#include "poweroff-sleep.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-timer.h"
+
+#ifndef PREDEF_ENTERSLEEP
+#define PREDEF_ENTERSLEEP	"entersleep"
+#endif
+
+struct sleep {
+	poweroff_sleep_cb cb;
+	void *data;
+	struct poweroff_sleep_timing t;
+	struct popup_timer check;
+	double start;
+	double offset;			/* boottime - monotonic at request */
+	int kmsg;
+};
+
+static struct sleep sl = { .kmsg = -1 };
+
+static double clock_ms(clockid_t id)
+{
+	struct timespec ts;
+
+	clock_gettime(id, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* Grows by the time spent suspended, monotonic stops meanwhile */
+static double asleep_offset(void)
+{
+	return clock_ms(CLOCK_BOOTTIME) - clock_ms(CLOCK_MONOTONIC);
+}
+
+static int standin(const char *path)
+{
+	int fd, ret;
+
+	fd = open(path, O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	/* Returns after resume when path is the real power state */
+	ret = write(fd, "mem", 3) == 3 ? 0 : -1;
+	close(fd);
+	return ret;
+}
+
+/* Records are "prio,seq,usec,flags;text", timestamps stop in suspend */
+static void read_kmsg(int fd, struct poweroff_sleep_timing *t)
+{
+	unsigned long long ts, sync_ts = 0, freeze_ts = 0, frozen_ts = 0;
+	unsigned long long restart_ts = 0;
+	char buf[1024], *msg, *p;
+	int after_freeze = 0;
+	double el;
+	ssize_t n;
+
+	for (;;) {
+		n = read(fd, buf, sizeof(buf) - 1);
+		if (n < 0 && errno == EPIPE)
+			continue;	/* overwritten, skip ahead */
+		if (n <= 0)
+			break;
+		buf[n] = '\0';
+
+		msg = strchr(buf, ';');
+		if (msg == NULL || sscanf(buf, "%*u,%*u,%llu", &ts) != 1)
+			continue;
+		msg++;
+
+		if (after_freeze && frozen_ts == 0)
+			frozen_ts = ts;
+
+		if (strstr(msg, "Syncing filesystems")) {
+			sync_ts = ts;
+		} else if (strstr(msg, "Freezing")) {
+			if (freeze_ts == 0)
+				freeze_ts = ts;
+			p = strstr(msg, "elapsed ");
+			if (p && sscanf(p, "elapsed %lf", &el) == 1)
+				t->freeze_ms = (t->freeze_ms < 0 ? 0 : t->freeze_ms) +
+					el * 1000.0;
+			if (strstr(msg, "remaining"))
+				after_freeze = 1;
+		} else if (strstr(msg, "Restarting tasks")) {
+			restart_ts = ts;
+		}
+	}
+
+	if (sync_ts && freeze_ts > sync_ts)
+		t->kernel_sync_ms = (freeze_ts - sync_ts) / 1000.0;
+	if (frozen_ts && restart_ts > frozen_ts)
+		t->devices_ms = (restart_ts - frozen_ts) / 1000.0;
+}
+
+static void report(const struct poweroff_sleep_timing *t)
+{
+	system_print("\n System-popup : sleep %s, sync %.1fms request %.1fms \n",
+		     t->resumed ? "resumed" : "not seen", t->sync_ms, t->request_ms);
+	system_print("\n System-popup : kernel sync %.1fms freeze %.1fms devices %.1fms asleep %.0fms \n",
+		     t->kernel_sync_ms, t->freeze_ms, t->devices_ms, t->asleep_ms);
+
+	popup_stats_gauge_set(POPUP_GAUGE_SLEEP_SYNC_MS, (int64_t)(t->sync_ms + t->kernel_sync_ms));
+	popup_stats_gauge_set(POPUP_GAUGE_SLEEP_FREEZE_MS, (int64_t)t->freeze_ms);
+	popup_stats_gauge_set(POPUP_GAUGE_SLEEP_DEVICES_MS, (int64_t)t->devices_ms);
+	if (t->resumed)
+		popup_stats_inc(POPUP_STAT_SLEEP_RESUME);
+}
+
+static void check_cb(void *data)
+{
+	double gap = asleep_offset() - sl.offset;
+
+	if (gap < SLEEP_ASLEEP_MIN_MS &&
+	    clock_ms(CLOCK_MONOTONIC) - sl.start < SLEEP_WAIT_MS) {
+		popup_timer_arm(&sl.check, SLEEP_CHECK_MS, check_cb, NULL);
+		return;
+	}
+
+	sl.t.resumed = gap >= SLEEP_ASLEEP_MIN_MS;
+	sl.t.asleep_ms = sl.t.resumed ? gap : 0;
+	if (sl.kmsg >= 0) {
+		read_kmsg(sl.kmsg, &sl.t);
+		close(sl.kmsg);
+		sl.kmsg = -1;
+	}
+
+	report(&sl.t);
+	if (sl.cb)
+		sl.cb(&sl.t, sl.data);
+}
+
+/* Sync, request the suspend, report through cb once thawed or given up */
+int poweroff_sleep_enter(poweroff_sleep_cb cb, void *data)
+{
+	const char *path;
+	double t;
+	int ret;
+
+	memset(&sl.t, 0, sizeof(sl.t));
+	sl.t.kernel_sync_ms = -1;
+	sl.t.freeze_ms = -1;
+	sl.t.devices_ms = -1;
+	sl.cb = cb;
+	sl.data = data;
+
+	/* Only what the kernel logs from here on */
+	if (sl.kmsg < 0) {
+		sl.kmsg = open(SLEEP_KMSG, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (sl.kmsg >= 0)
+			lseek(sl.kmsg, 0, SEEK_END);
+	}
+
+	/* Less for the kernel to write back with tasks frozen */
+	t = clock_ms(CLOCK_MONOTONIC);
+	sync();
+	sl.t.sync_ms = clock_ms(CLOCK_MONOTONIC) - t;
+
+	sl.start = clock_ms(CLOCK_MONOTONIC);
+	sl.offset = asleep_offset();
+
+	path = getenv(SLEEP_STANDIN_ENV);
+	t = clock_ms(CLOCK_MONOTONIC);
+	if (path && path[0])
+		ret = standin(path);
+	else
+		ret = sysman_call_predef_action(PREDEF_ENTERSLEEP, 0);
+	sl.t.request_ms = clock_ms(CLOCK_MONOTONIC) - t;
+
+	if (ret == -1) {
+		system_print("\n System-popup : failed to request entersleep \n");
+		if (sl.kmsg >= 0) {
+			close(sl.kmsg);
+			sl.kmsg = -1;
+		}
+		return -1;
+	}
+
+	popup_timer_arm(&sl.check, SLEEP_CHECK_MS, check_cb, NULL);
+	return 0;
+}
+
+/* Stop waiting for the resume, cb is not called */
+void poweroff_sleep_cancel(void)
+{
+	popup_timer_cancel(&sl.check);
+	if (sl.kmsg >= 0) {
+		close(sl.kmsg);
+		sl.kmsg = -1;
+	}
+	sl.cb = NULL;
+	sl.data = NULL;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_poweroff_sleep_H_
+#define __DEF_poweroff_sleep_H_
+
+#define SLEEP_KMSG		"/dev/kmsg"
+
+/* Path written with "mem" instead of asking sysman, e.g. /sys/power/state */
+#define SLEEP_STANDIN_ENV	"POWEROFF_SLEEP_STANDIN"
+
+#define SLEEP_CHECK_MS		500	/* resume polling */
+#define SLEEP_WAIT_MS		30000	/* give up on seeing a suspend */
+#define SLEEP_ASLEEP_MIN_MS	100	/* clock gap that counts as asleep */
+
+/* Where the time went, -1 where the kernel log had nothing */
+struct poweroff_sleep_timing {
+	double sync_ms;			/* our sync() before the request */
+	double request_ms;		/* sysman call or stand-in write */
+	double kernel_sync_ms;
+	double freeze_ms;		/* user space and freezable kernel tasks */
+	double devices_ms;		/* device suspend and resume */
+	double asleep_ms;
+	int resumed;
+};
+
+typedef void (*poweroff_sleep_cb)(const struct poweroff_sleep_timing *t,
+				  void *data);
+
+int poweroff_sleep_enter(poweroff_sleep_cb cb, void *data);
+void poweroff_sleep_cancel(void);
+
+#endif				/* __DEF_poweroff_sleep_H__ */
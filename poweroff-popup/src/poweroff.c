@@ -16,6 +16,7 @@
 
 
 #include <stdio.h>
+#include <unistd.h>
 #include <appcore-efl.h>
 #include <sensor.h>
 #include <devman.h>
@@ -35,11 +36,29 @@
 
 #include <syspopup.h>
 #include <vconf.h>
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-screen.h"
+#include "popup-x.h"
+#include "popup-trace.h"
+#include "popup-emerg.h"
+#include "popup-pool.h"
+#include "popup-memprof.h"
+#include "popup-font.h"
+#include "poweroff-sleep.h"
+#include "popup-timeline.h"
 
 int create_and_show_basic_popup_min(struct appdata *ad);
+int poweroff_start(void *data);
 void poweroff_response_yes_cb_min(void *data, Evas_Object * obj, void *event_info);
 void poweroff_response_no_cb_min(void *data, Evas_Object * obj, void *event_info);
+void poweroff_response_sleep_cb_min(void *data, Evas_Object * obj, void *event_info);
 
+static Ecore_Event_Handler *key_handler = NULL;
+
+/* Drawn straight to the framebuffer if the window never shows */
+#define EMERG_MSG_POWER_OFF	"POWER OFF\nPLEASE WAIT"
 
 int myterm(bundle *b, void *data)
 {
@@ -103,15 +122,18 @@ static Evas_Object *create_win(const char *name)
 	Evas_Object *eo;
 	int w, h;
 
-	eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC);
+	POPUP_X("elm_win_add", eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC));
 	if (eo) {
 		elm_win_title_set(eo, name);
 		elm_win_borderless_set(eo, EINA_TRUE);
 		evas_object_smart_callback_add(eo, "delete,request", win_del, NULL);
 		elm_win_alpha_set(eo, EINA_TRUE);
-		ecore_x_window_size_get(ecore_x_window_root_first_get(), &w,
-					&h);
+		/* Cached geometry, no round trip on a warm start */
+		popup_screen_get(&w, &h, NULL);
 		evas_object_resize(eo, w, h);
+
+		/* Queued ahead of the map request */
+		popup_x_prepare(eo, 1);
 	}
 
 	return eo;
@@ -170,31 +192,33 @@ static int app_resume(void *data)
 static int app_reset(bundle *b, void *data)
 {
 	struct appdata *ad = data;
+	uint64_t start;
+
+	popup_stats_inc(POPUP_STAT_LAUNCH);
+	popup_trace_request(b, ad->win_main);
+	start = popup_trace_begin();
 
 	if (syspopup_has_popup(b)) {
 		syspopup_reset(b);
+
+		/* Show the lingering window again */
+		if (popup_linger_reuse()) {
+			evas_object_show(ad->win_main);
+			poweroff_start((void *)ad);
+		}
 	} else {
-		syspopup_create(b, &handler, ad->win_main, ad);
-		evas_object_show(ad->win_main);
+		POPUP_X("syspopup_create",
+			syspopup_create(b, &handler, ad->win_main, ad));
+		POPUP_X("win_show", evas_object_show(ad->win_main));
 
 		/* Start Main UI */
 		poweroff_start((void *)ad);
 	}
 
+	popup_trace_end("app_reset", start);
 	return 0;
 }
 
-/* Customized print */
-void system_print(const char *format, ...)
-{
-	/* Un-comment return to disable logs */
-
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-}
-
 /* Cleanup objects to avoid mem-leak */
 void poweroff_cleanup(struct appdata *ad)
 {
@@ -202,6 +226,25 @@ void poweroff_cleanup(struct appdata *ad)
 		evas_object_del(ad->popup);
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
+	ad->popup = NULL;
+	ad->layout_main = NULL;
+}
+
+static void poweroff_release(void *data)
+{
+	struct appdata *ad = data;
+
+	popup_emerg_disarm();
+	poweroff_sleep_cancel();
+	if (key_handler) {
+		ecore_event_handler_del(key_handler);
+		key_handler = NULL;
+	}
+	if (ad->popup_poweroff) {
+		popup_pool_put(ad->popup_poweroff);
+		ad->popup_poweroff = NULL;
+	}
+	poweroff_cleanup(ad);
 }
 
 /* Background clicked noti */
@@ -214,69 +257,111 @@ static void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_i
 
 void poweroff_response_yes_cb_min(void *data, Evas_Object * obj, void *event_info)
 {
+	struct appdata *ad = data;
+
 	system_print("System-popup : Switching off phone !! Bye Bye \n");
+	popup_stats_inc(POPUP_STAT_CHOICE_OK);
+
+	/* The device goes down now, make sure the user sees why */
+	popup_emerg_arm(ad->win_main, EMERG_MSG_POWER_OFF, POPUP_EMERG_BUDGET_MS);
+
+	/* Each stage is on disk before the next one starts */
+	popup_timeline_begin();
+	popup_timeline_mark("press");
 
 	/* This will cleanup the memory */
 	poweroff_cleanup(data);
+	popup_timeline_mark("cleanup");
 
 	/* Sysman API to poweroff */
+	popup_timeline_mark("request");
 	if (sysman_call_predef_action(PREDEF_POWEROFF, 0) == -1) {
 		system_print("System-popup : failed to request poweroff to system_server \n");
+		popup_stats_inc(POPUP_STAT_POWEROFF_FALLBACK);
+		popup_timeline_mark("fallback");
 		system("poweroff");
 	}
+	popup_timeline_mark("requested");
+
+	sync();
+	popup_timeline_mark("sync");
+	popup_timeline_end();
 	exit(0);
 }
 
 void poweroff_response_no_cb_min(void *data, Evas_Object * obj, void *event_info)
 {
+	struct appdata *ad = data;
+
 	system_print("\nSystem-popup: Option is Wrong");
-	if(data != NULL)
-		poweroff_cleanup(data);
-	exit(0);
+	/* The key handler passes no object */
+	popup_stats_inc(obj ? POPUP_STAT_CHOICE_CANCEL : POPUP_STAT_DISMISS);
+	popup_linger_dismiss(ad->win_main, poweroff_release, ad);
 }
 
-int create_and_show_basic_popup_min(struct appdata *ad)
+/* Back from suspend, the popup has done its job */
+static void poweroff_sleep_done(const struct poweroff_sleep_timing *t, void *data)
 {
-	Evas_Object *btn1;
-	Evas_Object *btn2;
+	struct appdata *ad = data;
 
-	ad->popup_poweroff = elm_popup_add(ad->win_main);
+	popup_linger_dismiss(ad->win_main, poweroff_release, ad);
+}
+
+void poweroff_response_sleep_cb_min(void *data, Evas_Object * obj, void *event_info)
+{
+	struct appdata *ad = data;
+
+	system_print("System-popup : Entering sleep \n");
+	popup_stats_inc(POPUP_STAT_CHOICE_SLEEP);
+
+	/* Nothing should be drawn while the devices suspend, and the wake key
+	 * must not count as a cancel */
+	if (key_handler) {
+		ecore_event_handler_del(key_handler);
+		key_handler = NULL;
+	}
+	evas_object_hide(ad->win_main);
+	if (poweroff_sleep_enter(poweroff_sleep_done, ad) < 0) {
+		system_print("System-popup : failed to request sleep \n");
+		popup_linger_dismiss(ad->win_main, poweroff_release, ad);
+	}
+}
+
+static Eina_Bool poweroff_key_up_cb(void *data, int type, void *event)
+{
+	poweroff_response_no_cb_min(data, NULL, NULL);
+	return ECORE_CALLBACK_DONE;
+}
+
+int create_and_show_basic_popup_min(struct appdata *ad)
+{
+	ad->popup_poweroff = popup_pool_get(ad->win_main, 3);
 	if (ad->popup_poweroff == NULL) {
 		system_print("\n System-popup : Add popup failed \n");
 		return -1;
 	}
 
-	evas_object_size_hint_weight_set(ad->popup_poweroff, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
 	elm_object_text_set(ad->popup_poweroff, _("IDS_ST_BODY_POWER_OFF"));
 	elm_object_part_text_set(ad->popup_poweroff, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
 
-	btn1 = elm_button_add(ad->popup_poweroff);
-	elm_object_text_set(btn1, _("IDS_COM_SK_OK"));
-	elm_object_part_content_set(ad->popup_poweroff, "button1", btn1);
-	elm_object_style_set (btn1,"popup_button/default");
-	evas_object_smart_callback_add(btn1, "clicked", poweroff_response_yes_cb_min, ad);
-	btn2 = elm_button_add(ad->popup_poweroff);
-	elm_object_text_set(btn2, _("IDS_COM_SK_CANCEL"));
-	elm_object_part_content_set(ad->popup_poweroff, "button2", btn2);
-	elm_object_style_set (btn2,"popup_button/default");
-	evas_object_smart_callback_add(btn2, "clicked", poweroff_response_no_cb_min, ad);
-
-	Ecore_X_Window xwin;
-	xwin = elm_win_xwindow_get(ad->popup_poweroff);
-	ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION);
-	utilx_grab_key(ecore_x_display_get(), xwin, KEY_SELECT, SHARED_GRAB);
-	ecore_event_handler_add(ECORE_EVENT_KEY_UP, poweroff_response_no_cb_min, NULL);
+	popup_pool_button_set(ad->popup_poweroff, 0, _("IDS_COM_SK_OK"),
+			      poweroff_response_yes_cb_min, ad);
+	popup_pool_button_set(ad->popup_poweroff, 1, _("IDS_ST_BODY_SLEEP"),
+			      poweroff_response_sleep_cb_min, ad);
+	popup_pool_button_set(ad->popup_poweroff, 2, _("IDS_COM_SK_CANCEL"),
+			      poweroff_response_no_cb_min, ad);
+
+	key_handler = ecore_event_handler_add(ECORE_EVENT_KEY_UP,
+					      poweroff_key_up_cb, ad);
 	evas_object_show(ad->popup_poweroff);
+	popup_linger_shown();
+	popup_stats_inc(POPUP_STAT_SHOW);
+	popup_x_report();
 	
 	return 0;
 	
 }
 
-static void bg_noti_cb(void *data)
-{
-	ui_bgimg_reload((Evas_Object *) data);
-}
-
 /* Create indicator bar */
 static int poweroff_create_indicator(struct appdata *ad)
 {
@@ -295,14 +380,18 @@ static int poweroff_play_vibration()
 
 	/* Open the haptic device */
 	dev_handle = device_haptic_open(DEV_IDX_0, mode);
-	if (dev_handle < 0)
+	if (dev_handle < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	/* Play a monotone pattern for 1s */
 	ret_val = device_haptic_play_monotone(dev_handle, 1000);
 	device_haptic_close(dev_handle);
-	if (ret_val < 0)
+	if (ret_val < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	return 0;
 
@@ -315,17 +404,21 @@ int poweroff_start(void *data)
 	int ret_val = 0;
 
 	/* Create and show popup */
-	ret_val = create_and_show_basic_popup_min(ad);
+	POPUP_TRACE("popup_create",
+		    ret_val = create_and_show_basic_popup_min(ad));
 	if (ret_val != 0)
 		return -1;
+	popup_memprof_phase("popup_build");
 
 	/* Change LCD brightness */
-	ret_val = pm_change_state(LCD_NORMAL);
-	if (ret_val != 0)
+	POPUP_TRACE("pm_change_state", ret_val = pm_change_state(LCD_NORMAL));
+	if (ret_val != 0) {
+		popup_stats_inc(POPUP_STAT_PM_FAIL);
 		return -1;
+	}
 
 	/* Play a vibration for 1 sec */
-	ret_val = poweroff_play_vibration();
+	POPUP_TRACE("haptic_play", ret_val = poweroff_play_vibration());
 	if (ret_val == -1)
 		system_print("\n Poweroff : Play vibration Failed \n");
 
@@ -339,14 +432,20 @@ int app_create(void *data)
 	Evas_Object *win;
 	struct appdata *ad = data;
 
+	popup_memprof_phase("efl_init");
+
 	/* Create window (Reqd for sys-popup) */
 	win = create_win(PACKAGE);
 	if (win == NULL)
 		return -1;
 
 	ad->win_main = win;
+	popup_memprof_phase("create_win");
+	popup_memprof_watch(win);
 
 	elm_theme_overlay_add(NULL,EDJ_NAME); 
+	popup_memprof_phase("theme");
+	POPUP_TRACE("font_apply", popup_font_apply());
 
 	return 0;
 }
@@ -364,6 +463,12 @@ int main(int argc, char *argv[])
 		.reset = app_reset,
 	};
 
+	popup_log_init(PACKAGE);
+	popup_trace_init(PACKAGE);
+	popup_memprof_init(PACKAGE);
+	popup_linger_init(PACKAGE);
+	popup_stats_init(POPUP_TYPE_POWEROFF);
+
 	memset(&ad, 0x0, sizeof(struct appdata));
 	ops.data = &ad;
 
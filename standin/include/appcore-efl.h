@@ -0,0 +1,45 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_appcore_efl_H_
+#define __DEF_standin_appcore_efl_H_
+
+#include <libintl.h>
+#include <bundle.h>
+
+#ifndef _
+#define _(str)	gettext(str)
+#endif
+#ifndef N_
+#define N_(str)	(str)
+#endif
+
+struct appcore_ops {
+	void *data;
+	int (*create)(void *);
+	int (*terminate)(void *);
+	int (*pause)(void *);
+	int (*resume)(void *);
+	int (*reset)(bundle *, void *);
+};
+
+int appcore_efl_main(const char *name, int *argc, char ***argv,
+		     struct appcore_ops *ops);
+
+#endif				/* __DEF_standin_appcore_efl_H__ */
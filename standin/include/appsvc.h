@@ -0,0 +1,42 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_appsvc_H_
+#define __DEF_standin_appsvc_H_
+
+#include <bundle.h>
+
+#define APPSVC_OPERATION_VIEW	"http://tizen.org/appsvc/operation/view"
+
+typedef enum {
+	APPSVC_RES_OK = 0,
+	APPSVC_RES_NOT_OK = -1,
+	APPSVC_RES_CANCEL = -2,
+} appsvc_result_val;
+
+typedef void (*appsvc_res_fn)(bundle *b, int request_code,
+			      appsvc_result_val result, void *data);
+
+int appsvc_set_operation(bundle *b, const char *operation);
+int appsvc_set_pkgname(bundle *b, const char *pkg_name);
+int appsvc_add_data(bundle *b, const char *key, const char *val);
+int appsvc_run_service(bundle *b, int request_code, appsvc_res_fn cbfunc,
+		       void *data);
+
+#endif				/* __DEF_standin_appsvc_H__ */
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_bundle_H_
+#define __DEF_standin_bundle_H_
+
+typedef struct _bundle_t bundle;
+
+bundle *bundle_create(void);
+int bundle_free(bundle *b);
+int bundle_add(bundle *b, const char *key, const char *val);
+int bundle_del(bundle *b, const char *key);
+const char *bundle_get_val(bundle *b, const char *key);
+int bundle_get_count(bundle *b);
+
+#endif				/* __DEF_standin_bundle_H__ */
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_devman_haptic_H_
+#define __DEF_standin_devman_haptic_H_
+
+typedef enum {
+	DEV_IDX_0 = 0x01,
+	DEV_IDX_1 = 0x02,
+	DEV_IDX_ALL = 0x04,
+} haptic_dev_idx;
+
+int device_haptic_open(haptic_dev_idx dev_idx, unsigned int mode);
+int device_haptic_play_monotone(int device_handle, int duration);
+int device_haptic_close(int device_handle);
+
+#endif				/* __DEF_standin_devman_haptic_H__ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_notification_H_
+#define __DEF_standin_notification_H_
+
+#include <bundle.h>
+
+typedef struct _notification *notification_h;
+
+typedef enum {
+	NOTIFICATION_ERROR_NONE = 0,
+	NOTIFICATION_ERROR_INVALID_DATA = -1,
+	NOTIFICATION_ERROR_NO_MEMORY = -2,
+	NOTIFICATION_ERROR_NOT_EXIST_ID = -7,
+} notification_error_e;
+
+typedef enum {
+	NOTIFICATION_TYPE_NONE = -1,
+	NOTIFICATION_TYPE_NOTI = 0,
+	NOTIFICATION_TYPE_ONGOING,
+	NOTIFICATION_TYPE_MAX,
+} notification_type_e;
+
+typedef enum {
+	NOTIFICATION_TEXT_TYPE_NONE = -1,
+	NOTIFICATION_TEXT_TYPE_TITLE = 0,
+	NOTIFICATION_TEXT_TYPE_CONTENT,
+	NOTIFICATION_TEXT_TYPE_CONTENT_FOR_DISPLAY_OPTION_IS_OFF,
+	NOTIFICATION_TEXT_TYPE_MAX,
+} notification_text_type_e;
+
+typedef enum {
+	NOTIFICATION_IMAGE_TYPE_NONE = -1,
+	NOTIFICATION_IMAGE_TYPE_ICON = 0,
+	NOTIFICATION_IMAGE_TYPE_MAX,
+} notification_image_type_e;
+
+typedef enum {
+	NOTIFICATION_EXECUTE_TYPE_NONE = -1,
+	NOTIFICATION_EXECUTE_TYPE_RESPONDING = 0,
+	NOTIFICATION_EXECUTE_TYPE_SINGLE_LAUNCH,
+	NOTIFICATION_EXECUTE_TYPE_MULTI_LAUNCH,
+} notification_execute_type_e;
+
+#define NOTIFICATION_GROUP_ID_NONE	0
+#define NOTIFICATION_PRIV_ID_NONE	0
+#define NOTIFICATION_VARIABLE_TYPE_NONE	-1
+
+#define NOTIFICATION_PROP_DISPLAY_ONLY_SIMMODE	0x00000001
+#define NOTIFICATION_PROP_DISABLE_APP_LAUNCH	0x00000002
+#define NOTIFICATION_PROP_DISABLE_AUTO_DELETE	0x00000004
+#define NOTIFICATION_PROP_DISABLE_TICKERNOTI	0x00000008
+#define NOTIFICATION_PROP_VOLATILE_DISPLAY	0x00000100
+
+#define NOTIFICATION_DISPLAY_APP_NOTIFICATION_TRAY	0x00000001
+#define NOTIFICATION_DISPLAY_APP_TICKER		0x00000002
+
+notification_h notification_new(notification_type_e type, int group_id,
+				int priv_id);
+notification_error_e notification_free(notification_h noti);
+notification_error_e notification_set_text(notification_h noti,
+					   notification_text_type_e type,
+					   const char *text, const char *key,
+					   int args_type, ...);
+notification_error_e notification_set_image(notification_h noti,
+					    notification_image_type_e type,
+					    const char *path);
+notification_error_e notification_set_property(notification_h noti,
+					       int flags);
+notification_error_e notification_set_display_applist(notification_h noti,
+						       int applist);
+notification_error_e notification_set_execute_option(notification_h noti,
+						     notification_execute_type_e type,
+						     const char *text,
+						     const char *key,
+						     bundle *service_handle);
+notification_error_e notification_insert(notification_h noti, int *priv_id);
+notification_error_e notification_delete_all_by_type(const char *pkgname,
+						     notification_type_e type);
+notification_error_e notification_delete_by_priv_id(const char *pkgname,
+						    notification_type_e type,
+						    int priv_id);
+
+#endif				/* __DEF_standin_notification_H__ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Stand-in platform layer.
+ *
+ * Built with -DPOPUP_STANDIN=ON the popups link against the headers in
+ * this directory and libsyspopup-standin instead of the Tizen platform
+ * libraries, so they run on a plain Linux desktop with EFL and an X
+ * server (Xvfb is enough). Every stand-in call is written to the call
+ * log as
+ *
+ *	<usec> <app> <function>(<args>) = <ret>
+ *
+ * The launch bundle is taken from argv as key=value words, later
+ * requests come in over the control FIFO one line each:
+ *
+ *	reset key=value ...	another launch, reaches app_reset()
+ *	vconf key=value		set a key and run its change callbacks
+ *	term, timeout		the syspopup handler callbacks
+ *	pause, resume, quit
+ *
+ * Values are percent-decoded, so "USB%20disk" is "USB disk". A request
+ * carrying STANDIN_SEQ_KEY is logged with that number, and so is the
+ * first frame rendered after it, which is what popup-replay measures.
+ */
+
+#ifndef __DEF_standin_H_
+#define __DEF_standin_H_
+
+#include <stdint.h>
+
+/* Call log path, stderr when unset */
+#define STANDIN_LOG_ENV		"STANDIN_LOG"
+/* Fixed log timestamp step per call in usec, real time when unset.
+ * Timers in the popups keep the real clock. */
+#define STANDIN_CLOCK_ENV	"STANDIN_CLOCK_STEP_US"
+/* Control FIFO, created when missing */
+#define STANDIN_CTL_ENV		"STANDIN_CTL"
+/* key=value lines loaded into the vconf store at start */
+#define STANDIN_VCONF_ENV	"STANDIN_VCONF"
+
+#define STANDIN_LINE_MAX	1024
+
+/* Request number set by the driver */
+#define STANDIN_SEQ_KEY		"_STANDIN_SEQ_"
+
+uint64_t standin_now_us(void);
+void standin_set_app(const char *name);
+void standin_call(const char *fn, int ret, const char *fmt, ...)
+	__attribute__ ((format(printf, 3, 4)));
+int standin_decode(char *s);
+
+/* Control channel, driven from the appcore main loop */
+int standin_vconf_apply(const char *pair);
+int standin_syspopup_event(int timeout);
+void standin_frame_expect(int seq);
+
+#endif				/* __DEF_standin_H__ */
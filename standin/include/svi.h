@@ -0,0 +1,40 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_svi_H_
+#define __DEF_standin_svi_H_
+
+#define SVI_SUCCESS	0
+#define SVI_ERROR	-1
+
+typedef enum {
+	SVI_VIB_NONE = -1,
+	SVI_VIB_OPERATION_LOWBATT = 21,
+} svi_vib_type;
+
+typedef enum {
+	SVI_SND_NONE = -1,
+	SVI_SND_OPERATION_LOWBATT = 11,
+} svi_snd_type;
+
+int svi_init(int *handle);
+int svi_play(int handle, svi_vib_type vibration_key, svi_snd_type sound_key);
+int svi_fini(int handle);
+
+#endif				/* __DEF_standin_svi_H__ */
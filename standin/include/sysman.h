@@ -0,0 +1,33 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_sysman_H_
+#define __DEF_standin_sysman_H_
+
+#define PREDEF_POWEROFF		"poweroff"
+
+enum mp_entry_type {
+	OOM_LIKELY,
+	OOM_IGNORE,
+};
+
+int sysman_call_predef_action(const char *type, int num, ...);
+int sysconf_set_mempolicy(enum mp_entry_type mp);
+
+#endif				/* __DEF_standin_sysman_H__ */
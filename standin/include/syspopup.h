@@ -0,0 +1,36 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_syspopup_H_
+#define __DEF_standin_syspopup_H_
+
+#include <Elementary.h>
+#include <bundle.h>
+
+typedef struct {
+	int (*def_term_fn)(bundle *, void *);
+	int (*def_timeout_fn)(bundle *, void *);
+} syspopup_handler;
+
+int syspopup_create(bundle *b, syspopup_handler *handler,
+		    Evas_Object *parent, void *user_data);
+int syspopup_has_popup(bundle *b);
+int syspopup_reset(bundle *b);
+
+#endif				/* __DEF_standin_syspopup_H__ */
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_utilX_H_
+#define __DEF_standin_utilX_H_
+
+#include <X11/Xlib.h>
+
+#define KEY_SELECT	"XF86Phone"
+
+#define EXCLUSIVE_GRAB		0x0
+#define OR_EXCLUSIVE_GRAB	0x1
+#define TOP_POSITION_GRAB	0x2
+#define SHARED_GRAB		0x3
+
+int utilx_grab_key(Display *dpy, Window win, const char *key_name,
+		   int grab_mode);
+
+#endif				/* __DEF_standin_utilX_H__ */
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_vconf_keys_H_
+#define __DEF_standin_vconf_keys_H_
+
+#define VCONFKEY_TESTMODE_LOW_BATT_POPUP	"db/testmode/low_batt_popup"
+#define VCONFKEY_SETAPPL_SOUND_STATUS_BOOL	"db/setting/sound/sound_on"
+#define VCONFKEY_SETAPPL_VIBRATION_STATUS_BOOL	"db/setting/sound/vibration_on"
+
+#endif				/* __DEF_standin_vconf_keys_H__ */
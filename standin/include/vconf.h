@@ -0,0 +1,53 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+#ifndef __DEF_standin_vconf_H_
+#define __DEF_standin_vconf_H_
+
+#include <vconf-keys.h>
+
+enum {
+	VCONF_TYPE_NONE = 0,
+	VCONF_TYPE_STRING = 40,
+	VCONF_TYPE_INT = 41,
+	VCONF_TYPE_DOUBLE = 42,
+	VCONF_TYPE_BOOL = 43,
+};
+
+typedef struct _keynode_t keynode_t;
+typedef void (*vconf_callback_fn)(keynode_t *node, void *user_data);
+
+int vconf_get_int(const char *key, int *val);
+int vconf_get_bool(const char *key, int *val);
+char *vconf_get_str(const char *key);
+int vconf_set_int(const char *key, int val);
+int vconf_set_bool(const char *key, int val);
+int vconf_set_str(const char *key, const char *val);
+
+int vconf_notify_key_changed(const char *key, vconf_callback_fn cb,
+			     void *user_data);
+int vconf_ignore_key_changed(const char *key, vconf_callback_fn cb);
+
+const char *vconf_keynode_get_name(keynode_t *node);
+int vconf_keynode_get_type(keynode_t *node);
+int vconf_keynode_get_int(keynode_t *node);
+int vconf_keynode_get_bool(keynode_t *node);
+char *vconf_keynode_get_str(keynode_t *node);
+
+#endif				/* __DEF_standin_vconf_H__ */
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * appcore-efl main loop. The first request comes from argv, later ones
+ * from the control FIFO, so the popup goes through app_reset() the way
+ * it does when the platform relaunches a running popup.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <Elementary.h>
+#include <appcore-efl.h>
+#include "standin.h"
+
+static struct appcore_ops *app_ops;
+static Ecore_Fd_Handler *ctl_handler;
+static int ctl_fd = -1;
+static int ctl_wfd = -1;
+static char ctl_buf[STANDIN_LINE_MAX];
+static int ctl_len;
+
+/* key=value, both sides percent-encoded */
+static int add_pair(bundle *b, const char *word)
+{
+	char *copy, *eq;
+	int ret = -1;
+
+	copy = strdup(word);
+	if (copy == NULL)
+		return -1;
+	eq = strchr(copy, '=');
+	if (eq && eq != copy) {
+		*eq = '\0';
+		standin_decode(copy);
+		standin_decode(eq + 1);
+		ret = bundle_add(b, copy, eq + 1);
+	}
+	free(copy);
+	return ret;
+}
+
+/* Keep the encoded pairs, minus the sequence number */
+static void add_words(char *words, const char *arg)
+{
+	size_t len = strlen(words);
+
+	if (!strncmp(arg, STANDIN_SEQ_KEY "=", sizeof(STANDIN_SEQ_KEY)))
+		return;
+	snprintf(words + len, STANDIN_LINE_MAX - len, "%s%s",
+		 len ? " " : "", arg);
+}
+
+static void deliver(bundle *b, const char *words)
+{
+	const char *seq;
+	int ret = 0;
+
+	seq = bundle_get_val(b, STANDIN_SEQ_KEY);
+	if (seq)
+		standin_frame_expect(atoi(seq));
+
+	if (app_ops->reset)
+		ret = app_ops->reset(b, app_ops->data);
+	/* The pairs as sent, so a log can be replayed */
+	standin_call("app_reset", ret, "seq=%s, %s", seq ? seq : "0",
+		     words ? words : "");
+}
+
+static void command(char *line)
+{
+	char words[STANDIN_LINE_MAX];
+	char *cmd, *arg, *save = NULL;
+	bundle *b;
+	int ret;
+
+	cmd = strtok_r(line, " \t", &save);
+	if (cmd == NULL)
+		return;
+
+	if (!strcmp(cmd, "reset")) {
+		b = bundle_create();
+		if (b == NULL)
+			return;
+		words[0] = '\0';
+		while ((arg = strtok_r(NULL, " \t", &save))) {
+			add_words(words, arg);
+			add_pair(b, arg);
+		}
+		deliver(b, words);
+		bundle_free(b);
+	} else if (!strcmp(cmd, "vconf")) {
+		while ((arg = strtok_r(NULL, " \t", &save))) {
+			standin_decode(arg);
+			standin_vconf_apply(arg);
+		}
+	} else if (!strcmp(cmd, "term") || !strcmp(cmd, "timeout")) {
+		standin_syspopup_event(cmd[1] == 'i');
+	} else if (!strcmp(cmd, "pause") || !strcmp(cmd, "resume")) {
+		ret = 0;
+		if (cmd[0] == 'p' && app_ops->pause)
+			ret = app_ops->pause(app_ops->data);
+		else if (cmd[0] == 'r' && app_ops->resume)
+			ret = app_ops->resume(app_ops->data);
+		standin_call(cmd[0] == 'p' ? "app_pause" : "app_resume", ret,
+			     "%s", "");
+	} else if (!strcmp(cmd, "quit")) {
+		elm_exit();
+	} else {
+		standin_call("control", -1, "\"%s\"", cmd);
+	}
+}
+
+static Eina_Bool ctl_read(void *data, Ecore_Fd_Handler *fd_handler)
+{
+	char *nl, *line;
+	ssize_t n;
+
+	n = read(ctl_fd, ctl_buf + ctl_len, sizeof(ctl_buf) - 1 - ctl_len);
+	if (n <= 0)
+		return ECORE_CALLBACK_RENEW;
+	ctl_len += n;
+	ctl_buf[ctl_len] = '\0';
+
+	line = ctl_buf;
+	while ((nl = strchr(line, '\n'))) {
+		*nl = '\0';
+		command(line);
+		line = nl + 1;
+	}
+
+	ctl_len -= line - ctl_buf;
+	if (ctl_len >= (int)sizeof(ctl_buf) - 1)
+		ctl_len = 0;	/* no newline in a full buffer, drop it */
+	memmove(ctl_buf, line, ctl_len);
+	return ECORE_CALLBACK_RENEW;
+}
+
+static void ctl_open(void)
+{
+	const char *path;
+
+	path = getenv(STANDIN_CTL_ENV);
+	if (path == NULL || path[0] == '\0')
+		return;
+
+	if (mkfifo(path, 0600) < 0 && errno != EEXIST) {
+		standin_call("control", -1, "\"%s\"", path);
+		return;
+	}
+
+	ctl_fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (ctl_fd < 0)
+		return;
+	/* Keep a writer so the FIFO never reads EOF between clients */
+	ctl_wfd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+	ctl_handler = ecore_main_fd_handler_add(ctl_fd, ECORE_FD_READ, ctl_read,
+						NULL, NULL, NULL);
+	standin_call("control", ctl_handler ? 0 : -1, "\"%s\"", path);
+}
+
+static void ctl_close(void)
+{
+	if (ctl_handler)
+		ecore_main_fd_handler_del(ctl_handler);
+	ctl_handler = NULL;
+	if (ctl_fd >= 0)
+		close(ctl_fd);
+	if (ctl_wfd >= 0)
+		close(ctl_wfd);
+	ctl_fd = ctl_wfd = -1;
+}
+
+int appcore_efl_main(const char *name, int *argc, char ***argv,
+		     struct appcore_ops *ops)
+{
+	char words[STANDIN_LINE_MAX];
+	bundle *b;
+	int i, ret = 0;
+
+	if (ops == NULL)
+		return -1;
+
+	standin_set_app(name);
+	elm_init(*argc, *argv);
+	app_ops = ops;
+
+	if (ops->create)
+		ret = ops->create(ops->data);
+	standin_call("app_create", ret, "\"%s\"", name ? name : "");
+	if (ret < 0) {
+		elm_shutdown();
+		return -1;
+	}
+
+	ctl_open();
+
+	b = bundle_create();
+	if (b) {
+		words[0] = '\0';
+		for (i = 1; i < *argc; i++) {
+			add_words(words, (*argv)[i]);
+			add_pair(b, (*argv)[i]);
+		}
+		deliver(b, words);
+		bundle_free(b);
+	}
+
+	elm_run();
+
+	ret = ops->terminate ? ops->terminate(ops->data) : 0;
+	standin_call("app_terminate", ret, "%s", "");
+	ctl_close();
+	elm_shutdown();
+	return 0;
+}
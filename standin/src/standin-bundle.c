@@ -0,0 +1,127 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/* Key/value bundle, a short list is all a launch request carries */
+
+#include <stdlib.h>
+#include <string.h>
+#include <bundle.h>
+
+struct entry {
+	char *key;
+	char *val;
+	struct entry *next;
+};
+
+struct _bundle_t {
+	struct entry *head;
+	int count;
+};
+
+bundle *bundle_create(void)
+{
+	return calloc(1, sizeof(bundle));
+}
+
+int bundle_free(bundle *b)
+{
+	struct entry *e, *next;
+
+	if (b == NULL)
+		return -1;
+	for (e = b->head; e; e = next) {
+		next = e->next;
+		free(e->key);
+		free(e->val);
+		free(e);
+	}
+	free(b);
+	return 0;
+}
+
+static struct entry *find(bundle *b, const char *key)
+{
+	struct entry *e;
+
+	for (e = b->head; e; e = e->next)
+		if (!strcmp(e->key, key))
+			return e;
+	return NULL;
+}
+
+/* Like the platform bundle, an existing key is not replaced */
+int bundle_add(bundle *b, const char *key, const char *val)
+{
+	struct entry *e, **tail;
+
+	if (b == NULL || key == NULL || val == NULL || find(b, key))
+		return -1;
+
+	e = calloc(1, sizeof(*e));
+	if (e == NULL)
+		return -1;
+	e->key = strdup(key);
+	e->val = strdup(val);
+	if (e->key == NULL || e->val == NULL) {
+		free(e->key);
+		free(e->val);
+		free(e);
+		return -1;
+	}
+
+	for (tail = &b->head; *tail; tail = &(*tail)->next)
+		;
+	*tail = e;
+	b->count++;
+	return 0;
+}
+
+int bundle_del(bundle *b, const char *key)
+{
+	struct entry **p, *e;
+
+	if (b == NULL || key == NULL)
+		return -1;
+	for (p = &b->head; (e = *p); p = &e->next) {
+		if (strcmp(e->key, key))
+			continue;
+		*p = e->next;
+		free(e->key);
+		free(e->val);
+		free(e);
+		b->count--;
+		return 0;
+	}
+	return -1;
+}
+
+const char *bundle_get_val(bundle *b, const char *key)
+{
+	struct entry *e;
+
+	if (b == NULL || key == NULL)
+		return NULL;
+	e = find(b, key);
+	return e ? e->val : NULL;
+}
+
+int bundle_get_count(bundle *b)
+{
+	return b ? b->count : 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Device side stand-ins: power manager, sysman, haptic, sound and key
+ * grabs only log the request and report success. Nothing here touches
+ * the host, a power off request in particular does not power it off.
+ */
+
+#include <stdarg.h>
+#include <sysman.h>
+#include <pmapi.h>
+#include <devman_haptic.h>
+#include <svi.h>
+#include <mmf/mm_sound.h>
+#include <utilX.h>
+#include "standin.h"
+
+#define HAPTIC_HANDLE	1
+#define SVI_HANDLE	1
+
+int sysman_call_predef_action(const char *type, int num, ...)
+{
+	standin_call(__func__, 0, "\"%s\", %d", type ? type : "", num);
+	return 0;
+}
+
+int sysconf_set_mempolicy(enum mp_entry_type mp)
+{
+	standin_call(__func__, 0, "%d", mp);
+	return 0;
+}
+
+int pm_change_state(unsigned int state)
+{
+	standin_call(__func__, 0, "0x%x", state);
+	return 0;
+}
+
+int device_haptic_open(haptic_dev_idx dev_idx, unsigned int mode)
+{
+	standin_call(__func__, HAPTIC_HANDLE, "%d, %u", dev_idx, mode);
+	return HAPTIC_HANDLE;
+}
+
+int device_haptic_play_monotone(int device_handle, int duration)
+{
+	int ret = device_handle == HAPTIC_HANDLE ? 0 : -1;
+
+	standin_call(__func__, ret, "%d, %d", device_handle, duration);
+	return ret;
+}
+
+int device_haptic_close(int device_handle)
+{
+	int ret = device_handle == HAPTIC_HANDLE ? 0 : -1;
+
+	standin_call(__func__, ret, "%d", device_handle);
+	return ret;
+}
+
+int svi_init(int *handle)
+{
+	if (handle == NULL) {
+		standin_call(__func__, SVI_ERROR, "%s", "NULL");
+		return SVI_ERROR;
+	}
+	*handle = SVI_HANDLE;
+	standin_call(__func__, SVI_SUCCESS, "%d", *handle);
+	return SVI_SUCCESS;
+}
+
+int svi_play(int handle, svi_vib_type vibration_key, svi_snd_type sound_key)
+{
+	int ret = handle == SVI_HANDLE ? SVI_SUCCESS : SVI_ERROR;
+
+	standin_call(__func__, ret, "%d, %d, %d", handle, vibration_key,
+		     sound_key);
+	return ret;
+}
+
+int svi_fini(int handle)
+{
+	int ret = handle == SVI_HANDLE ? SVI_SUCCESS : SVI_ERROR;
+
+	standin_call(__func__, ret, "%d", handle);
+	return ret;
+}
+
+int mm_sound_play_keysound(const char *filename, int volume_config)
+{
+	standin_call(__func__, 0, "\"%s\", %d", filename ? filename : "",
+		     volume_config);
+	return 0;
+}
+
+int utilx_grab_key(Display *dpy, Window win, const char *key_name,
+		   int grab_mode)
+{
+	standin_call(__func__, 0, "0x%lx, \"%s\", %d", (unsigned long)win,
+		     key_name ? key_name : "", grab_mode);
+	return 0;
+}
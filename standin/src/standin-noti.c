@@ -0,0 +1,194 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Notification table kept in the process. Inserts and deletes are
+ * logged with the row count after the operation, which is what a
+ * replay run looks at for churn and leaks.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <notification.h>
+#include "standin.h"
+
+#define TEXT_MAX	128
+
+struct _notification {
+	notification_type_e type;
+	int priv_id;
+	int property;
+	int applist;
+	int has_exec;
+	char text[NOTIFICATION_TEXT_TYPE_MAX][TEXT_MAX];
+	char image[TEXT_MAX];
+	struct _notification *next;
+};
+
+static struct _notification *table;
+static int rows;
+static int next_id = 1;
+
+notification_h notification_new(notification_type_e type, int group_id,
+				int priv_id)
+{
+	notification_h noti;
+
+	if (type <= NOTIFICATION_TYPE_NONE || type >= NOTIFICATION_TYPE_MAX)
+		return NULL;
+	noti = calloc(1, sizeof(*noti));
+	if (noti == NULL)
+		return NULL;
+	noti->type = type;
+	noti->priv_id = priv_id;
+	return noti;
+}
+
+notification_error_e notification_free(notification_h noti)
+{
+	if (noti == NULL)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	free(noti);
+	return NOTIFICATION_ERROR_NONE;
+}
+
+/* Only the plain text is kept, no %d style arguments are used */
+notification_error_e notification_set_text(notification_h noti,
+					   notification_text_type_e type,
+					   const char *text, const char *key,
+					   int args_type, ...)
+{
+	if (noti == NULL || type <= NOTIFICATION_TEXT_TYPE_NONE ||
+	    type >= NOTIFICATION_TEXT_TYPE_MAX)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	strncpy(noti->text[type], text ? text : "", TEXT_MAX - 1);
+	return NOTIFICATION_ERROR_NONE;
+}
+
+notification_error_e notification_set_image(notification_h noti,
+					    notification_image_type_e type,
+					    const char *path)
+{
+	if (noti == NULL || type != NOTIFICATION_IMAGE_TYPE_ICON)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	strncpy(noti->image, path ? path : "", TEXT_MAX - 1);
+	return NOTIFICATION_ERROR_NONE;
+}
+
+notification_error_e notification_set_property(notification_h noti,
+					       int flags)
+{
+	if (noti == NULL)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	noti->property = flags;
+	return NOTIFICATION_ERROR_NONE;
+}
+
+notification_error_e notification_set_display_applist(notification_h noti,
+						       int applist)
+{
+	if (noti == NULL)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	noti->applist = applist;
+	return NOTIFICATION_ERROR_NONE;
+}
+
+notification_error_e notification_set_execute_option(notification_h noti,
+						     notification_execute_type_e type,
+						     const char *text,
+						     const char *key,
+						     bundle *service_handle)
+{
+	if (noti == NULL)
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	noti->has_exec = service_handle != NULL;
+	return NOTIFICATION_ERROR_NONE;
+}
+
+/* The row is a copy, the caller frees its handle right after */
+notification_error_e notification_insert(notification_h noti, int *priv_id)
+{
+	struct _notification *row;
+
+	if (noti == NULL) {
+		standin_call(__func__, NOTIFICATION_ERROR_INVALID_DATA, "%s", "NULL");
+		return NOTIFICATION_ERROR_INVALID_DATA;
+	}
+
+	row = malloc(sizeof(*row));
+	if (row == NULL) {
+		standin_call(__func__, NOTIFICATION_ERROR_NO_MEMORY, "%s", "ENOMEM");
+		return NOTIFICATION_ERROR_NO_MEMORY;
+	}
+	*row = *noti;
+	row->priv_id = next_id++;
+	row->next = table;
+	table = row;
+	rows++;
+	if (priv_id)
+		*priv_id = row->priv_id;
+
+	standin_call(__func__, NOTIFICATION_ERROR_NONE,
+		     "type=%d, id=%d, \"%s\", rows=%d", row->type,
+		     row->priv_id, row->text[NOTIFICATION_TEXT_TYPE_TITLE], rows);
+	return NOTIFICATION_ERROR_NONE;
+}
+
+static int delete_rows(notification_type_e type, int priv_id)
+{
+	struct _notification **p, *row;
+	int n = 0;
+
+	for (p = &table; (row = *p); ) {
+		if (row->type == type && (priv_id < 0 || row->priv_id == priv_id)) {
+			*p = row->next;
+			free(row);
+			rows--;
+			n++;
+		} else {
+			p = &row->next;
+		}
+	}
+	return n;
+}
+
+notification_error_e notification_delete_all_by_type(const char *pkgname,
+						     notification_type_e type)
+{
+	int n;
+
+	n = delete_rows(type, -1);
+	standin_call(__func__, NOTIFICATION_ERROR_NONE,
+		     "type=%d, deleted=%d, rows=%d", type, n, rows);
+	return NOTIFICATION_ERROR_NONE;
+}
+
+notification_error_e notification_delete_by_priv_id(const char *pkgname,
+						    notification_type_e type,
+						    int priv_id)
+{
+	notification_error_e ret;
+	int n;
+
+	n = priv_id > 0 ? delete_rows(type, priv_id) : 0;
+	ret = n ? NOTIFICATION_ERROR_NONE : NOTIFICATION_ERROR_NOT_EXIST_ID;
+	standin_call(__func__, ret, "type=%d, id=%d, rows=%d", type, priv_id,
+		     rows);
+	return ret;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * syspopup, syspopup-caller and appsvc. There is one popup per process
+ * as with the platform library, and a launched service is only logged.
+ * The popup window's frames are logged while a request waits for one.
+ */
+
+#include <string.h>
+#include <syspopup.h>
+#include <syspopup_caller.h>
+#include <appsvc.h>
+#include "standin.h"
+
+#define APPSVC_OP_KEY	"__APP_SVC_OP_TYPE__"
+#define APPSVC_PKG_KEY	"__APP_SVC_PKG_NAME__"
+
+static syspopup_handler *popup_handler;
+static Evas_Object *popup_win;
+static void *popup_data;
+static int frame_seq;
+
+/* The next frame answers request 'seq' and every one before it */
+void standin_frame_expect(int seq)
+{
+	frame_seq = seq;
+}
+
+static void render_post(void *data, Evas *e, void *event_info)
+{
+	if (frame_seq == 0)
+		return;
+	standin_call("frame", 0, "seq=%d", frame_seq);
+	frame_seq = 0;
+}
+
+int syspopup_create(bundle *b, syspopup_handler *handler,
+		    Evas_Object *parent, void *user_data)
+{
+	int ret = parent ? 0 : -1;
+
+	if (ret == 0) {
+		popup_handler = handler;
+		popup_win = parent;
+		popup_data = user_data;
+		evas_event_callback_add(evas_object_evas_get(parent),
+					EVAS_CALLBACK_RENDER_POST,
+					render_post, NULL);
+	}
+	standin_call(__func__, ret, "%p", (void *)parent);
+	return ret;
+}
+
+int syspopup_has_popup(bundle *b)
+{
+	int ret = popup_win != NULL;
+
+	standin_call(__func__, ret, "%s", "");
+	return ret;
+}
+
+int syspopup_reset(bundle *b)
+{
+	int ret = popup_win ? 0 : -1;
+
+	standin_call(__func__, ret, "%d keys", bundle_get_count(b));
+	return ret;
+}
+
+/* "term" and "timeout" from the control FIFO */
+int standin_syspopup_event(int timeout)
+{
+	int (*fn)(bundle *, void *) = NULL;
+	int ret = -1;
+
+	if (popup_handler)
+		fn = timeout ? popup_handler->def_timeout_fn :
+			popup_handler->def_term_fn;
+	if (fn)
+		ret = fn(NULL, popup_data);
+	standin_call(timeout ? "syspopup_timeout" : "syspopup_term", ret,
+		     "%s", "");
+	return ret;
+}
+
+int syspopup_launch(char *popup_name, bundle *b)
+{
+	standin_call(__func__, 0, "\"%s\"", popup_name ? popup_name : "");
+	return 0;
+}
+
+static int replace(bundle *b, const char *key, const char *val)
+{
+	if (b == NULL || val == NULL)
+		return -1;
+	bundle_del(b, key);
+	return bundle_add(b, key, val);
+}
+
+int appsvc_set_operation(bundle *b, const char *operation)
+{
+	return replace(b, APPSVC_OP_KEY, operation);
+}
+
+int appsvc_set_pkgname(bundle *b, const char *pkg_name)
+{
+	return replace(b, APPSVC_PKG_KEY, pkg_name);
+}
+
+int appsvc_add_data(bundle *b, const char *key, const char *val)
+{
+	if (key == NULL || !strncmp(key, "__", 2))
+		return -1;
+	return replace(b, key, val);
+}
+
+int appsvc_run_service(bundle *b, int request_code, appsvc_res_fn cbfunc,
+		       void *data)
+{
+	const char *pkg = bundle_get_val(b, APPSVC_PKG_KEY);
+	int ret = pkg ? 0 : -1;
+
+	standin_call(__func__, ret, "\"%s\", \"%s\", %d keys", pkg ? pkg : "",
+		     bundle_get_val(b, APPSVC_OP_KEY) ?: "",
+		     bundle_get_count(b));
+	return ret;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * In-memory vconf. Keys are seeded from the STANDIN_VCONF file and can
+ * be changed from the control FIFO, which runs the change callbacks
+ * the same way vconfd would.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vconf.h>
+#include "standin.h"
+
+struct _keynode_t {
+	char *keyname;
+	int type;
+	int ival;
+	char *sval;
+	struct _keynode_t *next;
+};
+
+struct watch {
+	char *key;
+	vconf_callback_fn cb;
+	void *data;
+	struct watch *next;
+};
+
+static struct _keynode_t *keys;
+static struct watch *watches;
+static int loaded;
+
+static keynode_t *lookup(const char *key, int create)
+{
+	keynode_t *k;
+
+	for (k = keys; k; k = k->next)
+		if (!strcmp(k->keyname, key))
+			return k;
+	if (!create)
+		return NULL;
+
+	k = calloc(1, sizeof(*k));
+	if (k == NULL)
+		return NULL;
+	k->keyname = strdup(key);
+	if (k->keyname == NULL) {
+		free(k);
+		return NULL;
+	}
+	k->next = keys;
+	keys = k;
+	return k;
+}
+
+static int store(const char *key, int type, int ival, const char *sval)
+{
+	keynode_t *k;
+	char *s = NULL;
+
+	k = lookup(key, 1);
+	if (k == NULL)
+		return -1;
+	if (sval && (s = strdup(sval)) == NULL)
+		return -1;
+	free(k->sval);
+	k->type = type;
+	k->ival = ival;
+	k->sval = s;
+	return 0;
+}
+
+/* "true", "false" and numbers keep their type, the rest is a string */
+static int store_text(const char *key, const char *val)
+{
+	char *end;
+	long l;
+
+	if (!strcmp(val, "true") || !strcmp(val, "false"))
+		return store(key, VCONF_TYPE_BOOL, val[0] == 't', NULL);
+	l = strtol(val, &end, 0);
+	if (val[0] && *end == '\0')
+		return store(key, VCONF_TYPE_INT, (int)l, NULL);
+	return store(key, VCONF_TYPE_STRING, 0, val);
+}
+
+static void load(void)
+{
+	char line[STANDIN_LINE_MAX], *eq;
+	const char *path;
+	FILE *fp;
+
+	if (loaded)
+		return;
+	loaded = 1;
+
+	path = getenv(STANDIN_VCONF_ENV);
+	if (path == NULL || (fp = fopen(path, "r")) == NULL)
+		return;
+	while (fgets(line, sizeof(line), fp)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '#' || (eq = strchr(line, '=')) == NULL)
+			continue;
+		*eq = '\0';
+		store_text(line, eq + 1);
+	}
+	fclose(fp);
+}
+
+static void notify(keynode_t *k)
+{
+	struct watch *w, *next;
+
+	for (w = watches; w; w = next) {
+		next = w->next;
+		if (!strcmp(w->key, k->keyname))
+			w->cb(k, w->data);
+	}
+}
+
+int vconf_get_int(const char *key, int *val)
+{
+	keynode_t *k;
+	int ret = -1;
+
+	load();
+	k = key ? lookup(key, 0) : NULL;
+	if (k && val && k->type != VCONF_TYPE_STRING) {
+		*val = k->ival;
+		ret = 0;
+	}
+	standin_call(__func__, ret, "%s", key ? key : "");
+	return ret;
+}
+
+int vconf_get_bool(const char *key, int *val)
+{
+	int ret;
+
+	ret = vconf_get_int(key, val);
+	if (ret == 0)
+		*val = !!*val;
+	return ret;
+}
+
+char *vconf_get_str(const char *key)
+{
+	keynode_t *k;
+
+	load();
+	k = key ? lookup(key, 0) : NULL;
+	standin_call(__func__, k && k->sval ? 0 : -1, "%s", key ? key : "");
+	return k && k->sval ? strdup(k->sval) : NULL;
+}
+
+static int set(const char *fn, const char *key, int type, int ival,
+	       const char *sval)
+{
+	keynode_t *k;
+	int ret;
+
+	load();
+	ret = key ? store(key, type, ival, sval) : -1;
+	if (sval)
+		standin_call(fn, ret, "%s, \"%s\"", key ? key : "", sval);
+	else
+		standin_call(fn, ret, "%s, %d", key ? key : "", ival);
+	if (ret == 0 && (k = lookup(key, 0)))
+		notify(k);
+	return ret;
+}
+
+int vconf_set_int(const char *key, int val)
+{
+	return set(__func__, key, VCONF_TYPE_INT, val, NULL);
+}
+
+int vconf_set_bool(const char *key, int val)
+{
+	return set(__func__, key, VCONF_TYPE_BOOL, !!val, NULL);
+}
+
+int vconf_set_str(const char *key, const char *val)
+{
+	return set(__func__, key, VCONF_TYPE_STRING, 0, val ? val : "");
+}
+
+/* key=value from the control FIFO */
+int standin_vconf_apply(const char *pair)
+{
+	char key[256];
+	const char *eq;
+	keynode_t *k;
+	int ret;
+
+	eq = strchr(pair, '=');
+	if (eq == NULL || eq == pair || eq - pair >= (int)sizeof(key))
+		return -1;
+	memcpy(key, pair, eq - pair);
+	key[eq - pair] = '\0';
+
+	load();
+	ret = store_text(key, eq + 1);
+	standin_call("vconf_changed", ret, "%s, \"%s\"", key, eq + 1);
+	if (ret == 0 && (k = lookup(key, 0)))
+		notify(k);
+	return ret;
+}
+
+int vconf_notify_key_changed(const char *key, vconf_callback_fn cb,
+			     void *user_data)
+{
+	struct watch *w;
+
+	if (key == NULL || cb == NULL)
+		return -1;
+	w = calloc(1, sizeof(*w));
+	if (w == NULL || (w->key = strdup(key)) == NULL) {
+		free(w);
+		return -1;
+	}
+	w->cb = cb;
+	w->data = user_data;
+	w->next = watches;
+	watches = w;
+	standin_call(__func__, 0, "%s", key);
+	return 0;
+}
+
+int vconf_ignore_key_changed(const char *key, vconf_callback_fn cb)
+{
+	struct watch **p, *w;
+
+	if (key == NULL)
+		return -1;
+	for (p = &watches; (w = *p); p = &w->next) {
+		if (strcmp(w->key, key) || w->cb != cb)
+			continue;
+		*p = w->next;
+		free(w->key);
+		free(w);
+		standin_call(__func__, 0, "%s", key);
+		return 0;
+	}
+	standin_call(__func__, -1, "%s", key);
+	return -1;
+}
+
+const char *vconf_keynode_get_name(keynode_t *node)
+{
+	return node ? node->keyname : NULL;
+}
+
+int vconf_keynode_get_type(keynode_t *node)
+{
+	return node ? node->type : VCONF_TYPE_NONE;
+}
+
+int vconf_keynode_get_int(keynode_t *node)
+{
+	return node ? node->ival : -1;
+}
+
+int vconf_keynode_get_bool(keynode_t *node)
+{
+	return node ? !!node->ival : -1;
+}
+
+char *vconf_keynode_get_str(keynode_t *node)
+{
+	return node ? node->sval : NULL;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Clock and call log shared by the stand-ins.
+ *
+ * With STANDIN_CLOCK_STEP_US set the clock only moves by that step on
+ * each logged call, which takes host speed out of the timestamps. It is
+ * only the log's clock: popup-timer, timerfd and ecore still run on the
+ * real one, so calls made from timers can land in a different order or
+ * number between runs. Otherwise it is CLOCK_MONOTONIC, comparable with
+ * the clock of a driver running on the same host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "standin.h"
+
+static char app[32] = "?";
+static int log_fd = -1;
+static int step_us = -1;
+static uint64_t virt_us;
+
+static uint64_t mono_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void clock_setup(void)
+{
+	const char *env;
+
+	if (step_us >= 0)
+		return;
+	env = getenv(STANDIN_CLOCK_ENV);
+	step_us = env ? atoi(env) : 0;
+	if (step_us < 0)
+		step_us = 0;
+}
+
+uint64_t standin_now_us(void)
+{
+	clock_setup();
+	if (step_us > 0)
+		return __atomic_load_n(&virt_us, __ATOMIC_RELAXED);
+	return mono_ns() / 1000;
+}
+
+void standin_set_app(const char *name)
+{
+	if (name)
+		snprintf(app, sizeof(app), "%s", name);
+}
+
+static int log_open(void)
+{
+	const char *path;
+
+	if (log_fd >= 0)
+		return log_fd;
+	path = getenv(STANDIN_LOG_ENV);
+	if (path && path[0])
+		log_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (log_fd < 0)
+		log_fd = STDERR_FILENO;
+	return log_fd;
+}
+
+/* One line per call, written with a single append */
+void standin_call(const char *fn, int ret, const char *fmt, ...)
+{
+	char line[STANDIN_LINE_MAX];
+	uint64_t now;
+	va_list ap;
+	int n;
+
+	clock_setup();
+	if (step_us > 0)
+		now = __atomic_add_fetch(&virt_us, step_us, __ATOMIC_RELAXED);
+	else
+		now = standin_now_us();
+
+	n = snprintf(line, sizeof(line), "%llu %s %s(",
+		     (unsigned long long)now, app, fn);
+	if (fmt && n < (int)sizeof(line)) {
+		va_start(ap, fmt);
+		n += vsnprintf(line + n, sizeof(line) - n, fmt, ap);
+		va_end(ap);
+	}
+	if (n < (int)sizeof(line))
+		n += snprintf(line + n, sizeof(line) - n, ") = %d\n", ret);
+	if (n >= (int)sizeof(line)) {
+		n = sizeof(line) - 1;
+		line[n - 1] = '\n';
+	}
+
+	if (write(log_open(), line, n) < 0)
+		return;
+}
+
+static int hex(int c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/* Undo %XX escapes in place */
+int standin_decode(char *s)
+{
+	char *d = s;
+	int hi, lo;
+
+	for (; *s; s++) {
+		if (*s == '%' && (hi = hex(s[1])) >= 0 && (lo = hex(s[2])) >= 0) {
+			*d++ = hi << 4 | lo;
+			s += 2;
+		} else {
+			*d++ = *s;
+		}
+	}
+	*d = '\0';
+	return 0;
+}
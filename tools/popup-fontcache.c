@@ -0,0 +1,313 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Build the per-locale font cache read by popup_font_apply().
+ *
+ *   popup-fontcache [-o cache] [-F family] [-L localedir] [-d domain]...
+ *                   [locale...]
+ *
+ * For each locale every popup string is translated, its characters are
+ * collected and fontconfig picks, in its own order for that language,
+ * the fewest families that cover them all. Run it after installing
+ * fonts or translations; locales that are not installed are skipped.
+ *
+ * What the cache saves shows in the first_frame span of popup-trace.
+ * On a host with the CJK and Arabic fonts, the popup translations, a
+ * -DPOPUP_STANDIN=ON build and Xvfb, for each locale:
+ *
+ *   echo db/private/system-popup/trace=1 > vconf.txt
+ *   popup-fontcache -o font.cache ko_KR ja_JP zh_CN ar_AE
+ *   for cache in /nonexistent font.cache; do
+ *     for i in $(seq 20); do
+ *       echo 3 > /proc/sys/vm/drop_caches
+ *       LANG=ar_AE.UTF-8 STANDIN_VCONF=vconf.txt \
+ *       POPUP_FONT_CACHE_FILE=$cache \
+ *         popup-replay -g lowmem -n 1 -- lowmem-popup
+ *     done
+ *   done
+ *
+ * Each run leaves trace-lowmem-popup-<pid>.json in the private directory.
+ * Compare the first_frame durations with /nonexistent (before) and with
+ * font.cache (after); popup-replay's frame line gives the same numbers
+ * from the driver's side. Dropping the page cache keeps the fonts cold,
+ * without it both sides measure a warm fontconfig.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <locale.h>
+#include <libintl.h>
+#include <unistd.h>
+#include <fontconfig/fontconfig.h>
+#include "popup-font.h"
+
+#define MAX_ENTRIES	64
+#define MAX_DOMAINS	16
+
+/* Every msgid the popups show */
+static const char *msgids[] = {
+	"IDS_COM_BODY_SYSTEM_INFO_ABB",
+	"IDS_COM_SK_OK",
+	"IDS_COM_SK_CANCEL",
+	"IDS_COM_POP_BATTERYLOW",
+	"IDS_COM_POP_LOW_BATTERY_PHONE_WILL_SHUT_DOWN",
+	"IDS_COM_BODY_CHARGING_PAUSED_DUE_TO_EXTREME_TEMPERATURE",
+	"IDS_COM_POP_NOT_ENOUGH_MEMORY",
+	"IDS_IDLE_POP_PS_CLOSED",
+	"IDS_ST_BODY_POWER_OFF",
+	"IDS_ST_BODY_SLEEP",
+};
+
+static const char *default_locales[] = {
+	"en_US", "ko_KR", "ja_JP", "zh_CN", "zh_HK", "zh_TW", "ar_AE",
+};
+
+static const char *domains[MAX_DOMAINS] = {
+	"sys_string", "lowbatt-popup", "lowmem-popup", "poweroff-popup",
+	"usbotg-popup", "usbotg-unmount-popup",
+};
+static int ndomains = 6;
+
+static struct popup_font_ent entries[MAX_ENTRIES];
+static int nentries;
+
+static void add_utf8(FcCharSet *cs, const char *s)
+{
+	FcChar32 c;
+	int n, len = strlen(s);
+
+	while (len > 0) {
+		n = FcUtf8ToUcs4((const FcChar8 *)s, &c, len);
+		if (n <= 0)
+			break;
+		if (c > ' ')
+			FcCharSetAddChar(cs, c);
+		s += n;
+		len -= n;
+	}
+}
+
+/* Characters of every translated string, NULL if nothing is translated */
+static FcCharSet *collect(int *ntrans)
+{
+	FcCharSet *cs;
+	const char *s = NULL;
+	unsigned int i;
+	int d;
+	FcChar32 c;
+
+	cs = FcCharSetCreate();
+	for (c = '!'; c <= '~'; c++)
+		FcCharSetAddChar(cs, c);
+
+	*ntrans = 0;
+	for (i = 0; i < sizeof(msgids) / sizeof(msgids[0]); i++) {
+		for (d = 0; d < ndomains; d++) {
+			s = dgettext(domains[d], msgids[i]);
+			if (s != msgids[i] && strcmp(s, msgids[i]) != 0)
+				break;
+		}
+		if (d == ndomains)
+			continue;
+		add_utf8(cs, s);
+		(*ntrans)++;
+	}
+	return cs;
+}
+
+/* ko_KR to ko-kr, the fontconfig spelling */
+static void fc_lang(const char *locale, char *out, int size)
+{
+	int i;
+
+	for (i = 0; locale[i] && i < size - 1; i++)
+		out[i] = locale[i] == '_' ? '-' : tolower((unsigned char)locale[i]);
+	out[i] = '\0';
+}
+
+static int resolve(const char *family, const char *locale, FcCharSet *need,
+		   char *out, int size)
+{
+	FcPattern *pat, *font;
+	FcFontSet *set;
+	FcCharSet *cs, *left, *rest;
+	FcResult res;
+	FcChar8 *name;
+	char lang[POPUP_FONT_LOCALE];
+	int i, len = 0, n;
+
+	fc_lang(locale, lang, sizeof(lang));
+	pat = FcPatternCreate();
+	FcPatternAddString(pat, FC_FAMILY, (const FcChar8 *)family);
+	FcPatternAddString(pat, FC_LANG, (const FcChar8 *)lang);
+	FcConfigSubstitute(NULL, pat, FcMatchPattern);
+	FcDefaultSubstitute(pat);
+
+	set = FcFontSort(NULL, pat, FcFalse, NULL, &res);
+	FcPatternDestroy(pat);
+	if (set == NULL)
+		return -1;
+
+	out[0] = '\0';
+	left = FcCharSetCopy(need);
+	for (i = 0; i < set->nfont && FcCharSetCount(left) > 0; i++) {
+		font = set->fonts[i];
+		if (FcPatternGetCharSet(font, FC_CHARSET, 0, &cs) != FcResultMatch ||
+		    FcPatternGetString(font, FC_FAMILY, 0, &name) != FcResultMatch ||
+		    FcCharSetIntersectCount(left, cs) == 0)
+			continue;
+
+		/* Families are added whole, a full list keeps what fits */
+		if (strstr(out, (const char *)name) == NULL) {
+			n = snprintf(out + len, size - len, "%s%s",
+				     len ? "," : "", name);
+			if (n >= size - len) {
+				out[len] = '\0';
+				break;
+			}
+			len += n;
+		}
+
+		rest = FcCharSetSubtract(left, cs);
+		FcCharSetDestroy(left);
+		left = rest;
+	}
+
+	n = FcCharSetCount(left);
+	FcCharSetDestroy(left);
+	FcFontSetDestroy(set);
+
+	if (n > 0)
+		fprintf(stderr, "%s: %d characters not covered\n", locale, n);
+	return len ? 0 : -1;
+}
+
+static void add_locale(const char *family, const char *locale)
+{
+	struct popup_font_ent *ent;
+	char name[64];
+	FcCharSet *need;
+	int ntrans;
+
+	if (nentries == MAX_ENTRIES)
+		return;
+
+	snprintf(name, sizeof(name), "%s.UTF-8", locale);
+	if (setlocale(LC_ALL, name) == NULL) {
+		fprintf(stderr, "%s: locale not installed, skipped\n", locale);
+		return;
+	}
+
+	need = collect(&ntrans);
+	ent = &entries[nentries];
+	memset(ent, 0, sizeof(*ent));
+	popup_font_locale(locale, ent->locale, sizeof(ent->locale));
+
+	if (ntrans == 0)
+		fprintf(stderr, "%s: no translations, skipped\n", locale);
+	else if (resolve(family, locale, need, ent->families,
+			 sizeof(ent->families)) == 0) {
+		printf("%-8s %2d strings, %3d chars: %s\n", ent->locale, ntrans,
+		       FcCharSetCount(need), ent->families);
+		nentries++;
+	}
+
+	FcCharSetDestroy(need);
+	setlocale(LC_ALL, "C");
+}
+
+static int save(const char *path)
+{
+	struct popup_font_hdr h;
+	char tmp[512];
+	FILE *fp;
+
+	memset(&h, 0, sizeof(h));
+	h.magic = POPUP_FONT_MAGIC;
+	h.version = POPUP_FONT_VERSION;
+	h.nent = nentries;
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	fp = fopen(tmp, "wb");
+	if (fp == NULL) {
+		perror(tmp);
+		return 1;
+	}
+	if (fwrite(&h, sizeof(h), 1, fp) != 1 ||
+	    fwrite(entries, sizeof(entries[0]), nentries, fp) != (size_t)nentries ||
+	    fclose(fp) != 0 || rename(tmp, path) < 0) {
+		perror(path);
+		unlink(tmp);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = getenv(POPUP_FONT_ENV);
+	const char *family = "Tizen";
+	const char *localedir = NULL;
+	unsigned int i;
+	int opt, d;
+
+	if (path == NULL)
+		path = POPUP_FONT_PATH;
+
+	while ((opt = getopt(argc, argv, "o:F:L:d:")) != -1) {
+		switch (opt) {
+		case 'o':
+			path = optarg;
+			break;
+		case 'F':
+			family = optarg;
+			break;
+		case 'L':
+			localedir = optarg;
+			break;
+		case 'd':
+			if (ndomains < MAX_DOMAINS)
+				domains[ndomains++] = optarg;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-o cache] [-F family] "
+				"[-L localedir] [-d domain]... [locale...]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	if (!FcInit()) {
+		fprintf(stderr, "fontconfig init failed\n");
+		return 1;
+	}
+	if (localedir)
+		for (d = 0; d < ndomains; d++)
+			bindtextdomain(domains[d], localedir);
+
+	if (optind < argc)
+		for (; optind < argc; optind++)
+			add_locale(family, argv[optind]);
+	else
+		for (i = 0; i < sizeof(default_locales) / sizeof(default_locales[0]); i++)
+			add_locale(family, default_locales[i]);
+
+	return save(path);
+}
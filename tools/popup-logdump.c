@@ -0,0 +1,293 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Offline formatter for the popup ring logger dumps.
+ *
+ *   popup-logdump [-l level] /opt/var/lib/system-popup/<name>.log ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "popup-log.h"
+
+struct fmt_entry {
+	uint64_t addr;
+	char *str;
+};
+
+struct dump {
+	struct popup_log_hdr hdr;
+	struct popup_log_rec *rec;
+	struct fmt_entry *fmt;
+	int nfmt;
+};
+
+static const char *level_name[] = { "OFF", "ERR", "WRN", "INF", "DBG" };
+
+static const char *find_fmt(struct dump *d, uint64_t addr)
+{
+	int i;
+
+	for (i = 0; i < d->nfmt; i++)
+		if (d->fmt[i].addr == addr)
+			return d->fmt[i].str;
+	return NULL;
+}
+
+static int load(const char *path, struct dump *d)
+{
+	FILE *fp;
+	uint64_t addr;
+	uint32_t len;
+	size_t n;
+
+	memset(d, 0, sizeof(*d));
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	if (fread(&d->hdr, sizeof(d->hdr), 1, fp) != 1 ||
+	    d->hdr.magic != POPUP_LOG_MAGIC ||
+	    d->hdr.version != POPUP_LOG_VERSION ||
+	    d->hdr.rec_size != sizeof(struct popup_log_rec) ||
+	    d->hdr.nrec == 0 || (d->hdr.nrec & (d->hdr.nrec - 1))) {
+		fprintf(stderr, "%s: not a popup log dump\n", path);
+		fclose(fp);
+		return -1;
+	}
+
+	n = d->hdr.nrec;
+	d->rec = calloc(n, sizeof(struct popup_log_rec));
+	if (d->rec == NULL || fread(d->rec, sizeof(struct popup_log_rec), n, fp) != n)
+		goto truncated;
+
+	while (fread(&addr, sizeof(addr), 1, fp) == 1 &&
+	       fread(&len, sizeof(len), 1, fp) == 1 && addr != 0) {
+		struct fmt_entry *f;
+
+		f = realloc(d->fmt, (d->nfmt + 1) * sizeof(*f));
+		if (f == NULL)
+			goto truncated;
+		d->fmt = f;
+		f = &d->fmt[d->nfmt];
+		f->addr = addr;
+		f->str = malloc(len + 1);
+		if (f->str == NULL || fread(f->str, 1, len, fp) != len)
+			goto truncated;
+		f->str[len] = '\0';
+		d->nfmt++;
+	}
+
+	fclose(fp);
+	return 0;
+
+truncated:
+	fprintf(stderr, "%s: truncated dump\n", path);
+	fclose(fp);
+	return d->rec ? 0 : -1;
+}
+
+static int take(const struct popup_log_rec *r, int *off, void *dst, size_t n)
+{
+	if (*off + n > r->len)
+		return -1;
+	memcpy(dst, r->payload + *off, n);
+	*off += n;
+	return 0;
+}
+
+/* Re-run the format against the packed arguments */
+static void render(const struct popup_log_rec *r, const char *fmt, FILE *out)
+{
+	struct popup_log_spec s;
+	const char *p, *q;
+	char spec[64], str[POPUP_LOG_STR_MAX + 1];
+	int64_t star, v;
+	double d;
+	int off = 0, k;
+	uint8_t n;
+
+	for (p = fmt; *p; ) {
+		if (*p != '%') {
+			fputc(*p++, out);
+			continue;
+		}
+
+		q = popup_log_parse(p + 1, &s);
+		if (s.arg == POPUP_LOG_ARG_NONE) {
+			if (s.conv == '%')
+				fputc('%', out);
+			p = q;
+			continue;
+		}
+
+		/* Rebuild the spec without length modifiers, '*' resolved */
+		k = 0;
+		spec[k++] = '%';
+		for (p++; p < q - 1 && k < (int)sizeof(spec) - 24; p++) {
+			if (strchr("hlLqztj", *p))
+				continue;
+			if (*p == '*') {
+				if (take(r, &off, &star, sizeof(star)) < 0)
+					goto out;
+				k += snprintf(spec + k, sizeof(spec) - k, "%d", (int)star);
+				continue;
+			}
+			spec[k++] = *p;
+		}
+		p = q;
+
+		switch (s.arg) {
+		case POPUP_LOG_ARG_INT:
+		case POPUP_LOG_ARG_LONG:
+		case POPUP_LOG_ARG_LLONG:
+		case POPUP_LOG_ARG_SIZE:
+			if (take(r, &off, &v, sizeof(v)) < 0)
+				goto out;
+			if (s.conv == 'c') {
+				snprintf(spec + k, sizeof(spec) - k, "c");
+				fprintf(out, spec, (int)v);
+				break;
+			}
+			snprintf(spec + k, sizeof(spec) - k, "ll%c", s.conv);
+			fprintf(out, spec, (long long)v);
+			break;
+		case POPUP_LOG_ARG_DOUBLE:
+		case POPUP_LOG_ARG_LDOUBLE:
+			if (take(r, &off, &d, sizeof(d)) < 0)
+				goto out;
+			snprintf(spec + k, sizeof(spec) - k, "%c", s.conv);
+			fprintf(out, spec, d);
+			break;
+		case POPUP_LOG_ARG_STR:
+			if (take(r, &off, &n, 1) < 0 || n > POPUP_LOG_STR_MAX ||
+			    take(r, &off, str, n) < 0)
+				goto out;
+			str[n] = '\0';
+			snprintf(spec + k, sizeof(spec) - k, "s");
+			fprintf(out, spec, str);
+			break;
+		case POPUP_LOG_ARG_PTR:
+			if (take(r, &off, &v, sizeof(v)) < 0)
+				goto out;
+			fprintf(out, "0x%llx", (unsigned long long)v);
+			break;
+		default:
+			break;
+		}
+	}
+	return;
+
+out:
+	fputs(r->truncated ? "<truncated>" : "<bad record>", out);
+}
+
+static void print(struct dump *d, int max_level, FILE *out)
+{
+	const struct popup_log_hdr *h = &d->hdr;
+	const struct popup_log_rec *r;
+	const char *fmt;
+	uint64_t first, idx, real;
+	time_t sec;
+	struct tm tm;
+	char when[32];
+
+	fprintf(out, "# %.*s pid %u, %llu records written, %s\n",
+		(int)sizeof(h->name), h->name, h->pid,
+		(unsigned long long)h->head,
+		h->signo ? "crashed" : "exited");
+	if (h->signo)
+		fprintf(out, "# signal %d\n", h->signo);
+
+	first = h->head > h->nrec ? h->head - h->nrec : 0;
+	for (idx = first; idx < h->head; idx++) {
+		r = &d->rec[idx & (h->nrec - 1)];
+		if (r->seq != (uint32_t)(idx + 1))
+			continue;	/* torn or overwritten */
+		if (r->level > max_level)
+			continue;
+
+		real = h->real_ns - (h->mono_ns - r->ts_ns);
+		sec = real / 1000000000ULL;
+		localtime_r(&sec, &tm);
+		strftime(when, sizeof(when), "%m-%d %H:%M:%S", &tm);
+		fprintf(out, "%s.%06u %5u %s ", when,
+			(unsigned int)(real % 1000000000ULL / 1000), r->tid,
+			r->level < sizeof(level_name) / sizeof(level_name[0]) ?
+			level_name[r->level] : "???");
+
+		fmt = find_fmt(d, r->fmt);
+		if (fmt)
+			render(r, fmt, out);
+		else
+			fprintf(out, "<format 0x%llx missing>",
+				(unsigned long long)r->fmt);
+		if (r->truncated)
+			fputs(" <...>", out);
+		fputc('\n', out);
+	}
+}
+
+static void release(struct dump *d)
+{
+	int i;
+
+	for (i = 0; i < d->nfmt; i++)
+		free(d->fmt[i].str);
+	free(d->fmt);
+	free(d->rec);
+}
+
+int main(int argc, char *argv[])
+{
+	struct dump d;
+	int max_level = POPUP_LOG_DEBUG;
+	int opt, ret = 0;
+
+	while ((opt = getopt(argc, argv, "l:")) != -1) {
+		switch (opt) {
+		case 'l':
+			max_level = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-l level] dump...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-l level] dump...\n", argv[0]);
+		return 1;
+	}
+
+	for (; optind < argc; optind++) {
+		if (load(argv[optind], &d) < 0) {
+			ret = 1;
+			continue;
+		}
+		print(&d, max_level, stdout);
+		release(&d);
+	}
+
+	return ret;
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Readahead manifest for the first popup after boot.
+ *
+ *   popup-readahead -r [-o manifest] [-g pages] [-f path]... pid...
+ *   popup-readahead [-i] [-v] [manifest]
+ *
+ * -r records: after a cold start (caches dropped, popup launched and
+ * shown), every file the popups map or hold open, plus the files under
+ * each -f path (sounds, locale catalogs), is mapped and checked with
+ * mincore(). The page-cache resident ranges are written to the manifest,
+ * with holes up to -g pages merged. Page-cache residency stands in for
+ * fault tracing, so files shared with the rest of boot show up as well.
+ *
+ * Without -r the manifest is replayed from the boot script: the process
+ * drops to the lowest best-effort I/O priority (-i for the idle class)
+ * and asks for each range with POSIX_FADV_WILLNEED. Files whose size or
+ * mtime changed since recording are skipped, not read whole.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#define MANIFEST_PATH	"/opt/var/lib/system-popup/readahead.manifest"
+#define MANIFEST_MAGIC	"# syspopup-readahead 1"
+
+#define DEFAULT_GAP	8		/* pages */
+#define WINDOW		(64 << 20)	/* bytes mapped per mincore() */
+
+#define IOPRIO_CLASS_SHIFT	13
+#define IOPRIO_CLASS_BE		2
+#define IOPRIO_CLASS_IDLE	3
+#define IOPRIO_WHO_PROCESS	1
+
+struct seen {
+	dev_t dev;
+	ino_t ino;
+};
+
+static struct seen *seen;
+static int nseen;
+
+static FILE *out;
+static long page_size;
+static int gap = DEFAULT_GAP;
+static int nfiles, nranges;
+static unsigned long long nbytes;
+
+static int seen_add(const struct stat *st)
+{
+	struct seen *s;
+	int i;
+
+	for (i = 0; i < nseen; i++)
+		if (seen[i].dev == st->st_dev && seen[i].ino == st->st_ino)
+			return 0;
+
+	s = realloc(seen, (nseen + 1) * sizeof(*s));
+	if (s == NULL)
+		return 0;
+	seen = s;
+	seen[nseen].dev = st->st_dev;
+	seen[nseen].ino = st->st_ino;
+	nseen++;
+	return 1;
+}
+
+static void emit(const char *path, const struct stat *st, off_t off, off_t len)
+{
+	if (off >= st->st_size)
+		return;
+	if (off + len > st->st_size)
+		len = st->st_size - off;
+
+	fprintf(out, "%lld %lld %lld %lld %s\n", (long long)st->st_size,
+		(long long)st->st_mtime, (long long)off, (long long)len, path);
+	nranges++;
+	nbytes += len;
+}
+
+/* Write the resident ranges of one file */
+static void record_file(const char *path)
+{
+	struct stat st;
+	unsigned char *vec;
+	off_t win, pos, start = -1, last = -1;
+	size_t npages, i;
+	void *map;
+	int fd, found = 0;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return;
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0 ||
+	    !seen_add(&st)) {
+		close(fd);
+		return;
+	}
+
+	vec = malloc(WINDOW / page_size);
+	if (vec == NULL) {
+		close(fd);
+		return;
+	}
+
+	for (win = 0; win < st.st_size; win += WINDOW) {
+		size_t len = st.st_size - win < WINDOW ? st.st_size - win : WINDOW;
+
+		map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, win);
+		if (map == MAP_FAILED)
+			break;
+		npages = (len + page_size - 1) / page_size;
+		if (mincore(map, len, vec) < 0) {
+			munmap(map, len);
+			break;
+		}
+		munmap(map, len);
+
+		for (i = 0; i < npages; i++) {
+			if (!(vec[i] & 1))
+				continue;
+			pos = win + (off_t)i * page_size;
+			if (start >= 0 && pos - last > (off_t)gap * page_size) {
+				emit(path, &st, start, last - start);
+				start = -1;
+			}
+			if (start < 0)
+				start = pos;
+			last = pos + page_size;
+			found = 1;
+		}
+	}
+	if (start >= 0)
+		emit(path, &st, start, last - start);
+
+	nfiles += found;
+	free(vec);
+	close(fd);
+}
+
+static int walk_cb(const char *path, const struct stat *st, int type,
+		   struct FTW *ftw)
+{
+	if (type == FTW_F)
+		record_file(path);
+	return 0;
+}
+
+/* File-backed mappings and open files of one process */
+static void record_pid(const char *pid)
+{
+	char path[PATH_MAX + 64], line[PATH_MAX + 128], *p;
+	FILE *fp;
+	int i;
+	ssize_t n;
+
+	snprintf(path, sizeof(path), "/proc/%s/maps", pid);
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return;
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		p = strchr(line, '/');
+		if (p == NULL || strstr(p, " (deleted)"))
+			continue;
+		p[strcspn(p, "\n")] = '\0';
+		record_file(p);
+	}
+	fclose(fp);
+
+	for (i = 0; i < 1024; i++) {
+		snprintf(path, sizeof(path), "/proc/%s/fd/%d", pid, i);
+		n = readlink(path, line, sizeof(line) - 1);
+		if (n <= 0)
+			continue;
+		line[n] = '\0';
+		if (line[0] == '/' && strncmp(line, "/dev/", 5) != 0 &&
+		    strncmp(line, "/proc/", 6) != 0)
+			record_file(line);
+	}
+}
+
+static int record(const char *manifest, char **extra, int nextra,
+		  char **pids, int npids)
+{
+	char tmp[PATH_MAX];
+	int i;
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", manifest);
+	out = fopen(tmp, "w");
+	if (out == NULL) {
+		perror(tmp);
+		return 1;
+	}
+	fprintf(out, MANIFEST_MAGIC "\n");
+	fprintf(out, "# size mtime offset length path\n");
+
+	for (i = 0; i < npids; i++)
+		record_pid(pids[i]);
+	for (i = 0; i < nextra; i++)
+		nftw(extra[i], walk_cb, 16, FTW_PHYS);
+
+	if (fclose(out) != 0 || rename(tmp, manifest) < 0) {
+		perror(manifest);
+		unlink(tmp);
+		return 1;
+	}
+
+	printf("%s: %d files, %d ranges, %llu kB\n", manifest, nfiles,
+	       nranges, nbytes >> 10);
+	return 0;
+}
+
+static void lower_priority(int idle)
+{
+	int prio;
+
+	prio = idle ? IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT :
+		(IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7;
+	if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, prio) < 0)
+		perror("ioprio_set");
+	setpriority(PRIO_PROCESS, 0, 19);
+}
+
+static int prefetch(const char *manifest, int verbose)
+{
+	char line[PATH_MAX + 128], cur[PATH_MAX] = "";
+	long long size, mtime, off, len;
+	struct stat st;
+	struct timespec t0, t1;
+	FILE *fp;
+	int fd = -1, stale = 0, n, nstale = 0;
+
+	/* No manifest yet is not an error at boot */
+	fp = fopen(manifest, "r");
+	if (fp == NULL) {
+		n = errno;
+		if (verbose)
+			perror(manifest);
+		return n == ENOENT ? 0 : 1;
+	}
+	if (fgets(line, sizeof(line), fp) == NULL ||
+	    strncmp(line, MANIFEST_MAGIC, strlen(MANIFEST_MAGIC)) != 0) {
+		fprintf(stderr, "%s: not a readahead manifest\n", manifest);
+		fclose(fp);
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	while (fgets(line, sizeof(line), fp)) {
+		if (line[0] == '#')
+			continue;
+		line[strcspn(line, "\n")] = '\0';
+		if (sscanf(line, "%lld %lld %lld %lld %n", &size, &mtime, &off,
+			   &len, &n) != 4 || line[n] != '/')
+			continue;
+
+		/* Ranges of one file are consecutive */
+		if (strcmp(cur, line + n) != 0) {
+			if (fd >= 0)
+				close(fd);
+			snprintf(cur, sizeof(cur), "%s", line + n);
+			fd = open(cur, O_RDONLY | O_CLOEXEC);
+			stale = fd < 0 || fstat(fd, &st) < 0 ||
+				st.st_size != size || st.st_mtime != mtime;
+			nstale += stale;
+			nfiles += !stale;
+		}
+		if (stale)
+			continue;
+
+		posix_fadvise(fd, off, len, POSIX_FADV_WILLNEED);
+		nranges++;
+		nbytes += len;
+	}
+	if (fd >= 0)
+		close(fd);
+	fclose(fp);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	if (verbose)
+		printf("%s: %d files, %d ranges, %llu kB queued in %ld ms,"
+		       " %d stale\n", manifest, nfiles, nranges, nbytes >> 10,
+		       (t1.tv_sec - t0.tv_sec) * 1000 +
+		       (t1.tv_nsec - t0.tv_nsec) / 1000000, nstale);
+	return 0;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s -r [-o manifest] [-g pages] [-f path]... pid...\n"
+		"       %s [-i] [-v] [manifest]\n", prog, prog);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *manifest = MANIFEST_PATH;
+	char **extra = NULL, **e;
+	int nextra = 0, rec = 0, idle = 0, verbose = 0;
+	int opt;
+
+	page_size = sysconf(_SC_PAGESIZE);
+
+	while ((opt = getopt(argc, argv, "ro:g:f:iv")) != -1) {
+		switch (opt) {
+		case 'r':
+			rec = 1;
+			break;
+		case 'o':
+			manifest = optarg;
+			break;
+		case 'g':
+			gap = atoi(optarg);
+			break;
+		case 'f':
+			e = realloc(extra, (nextra + 1) * sizeof(*e));
+			if (e == NULL)
+				return 1;
+			extra = e;
+			/* The manifest only holds absolute paths */
+			extra[nextra] = realpath(optarg, NULL);
+			if (extra[nextra] == NULL) {
+				perror(optarg);
+				return 1;
+			}
+			nextra++;
+			break;
+		case 'i':
+			idle = 1;
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (rec) {
+		if (optind >= argc && nextra == 0) {
+			usage(argv[0]);
+			return 1;
+		}
+		return record(manifest, extra, nextra, argv + optind,
+			      argc - optind);
+	}
+
+	if (optind < argc)
+		manifest = argv[optind];
+	lower_priority(idle);
+	return prefetch(manifest, verbose);
+}
@@ -0,0 +1,614 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Replay launch requests against a popup built with POPUP_STANDIN.
+ *
+ *   popup-replay [-g usb|lowmem|batt|powerkey] [-n count] [-r rate]
+ *                [-s script] [-l log] [-x speed] [-t ms] [-o log]
+ *                -- popup [key=value ...]
+ *
+ * The popup is started with its control FIFO and call log in a scratch
+ * directory, the events are written to the FIFO on schedule and the
+ * log is read back once the popup has quit. Events come from one of
+ *
+ *   -g	a generator, count events at rate per second
+ *   -s	a script of "<gap ms> <control line>" lines
+ *   -l	the app_reset and vconf lines of an earlier stand-in log
+ *
+ * Latency is taken from the moment a request is written to the moment
+ * the popup returns from app_reset() and to its first frame after it.
+ * A request whose frame came only with a later request is coalesced,
+ * one no frame followed within -t ms is dropped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "standin.h"
+#include "popup-dispatch.h"
+
+#define DEFAULT_COUNT	100
+#define DEFAULT_RATE	10
+#define DEFAULT_WAIT_MS	2000
+#define START_WAIT_MS	10000
+#define QUIT_WAIT_MS	5000
+#define LOWMEM_APPS	64
+#define LOWMEM_BURST	8
+#define TITLE_MAX	64
+
+struct event {
+	uint64_t gap_us;		/* after the previous event */
+	int is_reset;
+	char line[STANDIN_LINE_MAX];
+};
+
+struct request {
+	uint64_t sent;
+	uint64_t reset;
+	uint64_t frame;
+};
+
+struct row {
+	int id;
+	int type;
+	char title[TITLE_MAX];
+};
+
+struct result {
+	int resets;
+	int frames;
+	int coalesced;			/* answered by a later request's frame */
+	int created;
+	int inserts;
+	int deletes;
+	int dup_noti;
+	int peak_rows;
+	int nrow;
+	struct row *rows;
+};
+
+static struct event *events;
+static int nevent;
+static struct request *reqs;	/* indexed by seq, 1 based */
+
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void sleep_until(uint64_t us)
+{
+	struct timespec ts;
+
+	ts.tv_sec = us / 1000000ULL;
+	ts.tv_nsec = (us % 1000000ULL) * 1000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
+
+static struct event *add_event(uint64_t gap_us, const char *fmt, ...)
+	__attribute__ ((format(printf, 2, 3)));
+
+static struct event *add_event(uint64_t gap_us, const char *fmt, ...)
+{
+	struct event *e;
+	va_list ap;
+
+	e = realloc(events, (nevent + 1) * sizeof(*e));
+	if (e == NULL) {
+		perror("realloc");
+		exit(1);
+	}
+	events = e;
+	e = &events[nevent++];
+	e->gap_us = gap_us;
+	va_start(ap, fmt);
+	vsnprintf(e->line, sizeof(e->line), fmt, ap);
+	va_end(ap);
+	e->is_reset = !strncmp(e->line, "reset", 5) &&
+		(e->line[5] == ' ' || e->line[5] == '\0');
+	return e;
+}
+
+/* Synthetic streams */
+static int generate(const char *kind, int count, int rate)
+{
+	uint64_t gap = 1000000ULL / (rate > 0 ? rate : 1);
+	unsigned int seed = 1;
+	int i, k;
+
+	for (i = 0; i < count; i++) {
+		k = i / 4;
+		if (!strcmp(kind, "usb")) {
+			/* plug and unplug storm over cameras and storage */
+			switch (i % 4) {
+			case 0:
+				add_event(gap, "reset " SYSPOPUP_CONTENT_KEY "=camera_add "
+					  "device_name=Camera%%20%d path=/camera/%d", k, k);
+				break;
+			case 1:
+				add_event(gap, "reset " SYSPOPUP_CONTENT_KEY "=otg_add "
+					  "path=/opt/storage/usb/disk%d", k);
+				break;
+			case 2:
+				add_event(gap, "reset " SYSPOPUP_CONTENT_KEY "=camera_remove "
+					  "path=/camera/%d", k);
+				break;
+			default:
+				add_event(gap, "reset " SYSPOPUP_CONTENT_KEY "=otg_remove "
+					  "path=/opt/storage/usb/disk%d", k);
+				break;
+			}
+		} else if (!strcmp(kind, "lowmem")) {
+			/* bursts of kills, a pause of a whole burst between */
+			add_event(i % LOWMEM_BURST ? gap : gap * LOWMEM_BURST,
+				  "reset _APP_NAME_=org.example.app%d",
+				  rand_r(&seed) % LOWMEM_APPS);
+		} else if (!strcmp(kind, "batt")) {
+			/* a level going back and forth over a threshold */
+			add_event(gap / 2 + rand_r(&seed) % (gap + 1),
+				  "reset " SYSPOPUP_CONTENT_KEY "=%s",
+				  i % 2 ? "chargeerr" : "warning");
+		} else if (!strcmp(kind, "powerkey")) {
+			add_event(gap, "reset");
+		} else {
+			fprintf(stderr, "unknown generator %s\n", kind);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int load_script(const char *path, double speed)
+{
+	char line[STANDIN_LINE_MAX + 32], *p;
+	double ms;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '#' || line[0] == '\0')
+			continue;
+		ms = strtod(line, &p);
+		if (p == line || *p != ' ')
+			continue;
+		add_event((uint64_t)(ms * 1000 / speed), "%s", p + 1);
+	}
+	fclose(fp);
+	return 0;
+}
+
+/* Spaces and '%' in a vconf value would split the control line */
+static void encode(const char *s, char *out, size_t n)
+{
+	size_t k = 0;
+
+	for (; *s && k + 4 < n; s++) {
+		if (*s == ' ' || *s == '%' || *s == '\t')
+			k += snprintf(out + k, n - k, "%%%02X", (unsigned char)*s);
+		else
+			out[k++] = *s;
+	}
+	out[k] = '\0';
+}
+
+/* Requests recorded by an earlier stand-in run, with their spacing */
+static int load_log(const char *path, double speed)
+{
+	char line[STANDIN_LINE_MAX], key[256], val[STANDIN_LINE_MAX / 2];
+	char enc[STANDIN_LINE_MAX / 2];
+	unsigned long long ts, prev = 0;
+	char *p, *end;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%llu", &ts) != 1)
+			continue;
+		if ((p = strstr(line, " app_reset(seq=")) != NULL) {
+			p = strchr(p, ',');
+			end = strrchr(line, ')');
+			if (p == NULL || end == NULL || end < p)
+				continue;
+			*end = '\0';
+			add_event(prev ? (ts - prev) / speed : 0, "reset%s%s",
+				  p[1] == ' ' && p[2] ? " " : "", p + 2);
+		} else if ((p = strstr(line, " vconf_changed(")) != NULL) {
+			if (sscanf(p, " vconf_changed(%255[^,], \"%511[^\"]", key, val) != 2)
+				continue;
+			encode(val, enc, sizeof(enc));
+			add_event(prev ? (ts - prev) / speed : 0, "vconf %s=%s",
+				  key, enc);
+		} else {
+			continue;
+		}
+		prev = ts;
+	}
+	fclose(fp);
+	return 0;
+}
+
+static pid_t launch(char **argv, const char *ctl, const char *log)
+{
+	pid_t pid;
+
+	pid = fork();
+	if (pid != 0)
+		return pid;
+
+	setenv(STANDIN_CTL_ENV, ctl, 1);
+	setenv(STANDIN_LOG_ENV, log, 1);
+	unsetenv(STANDIN_CLOCK_ENV);	/* latency needs the real clock */
+	execvp(argv[0], argv);
+	perror(argv[0]);
+	_exit(127);
+}
+
+/* The FIFO opens for writing once the popup reads it */
+static int connect_ctl(const char *ctl, pid_t pid)
+{
+	uint64_t deadline = now_us() + START_WAIT_MS * 1000ULL;
+	int fd;
+
+	while (now_us() < deadline) {
+		fd = open(ctl, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd >= 0) {
+			/* block from now on, a slow popup pushes back */
+			fcntl(fd, F_SETFL, 0);
+			return fd;
+		}
+		if (waitpid(pid, NULL, WNOHANG) == pid)
+			return -1;
+		usleep(10000);
+	}
+	return -1;
+}
+
+static int send_events(int fd)
+{
+	char line[STANDIN_LINE_MAX + 32];
+	uint64_t at = now_us();
+	int i, seq = 0, n;
+
+	for (i = 0; i < nevent; i++) {
+		at += events[i].gap_us;
+		sleep_until(at);
+
+		if (events[i].is_reset) {
+			seq++;
+			n = snprintf(line, sizeof(line), "reset " STANDIN_SEQ_KEY "=%d%s\n",
+				     seq, events[i].line + 5);
+		} else {
+			n = snprintf(line, sizeof(line), "%s\n", events[i].line);
+		}
+		if (n >= (int)sizeof(line))
+			n = sizeof(line) - 1;
+
+		if (events[i].is_reset)
+			reqs[seq].sent = now_us();
+		if (write(fd, line, n) != n) {
+			fprintf(stderr, "popup went away after %d events\n", i);
+			return seq - (events[i].is_reset ? 1 : 0);
+		}
+	}
+	return seq;
+}
+
+static void row_drop(struct result *r, int type, int id)
+{
+	int i;
+
+	for (i = 0; i < r->nrow; ) {
+		if (r->rows[i].type == type && (id < 0 || r->rows[i].id == id))
+			r->rows[i] = r->rows[--r->nrow];
+		else
+			i++;
+	}
+}
+
+static void row_add(struct result *r, int type, int id, const char *title)
+{
+	struct row *p;
+	int i;
+
+	for (i = 0; i < r->nrow; i++)
+		if (r->rows[i].type == type && !strcmp(r->rows[i].title, title))
+			r->dup_noti++;
+
+	p = realloc(r->rows, (r->nrow + 1) * sizeof(*p));
+	if (p == NULL)
+		return;
+	r->rows = p;
+	p = &r->rows[r->nrow++];
+	p->id = id;
+	p->type = type;
+	snprintf(p->title, sizeof(p->title), "%s", title);
+	if (r->nrow > r->peak_rows)
+		r->peak_rows = r->nrow;
+}
+
+static int parse_log(const char *path, int nreq, struct result *r)
+{
+	char line[STANDIN_LINE_MAX], title[TITLE_MAX];
+	unsigned long long ts;
+	int seq, type, id, rows, n, j, framed = 0;
+	char *p;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%llu", &ts) != 1)
+			continue;
+
+		if ((p = strstr(line, " app_reset(seq=")) != NULL) {
+			seq = atoi(p + 15);
+			if (seq > 0 && seq <= nreq) {
+				reqs[seq].reset = ts;
+				r->resets++;
+			}
+		} else if ((p = strstr(line, " frame(seq=")) != NULL) {
+			/* answers every request since the last frame */
+			seq = atoi(p + 11);
+			for (j = framed + 1; j <= seq && j <= nreq; j++) {
+				if (reqs[j].frame == 0 && reqs[j].sent &&
+				    ts >= reqs[j].sent) {
+					reqs[j].frame = ts;
+					r->frames++;
+					if (j < seq)
+						r->coalesced++;
+				}
+			}
+			if (seq > framed)
+				framed = seq;
+		} else if (strstr(line, " syspopup_create(") && strstr(line, ") = 0")) {
+			r->created++;
+		} else if ((p = strstr(line, " notification_insert(")) != NULL) {
+			if (sscanf(p, " notification_insert(type=%d, id=%d, \"%63[^\"]\", rows=%d",
+				   &type, &id, title, &rows) == 4) {
+				r->inserts++;
+				row_add(r, type, id, title);
+			}
+		} else if ((p = strstr(line, " notification_delete_by_priv_id(")) != NULL) {
+			r->deletes++;
+			if (sscanf(p, " notification_delete_by_priv_id(type=%d, id=%d",
+				   &type, &id) == 2)
+				row_drop(r, type, id);
+		} else if ((p = strstr(line, " notification_delete_all_by_type(")) != NULL) {
+			r->deletes++;
+			if (sscanf(p, " notification_delete_all_by_type(type=%d, deleted=%d",
+				   &type, &n) == 2)
+				row_drop(r, type, -1);
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	const uint64_t *x = a, *y = b;
+
+	return *x < *y ? -1 : *x > *y;
+}
+
+static void print_latency(const char *what, int nreq, int frame)
+{
+	uint64_t *v, t;
+	int i, n = 0;
+
+	v = calloc(nreq + 1, sizeof(*v));
+	if (v == NULL)
+		return;
+	for (i = 1; i <= nreq; i++) {
+		t = frame ? reqs[i].frame : reqs[i].reset;
+		if (t && reqs[i].sent && t >= reqs[i].sent)
+			v[n++] = t - reqs[i].sent;
+	}
+
+	if (n == 0) {
+		printf("%-14s no samples\n", what);
+	} else {
+		qsort(v, n, sizeof(*v), cmp_u64);
+		printf("%-14s p50 %.2f  p90 %.2f  p99 %.2f  max %.2f ms (%d)\n",
+		       what, v[n / 2] / 1000.0, v[n * 90 / 100] / 1000.0,
+		       v[n * 99 / 100] / 1000.0, v[n - 1] / 1000.0, n);
+	}
+	free(v);
+}
+
+/* Ends the popup and reaps it, -1 if its status and usage are unknown */
+static int stop(pid_t pid, int fd, int *status, struct rusage *ru)
+{
+	uint64_t deadline = now_us() + QUIT_WAIT_MS * 1000ULL;
+	pid_t r;
+
+	*status = 0;
+	memset(ru, 0, sizeof(*ru));
+
+	/* A popup that already exited is reaped below all the same */
+	if (write(fd, "quit\n", 5) != 5)
+		kill(pid, SIGTERM);
+	close(fd);
+
+	while ((r = wait4(pid, status, WNOHANG, ru)) == 0) {
+		if (now_us() > deadline) {
+			kill(pid, SIGKILL);
+			r = wait4(pid, status, 0, ru);
+			break;
+		}
+		usleep(10000);
+	}
+	if (r != pid) {
+		perror("wait4");
+		return -1;
+	}
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-g usb|lowmem|batt|powerkey] [-n count] [-r rate]\n"
+		"       [-s script] [-l log] [-x speed] [-t ms] [-o log] -- popup [key=value ...]\n",
+		name);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *gen = NULL, *script = NULL, *replay = NULL, *keep = NULL;
+	char dir[] = "/tmp/popup-replay.XXXXXX";
+	char ctl[PATH_MAX], log[PATH_MAX];
+	int count = DEFAULT_COUNT, rate = DEFAULT_RATE, wait_ms = DEFAULT_WAIT_MS;
+	int opt, fd, nreq, i, status, reaped;
+	double speed = 1.0;
+	struct result res;
+	struct rusage ru;
+	pid_t pid;
+
+	while ((opt = getopt(argc, argv, "g:n:r:s:l:x:t:o:")) != -1) {
+		switch (opt) {
+		case 'g':
+			gen = optarg;
+			break;
+		case 'n':
+			count = atoi(optarg);
+			break;
+		case 'r':
+			rate = atoi(optarg);
+			break;
+		case 's':
+			script = optarg;
+			break;
+		case 'l':
+			replay = optarg;
+			break;
+		case 'x':
+			speed = atof(optarg);
+			break;
+		case 't':
+			wait_ms = atoi(optarg);
+			break;
+		case 'o':
+			keep = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (optind >= argc || (!gen && !script && !replay) || speed <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (keep && strlen(keep) >= sizeof(log)) {
+		fprintf(stderr, "%s: -o path too long\n", argv[0]);
+		return 1;
+	}
+
+	if ((gen && generate(gen, count, rate) < 0) ||
+	    (script && load_script(script, speed) < 0) ||
+	    (replay && load_log(replay, speed) < 0))
+		return 1;
+
+	for (i = 0, nreq = 0; i < nevent; i++)
+		nreq += events[i].is_reset;
+	reqs = calloc(nreq + 1, sizeof(*reqs));
+	if (reqs == NULL || mkdtemp(dir) == NULL) {
+		perror("popup-replay");
+		return 1;
+	}
+	snprintf(ctl, sizeof(ctl), "%s/ctl", dir);
+	if (keep)
+		snprintf(log, sizeof(log), "%s", keep);
+	else
+		snprintf(log, sizeof(log), "%s/log", dir);
+	unlink(log);
+
+	signal(SIGPIPE, SIG_IGN);
+	pid = launch(&argv[optind], ctl, log);
+	if (pid < 0 || (fd = connect_ctl(ctl, pid)) < 0) {
+		fprintf(stderr, "%s did not open its control FIFO, "
+			"is it built with POPUP_STANDIN?\n", argv[optind]);
+		if (pid > 0)
+			kill(pid, SIGKILL);
+		return 1;
+	}
+
+	nreq = send_events(fd);
+	usleep(wait_ms * 1000);
+	reaped = stop(pid, fd, &status, &ru) == 0;
+
+	memset(&res, 0, sizeof(res));
+	if (parse_log(log, nreq, &res) < 0)
+		return 1;
+
+	printf("events         %d sent, %d requests, %d reset\n",
+	       nevent, nreq, res.resets);
+	printf("frames         %d own, %d coalesced, %d dropped\n",
+	       res.frames - res.coalesced, res.coalesced, nreq - res.frames);
+	print_latency("reset", nreq, 0);
+	print_latency("frame", nreq, 1);
+	printf("popups         %d created, %d duplicate\n", res.created,
+	       res.created > 1 ? res.created - 1 : 0);
+	printf("notifications  %d inserts, %d deletes, %d duplicate, peak %d rows, %d left\n",
+	       res.inserts, res.deletes, res.dup_noti, res.peak_rows, res.nrow);
+	if (reaped)
+		printf("memory         peak rss %ld kB\n", ru.ru_maxrss);
+	else
+		printf("memory         peak rss unknown\n");
+	if (reaped && WIFSIGNALED(status))
+		printf("popup          killed by signal %d\n", WTERMSIG(status));
+
+	if (!keep)
+		unlink(log);
+	unlink(ctl);
+	rmdir(dir);
+	free(res.rows);
+	free(reqs);
+	free(events);
+	return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Print the popup counters without touching the popups.
+ *
+ *   popup-stats [-k] [-i seconds]
+ *
+ * -k prints type.name=value lines for scripts, -i repeats every interval.
+ * The segment is mapped read-only, values are read with relaxed loads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "popup-stats.h"
+
+#define NAME_STR(id, name)	name,
+
+static const char *type_name[] = { POPUP_STATS_TYPES(NAME_STR) };
+static const char *ctr_name[] = { POPUP_STATS_COUNTERS(NAME_STR) };
+static const char *gauge_name[] = { POPUP_STATS_GAUGES(NAME_STR) };
+
+static const struct popup_stats_shm *attach(void)
+{
+	const struct popup_stats_shm *p;
+	struct stat st;
+	int fd;
+
+	fd = shm_open(POPUP_STATS_SHM_NAME, O_RDONLY, 0);
+	if (fd < 0) {
+		fprintf(stderr, "no popup has run yet\n");
+		return NULL;
+	}
+
+	/* Reading past the end of a short segment would raise SIGBUS */
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(*p)) {
+		fprintf(stderr, "counter layout does not match this tool\n");
+		close(fd);
+		return NULL;
+	}
+
+	p = mmap(NULL, sizeof(*p), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) {
+		perror("mmap");
+		return NULL;
+	}
+
+	if (__atomic_load_n(&p->magic, __ATOMIC_ACQUIRE) != POPUP_STATS_MAGIC ||
+	    p->version != POPUP_STATS_VERSION || p->ntypes != POPUP_TYPE_MAX ||
+	    p->nctr != POPUP_STAT_MAX || p->ngauge != POPUP_GAUGE_MAX ||
+	    p->npid != POPUP_STATS_PIDS) {
+		fprintf(stderr, "counter layout does not match this tool\n");
+		munmap((void *)p, sizeof(*p));
+		return NULL;
+	}
+
+	return p;
+}
+
+static void print_keys(const struct popup_stats_shm *p)
+{
+	int t, i;
+
+	for (t = 0; t < POPUP_TYPE_MAX; t++) {
+		for (i = 0; i < POPUP_STAT_MAX; i++)
+			printf("%s.%s=%llu\n", type_name[t], ctr_name[i],
+			       (unsigned long long)__atomic_load_n(&p->type[t].ctr[i],
+								    __ATOMIC_RELAXED));
+		for (i = 0; i < POPUP_GAUGE_MAX; i++)
+			printf("%s.%s=%lld\n", type_name[t], gauge_name[i],
+			       (long long)popup_stats_gauge_get(&p->type[t], i));
+	}
+}
+
+static void print_table(const struct popup_stats_shm *p)
+{
+	int t, i;
+
+	printf("%-18s", "");
+	for (t = 0; t < POPUP_TYPE_MAX; t++)
+		printf(" %14s", type_name[t]);
+	printf("\n");
+
+	for (i = 0; i < POPUP_STAT_MAX; i++) {
+		printf("%-18s", ctr_name[i]);
+		for (t = 0; t < POPUP_TYPE_MAX; t++)
+			printf(" %14llu", (unsigned long long)
+			       __atomic_load_n(&p->type[t].ctr[i], __ATOMIC_RELAXED));
+		printf("\n");
+	}
+
+	for (i = 0; i < POPUP_GAUGE_MAX; i++) {
+		printf("%-18s", gauge_name[i]);
+		for (t = 0; t < POPUP_TYPE_MAX; t++)
+			printf(" %14lld", (long long)
+			       popup_stats_gauge_get(&p->type[t], i));
+		printf("\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const struct popup_stats_shm *p;
+	int keys = 0, interval = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "ki:")) != -1) {
+		switch (opt) {
+		case 'k':
+			keys = 1;
+			break;
+		case 'i':
+			interval = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-k] [-i seconds]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	p = attach();
+	if (p == NULL)
+		return 1;
+
+	for (;;) {
+		if (keys)
+			print_keys(p);
+		else
+			print_table(p);
+		fflush(stdout);
+
+		if (interval <= 0)
+			break;
+		sleep(interval);
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+
+/*
+ * Print the shutdown runs kept by the timeline recorder, oldest first.
+ *
+ *   popup-timeline [-c] [file]
+ *
+ * -c prints seq,boot_id,start,stage,us lines for collection.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "popup-timeline.h"
+
+static struct popup_timeline_rec runs[POPUP_TIMELINE_SLOTS * POPUP_TIMELINE_COPIES];
+static int nrun;
+
+static int valid(const struct popup_timeline_rec *r)
+{
+	struct popup_timeline_rec tmp;
+
+	if (r->magic != POPUP_TIMELINE_MAGIC ||
+	    r->version != POPUP_TIMELINE_VERSION ||
+	    r->nstage > POPUP_TIMELINE_STAGES)
+		return 0;
+	tmp = *r;
+	tmp.crc = 0;
+	return popup_timeline_crc(&tmp, sizeof(tmp)) == r->crc;
+}
+
+static int by_seq(const void *a, const void *b)
+{
+	const struct popup_timeline_rec *x = a, *y = b;
+
+	if (x->seq != y->seq)
+		return x->seq < y->seq ? -1 : 1;
+	return x->nstage < y->nstage ? -1 : x->nstage > y->nstage;
+}
+
+/*
+ * One entry per run, the copy with the most stages. A run whose slot has
+ * since been taken again may have one stale record left, drop it.
+ */
+static void dedup(void)
+{
+	uint32_t newest;
+	int i, n = 0;
+
+	if (nrun == 0)
+		return;
+	newest = runs[nrun - 1].seq;
+
+	for (i = 0; i < nrun; i++) {
+		if (i + 1 < nrun && runs[i + 1].seq == runs[i].seq)
+			continue;
+		if (newest - runs[i].seq >= POPUP_TIMELINE_SLOTS)
+			continue;
+		runs[n++] = runs[i];
+	}
+	nrun = n;
+}
+
+static int load(const char *path)
+{
+	struct popup_timeline_rec r;
+	FILE *fp;
+	int torn = 0;
+
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	while (nrun < POPUP_TIMELINE_SLOTS * POPUP_TIMELINE_COPIES && fread(&r, sizeof(r), 1, fp) == 1) {
+		if (valid(&r))
+			runs[nrun++] = r;
+		else if (r.magic == POPUP_TIMELINE_MAGIC)
+			torn++;
+	}
+	fclose(fp);
+
+	if (torn)
+		fprintf(stderr, "%s: %d torn record(s) skipped\n", path, torn);
+	qsort(runs, nrun, sizeof(runs[0]), by_seq);
+	dedup();
+	return 0;
+}
+
+static void print_run(const struct popup_timeline_rec *r)
+{
+	time_t sec = r->real_ns / 1000000000ULL;
+	uint32_t prev = 0;
+	struct tm tm;
+	char when[32];
+	int i;
+
+	localtime_r(&sec, &tm);
+	strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+	printf("# run %u pid %u at %s boot %s\n", r->seq, r->pid, when,
+	       r->boot_id[0] ? r->boot_id : "?");
+
+	for (i = 0; i < r->nstage; i++) {
+		printf("  %-12.*s %9.3f ms  +%9.3f ms\n",
+		       POPUP_TIMELINE_NAME, r->stage[i].name,
+		       r->stage[i].us / 1000.0, (r->stage[i].us - prev) / 1000.0);
+		prev = r->stage[i].us;
+	}
+	if (r->nstage == 0)
+		printf("  (no stages)\n");
+}
+
+static void print_csv(const struct popup_timeline_rec *r)
+{
+	int i;
+
+	for (i = 0; i < r->nstage; i++)
+		printf("%u,%s,%llu,%.*s,%u\n", r->seq, r->boot_id,
+		       (unsigned long long)(r->real_ns / 1000000000ULL),
+		       POPUP_TIMELINE_NAME, r->stage[i].name, r->stage[i].us);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = POPUP_TIMELINE_PATH;
+	int opt, csv = 0, i;
+
+	while ((opt = getopt(argc, argv, "c")) != -1) {
+		switch (opt) {
+		case 'c':
+			csv = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-c] [file]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (optind < argc)
+		path = argv[optind];
+
+	if (load(path) < 0)
+		return 1;
+
+	for (i = 0; i < nrun; i++) {
+		if (csv)
+			print_csv(&runs[i]);
+		else
+			print_run(&runs[i]);
+	}
+
+	return 0;
+}
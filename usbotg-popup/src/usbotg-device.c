@@ -0,0 +1,383 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <Eina.h>
+#include "usbotg-device.h"
+#include "popup-log.h"
+
+static Eina_Hash *devices = NULL;
+static Eina_List *by_type[USB_DEV_MAX];	/* newest last */
+
+static char reg_dir[PATH_MAX];
+static char reg_file[PATH_MAX];
+static int reg_state = 0;		/* 1 usable, -1 failed and logged */
+
+/* Pick the registry directory once, create it and check its owner */
+static int registry_dir(void)
+{
+	const char *run = getenv(USB_DEVICE_RUNTIME_ENV);
+	struct stat st;
+
+	if (reg_state)
+		return reg_state > 0 ? 0 : -1;
+
+	if (run && run[0] == '/')
+		snprintf(reg_dir, sizeof(reg_dir), "%s/%s", run, USB_DEVICE_SUBDIR);
+	else
+		snprintf(reg_dir, sizeof(reg_dir), "%s", USB_DEVICE_DIR);
+	if (snprintf(reg_file, sizeof(reg_file), "%s/%s", reg_dir,
+		     USB_DEVICE_FILE) >= (int)sizeof(reg_file))
+		goto fail;
+
+	if (mkdir(reg_dir, 0700) < 0 && errno != EEXIST)
+		goto fail;
+	if (lstat(reg_dir, &st) < 0)
+		goto fail;
+	if (!S_ISDIR(st.st_mode) || st.st_uid != geteuid() ||
+	    (st.st_mode & (S_IWGRP | S_IWOTH))) {
+		errno = EPERM;
+		goto fail;
+	}
+
+	reg_state = 1;
+	return 0;
+
+fail:
+	system_print("\n usbotg : device registry %s unusable (%s), devices "
+		     "are not remembered between launches \n",
+		     reg_dir, strerror(errno));
+	reg_state = -1;
+	return -1;
+}
+
+/* Registry directory, locked against other usbotg processes */
+static int registry_lock(int op)
+{
+	int fd;
+
+	if (registry_dir() < 0)
+		return -1;
+
+	fd = open(reg_dir, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+	if (fd < 0)
+		return -1;
+	if (flock(fd, op) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/* Tabs and newlines separate the fields, so escape them and the rest */
+static void put_escaped(FILE *fp, const char *s)
+{
+	const unsigned char *p;
+
+	for (p = (const unsigned char *)s; *p; p++) {
+		if (*p < 0x20 || *p == 0x7f || *p == '%')
+			fprintf(fp, "%%%02X", *p);
+		else
+			fputc(*p, fp);
+	}
+}
+
+static int hex(int c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+/* Undo put_escaped() in place, -1 on a malformed escape */
+static int unescape(char *s)
+{
+	char *d = s;
+	int hi, lo;
+
+	for (; *s; s++) {
+		if (*s != '%') {
+			*d++ = *s;
+			continue;
+		}
+		hi = hex(s[1]);
+		lo = hi < 0 ? -1 : hex(s[2]);
+		if (lo < 0 || (hi == 0 && lo == 0))
+			return -1;
+		*d++ = (char)(hi << 4 | lo);
+		s += 2;
+	}
+	*d = '\0';
+	return 0;
+}
+
+static void registry_unlock(int fd)
+{
+	if (fd >= 0)
+		close(fd);
+}
+
+static void type_link(struct usb_device *dev)
+{
+	if (dev->type >= 0 && dev->type < USB_DEV_MAX)
+		by_type[dev->type] = eina_list_append(by_type[dev->type], dev);
+}
+
+static void type_unlink(struct usb_device *dev)
+{
+	if (dev->type >= 0 && dev->type < USB_DEV_MAX)
+		by_type[dev->type] = eina_list_remove(by_type[dev->type], dev);
+}
+
+static void device_free(void *data)
+{
+	struct usb_device *dev = data;
+
+	if (dev == NULL)
+		return;
+	type_unlink(dev);
+	free(dev->key);
+	free(dev->name);
+	free(dev->path);
+	free(dev);
+}
+
+static struct usb_device *device_new(int type, int priv_id, const char *key,
+				     const char *name, const char *path)
+{
+	struct usb_device *dev;
+
+	dev = calloc(1, sizeof(*dev));
+	if (dev == NULL)
+		return NULL;
+
+	dev->type = type;
+	dev->priv_id = priv_id;
+	dev->key = strdup(key);
+	dev->name = strdup(name ? name : key);
+	dev->path = strdup(path ? path : "");
+	if (!dev->key || !dev->name || !dev->path) {
+		device_free(dev);
+		return NULL;
+	}
+
+	return dev;
+}
+
+/* Load the devices recorded by earlier popup processes */
+int usb_device_init(void)
+{
+	struct usb_device *dev;
+	char line[1024];
+	char *key, *name, *path, *end;
+	int type, priv_id, lock, fd;
+	FILE *fp;
+
+	if (devices)
+		return 0;
+
+	eina_init();
+	devices = eina_hash_string_superfast_new(device_free);
+	if (devices == NULL)
+		return -1;
+
+	lock = registry_lock(LOCK_SH);
+	if (lock < 0)
+		return 0;
+	fd = open(reg_file, O_RDONLY | O_NOFOLLOW);
+	fp = fd >= 0 ? fdopen(fd, "r") : NULL;
+	if (fp == NULL) {
+		if (fd >= 0)
+			close(fd);
+		registry_unlock(lock);
+		return 0;
+	}
+
+	/* type priv_id key<TAB>name<TAB>path, fields %XX escaped */
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%d %d", &type, &priv_id) != 2)
+			continue;
+		key = strchr(line, ' ');
+		key = key ? strchr(key + 1, ' ') : NULL;
+		if (key == NULL)
+			continue;
+		key++;
+		name = strchr(key, '\t');
+		path = name ? strchr(name + 1, '\t') : NULL;
+		if (path == NULL)
+			continue;
+		*name++ = '\0';
+		*path++ = '\0';
+		end = strchr(path, '\n');
+		if (end)
+			*end = '\0';
+		if (unescape(key) < 0 || unescape(name) < 0 ||
+		    unescape(path) < 0)
+			continue;
+
+		dev = device_new(type, priv_id, key, name, path);
+		if (dev == NULL)
+			continue;
+		if (!eina_hash_add(devices, dev->key, dev)) {
+			device_free(dev);
+			continue;
+		}
+		type_link(dev);
+	}
+
+	fclose(fp);
+	registry_unlock(lock);
+	return 0;
+}
+
+void usb_device_fini(void)
+{
+	if (devices == NULL)
+		return;
+
+	eina_hash_free(devices);
+	devices = NULL;
+	eina_shutdown();
+}
+
+static Eina_Bool save_one(const Eina_Hash *hash, const void *key,
+			  void *data, void *fdata)
+{
+	struct usb_device *dev = data;
+
+	FILE *fp = fdata;
+
+	fprintf(fp, "%d %d ", dev->type, dev->priv_id);
+	put_escaped(fp, dev->key);
+	fputc('\t', fp);
+	put_escaped(fp, dev->name);
+	fputc('\t', fp);
+	put_escaped(fp, dev->path);
+	fputc('\n', fp);
+	return EINA_TRUE;
+}
+
+/* Write the registry beside the old one and rename it into place */
+int usb_device_save(void)
+{
+	char tmp[PATH_MAX + 16];
+	FILE *fp;
+	int lock, fd, ret;
+
+	if (devices == NULL)
+		return -1;
+
+	lock = registry_lock(LOCK_EX);
+	if (lock < 0)
+		return -1;
+
+	if (eina_hash_population(devices) == 0) {
+		ret = unlink(reg_file);
+		registry_unlock(lock);
+		return ret;
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.%d", reg_file, getpid());
+	unlink(tmp);
+	fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+	fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (fp == NULL) {
+		if (fd >= 0)
+			close(fd);
+		registry_unlock(lock);
+		return -1;
+	}
+
+	eina_hash_foreach(devices, save_one, fp);
+	if (fclose(fp) != 0) {
+		unlink(tmp);
+		registry_unlock(lock);
+		return -1;
+	}
+
+	ret = rename(tmp, reg_file);
+	registry_unlock(lock);
+	return ret;
+}
+
+/* Register a device, replacing an old entry with the same key */
+struct usb_device *usb_device_add(int type, const char *key,
+				  const char *name, const char *path)
+{
+	struct usb_device *dev;
+
+	if (devices == NULL || key == NULL)
+		return NULL;
+
+	dev = device_new(type, -1, key, name, path);
+	if (dev == NULL)
+		return NULL;
+
+	eina_hash_del_by_key(devices, key);
+	if (!eina_hash_add(devices, dev->key, dev)) {
+		device_free(dev);
+		return NULL;
+	}
+	type_link(dev);
+
+	return dev;
+}
+
+struct usb_device *usb_device_find(const char *key)
+{
+	if (devices == NULL || key == NULL)
+		return NULL;
+
+	return eina_hash_find(devices, key);
+}
+
+/* Newest device of a type, for requests that do not name the device */
+struct usb_device *usb_device_find_type(int type)
+{
+	if (type < 0 || type >= USB_DEV_MAX)
+		return NULL;
+
+	return eina_list_data_get(eina_list_last(by_type[type]));
+}
+
+void usb_device_del(struct usb_device *dev)
+{
+	if (devices == NULL || dev == NULL)
+		return;
+
+	eina_hash_del_by_key(devices, dev->key);
+}
+
+int usb_device_count(void)
+{
+	if (devices == NULL)
+		return 0;
+
+	return eina_hash_population(devices);
+}
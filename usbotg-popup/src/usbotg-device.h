@@ -0,0 +1,58 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_usbotg_device_H_
+#define __DEF_usbotg_device_H_
+
+/*
+ * Devices outlive the popup process but not a reboot, so the registry
+ * is kept on tmpfs: below $XDG_RUNTIME_DIR, which exists and belongs to
+ * the user the popup runs as, or in USB_DEVICE_DIR without it. Either
+ * directory is used only when that user owns it and nobody else can
+ * write to it. Names and paths are stored with %XX escapes.
+ */
+#define USB_DEVICE_RUNTIME_ENV	"XDG_RUNTIME_DIR"
+#define USB_DEVICE_SUBDIR	"usbotg-popup"
+#define USB_DEVICE_DIR		"/run/" USB_DEVICE_SUBDIR
+#define USB_DEVICE_FILE		"devices"
+
+enum {
+	USB_DEV_STORAGE = 0,
+	USB_DEV_CAMERA,
+	USB_DEV_MAX
+};
+
+/* One connected device, keyed by mount path or device name */
+struct usb_device {
+	int type;
+	int priv_id;			/* notification of this device */
+	char *key;
+	char *name;
+	char *path;
+};
+
+int usb_device_init(void);
+void usb_device_fini(void);
+struct usb_device *usb_device_add(int type, const char *key,
+				  const char *name, const char *path);
+struct usb_device *usb_device_find(const char *key);
+struct usb_device *usb_device_find_type(int type);
+void usb_device_del(struct usb_device *dev);
+int usb_device_count(void);
+int usb_device_save(void);
+
+#endif				/* __DEF_usbotg_device_H__ */
@@ -0,0 +1,633 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Background walk of a newly mounted USB storage.
+ *
+ * The walk runs in a low priority thread, lists every directory breadth
+ * first and stats its entries so that dentries and inodes are cached by
+ * the time the file browser opens. Directories are recorded in an index
+ * file named after the volume UUID. An interrupted walk continues from
+ * the pending directories on the next connect, and a finished one only
+ * lists again the directories whose mtime changed. Each mount gets a walk
+ * of its own, up to PREFETCH_MAX_WALKS at a time.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include "usbotg-prefetch.h"
+#include "popup-log.h"
+
+#define INDEX_MAGIC		0x58444955	/* "UIDX" */
+#define INDEX_VERSION		1
+#define UUID_LEN		40
+#define HASH_BUCKETS		1024	/* power of two */
+
+#define IOPRIO_CLASS_SHIFT	13
+#define IOPRIO_CLASS_IDLE	3
+#define IOPRIO_WHO_PROCESS	1
+
+struct index_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t complete;
+	uint32_t ndirs;
+	char uuid[UUID_LEN];
+};
+
+/* One directory of the volume, path relative to the mount point */
+struct dir_rec {
+	int64_t mtime;
+	uint32_t nent;
+	uint16_t done;
+	uint16_t len;
+	char *path;
+};
+
+struct prefetch {
+	pthread_t thread;
+	int refs;			/* main thread and walk thread */
+	int finished;			/* set by the walk thread */
+	int stop;			/* set by the main thread */
+	char root[PATH_MAX];
+	char uuid[UUID_LEN];
+	char index[PATH_MAX];
+
+	struct dir_rec *dirs;
+	int ndirs;
+	int complete;
+	int bucket[HASH_BUCKETS];	/* first record + 1 per path hash */
+	int *chain;			/* next record + 1 in the bucket */
+
+	/* Walk statistics */
+	int listed;
+	int skipped;
+	long stats;
+};
+
+static struct prefetch *walks[PREFETCH_MAX_WALKS];
+static int exit_hooked = 0;
+
+static int stopping(struct prefetch *p)
+{
+	return __atomic_load_n(&p->stop, __ATOMIC_RELAXED);
+}
+
+/* Lowest CPU and idle I/O priority for the calling thread */
+static void lower_priority(void)
+{
+	pid_t tid = syscall(SYS_gettid);
+
+	setpriority(PRIO_PROCESS, tid, 19);
+	syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid,
+		IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+}
+
+/* Source device of a mount point from mountinfo */
+static int mount_source(const char *root, char *dev, size_t len)
+{
+	FILE *fp;
+	char line[1024];
+	char mnt[PATH_MAX];
+	char *sep;
+	int found = -1;
+
+	fp = fopen("/proc/self/mountinfo", "r");
+	if (fp == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%*d %*d %*s %*s %4095s", mnt) != 1)
+			continue;
+		if (strcmp(mnt, root))
+			continue;
+		sep = strstr(line, " - ");
+		if (sep && sscanf(sep, " - %*s %4095s", mnt) == 1) {
+			snprintf(dev, len, "%s", mnt);
+			found = 0;
+		}
+	}
+
+	fclose(fp);
+	return found;
+}
+
+/* Volume UUID of the mount, file system id when udev has none */
+static void volume_uuid(const char *root, char *uuid, size_t len)
+{
+	char dev[PATH_MAX];
+	char link[PATH_MAX];
+	char real[PATH_MAX];
+	struct dirent *de;
+	struct statvfs sv;
+	DIR *dir;
+
+	if (mount_source(root, dev, sizeof(dev)) == 0 &&
+	    realpath(dev, real) != NULL) {
+		dir = opendir("/dev/disk/by-uuid");
+		while (dir && (de = readdir(dir))) {
+			if (de->d_name[0] == '.')
+				continue;
+			snprintf(link, sizeof(link), "/dev/disk/by-uuid/%s",
+				 de->d_name);
+			if (realpath(link, dev) && !strcmp(dev, real) &&
+			    snprintf(uuid, len, "%s", de->d_name) < (int)len) {
+				closedir(dir);
+				return;
+			}
+		}
+		if (dir)
+			closedir(dir);
+	}
+
+	if (statvfs(root, &sv) == 0)
+		snprintf(uuid, len, "fsid-%lx", (unsigned long)sv.f_fsid);
+	else
+		snprintf(uuid, len, "unknown");
+}
+
+static int64_t mtime_ns(const struct stat *st)
+{
+	return (int64_t)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+}
+
+static unsigned int path_hash(const char *path, size_t len)
+{
+	unsigned int h = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ (unsigned char)path[i]) * 16777619u;
+	return h & (HASH_BUCKETS - 1);
+}
+
+static int path_depth(const struct dir_rec *d)
+{
+	int depth = d->len ? 1 : 0;
+	int i;
+
+	for (i = 0; i < d->len; i++) {
+		if (d->path[i] == '/')
+			depth++;
+	}
+	return depth;
+}
+
+static struct dir_rec *find_dir(struct prefetch *p, const char *path, size_t len)
+{
+	int i;
+
+	for (i = p->bucket[path_hash(path, len)]; i; i = p->chain[i - 1]) {
+		if (p->dirs[i - 1].len == len &&
+		    !memcmp(p->dirs[i - 1].path, path, len))
+			return &p->dirs[i - 1];
+	}
+	return NULL;
+}
+
+static struct dir_rec *add_dir(struct prefetch *p, const char *path, size_t len)
+{
+	struct dir_rec *d;
+	unsigned int h;
+
+	if (p->ndirs >= PREFETCH_MAX_DIRS)
+		return NULL;
+
+	if (p->dirs == NULL) {
+		p->dirs = calloc(PREFETCH_MAX_DIRS, sizeof(*p->dirs));
+		p->chain = calloc(PREFETCH_MAX_DIRS, sizeof(*p->chain));
+		if (p->dirs == NULL || p->chain == NULL) {
+			free(p->dirs);
+			free(p->chain);
+			p->dirs = NULL;
+			p->chain = NULL;
+			return NULL;
+		}
+	}
+
+	d = &p->dirs[p->ndirs];
+	d->path = strndup(path, len);
+	if (d->path == NULL)
+		return NULL;
+	d->len = len;
+	d->mtime = 0;
+	d->nent = 0;
+	d->done = 0;
+
+	h = path_hash(path, len);
+	p->chain[p->ndirs] = p->bucket[h];
+	p->bucket[h] = ++p->ndirs;
+
+	return d;
+}
+
+static void free_dirs(struct prefetch *p)
+{
+	int i;
+
+	for (i = 0; i < p->ndirs; i++)
+		free(p->dirs[i].path);
+	free(p->dirs);
+	free(p->chain);
+	p->dirs = NULL;
+	p->chain = NULL;
+	p->ndirs = 0;
+	memset(p->bucket, 0, sizeof(p->bucket));
+}
+
+static int load_index(struct prefetch *p)
+{
+	struct index_hdr hdr;
+	struct dir_rec rec, *d;
+	char path[PATH_MAX];
+	uint32_t i;
+	FILE *fp;
+
+	fp = fopen(p->index, "rb");
+	if (fp == NULL)
+		return -1;
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    hdr.magic != INDEX_MAGIC || hdr.version != INDEX_VERSION ||
+	    strncmp(hdr.uuid, p->uuid, UUID_LEN)) {
+		fclose(fp);
+		return -1;
+	}
+
+	for (i = 0; i < hdr.ndirs; i++) {
+		if (fread(&rec.mtime, sizeof(rec.mtime), 1, fp) != 1 ||
+		    fread(&rec.nent, sizeof(rec.nent), 1, fp) != 1 ||
+		    fread(&rec.done, sizeof(rec.done), 1, fp) != 1 ||
+		    fread(&rec.len, sizeof(rec.len), 1, fp) != 1 ||
+		    rec.len >= sizeof(path) ||
+		    fread(path, 1, rec.len, fp) != rec.len)
+			break;
+		d = add_dir(p, path, rec.len);
+		if (d == NULL)
+			break;
+		d->mtime = rec.mtime;
+		d->nent = rec.nent;
+		d->done = rec.done;
+	}
+
+	p->complete = hdr.complete && i == hdr.ndirs;
+	fclose(fp);
+	return 0;
+}
+
+/* Write the index beside the old one and rename it into place */
+static int save_index(struct prefetch *p)
+{
+	struct index_hdr hdr;
+	char tmp[PATH_MAX + 32];
+	FILE *fp;
+	int i;
+
+	mkdir(PREFETCH_INDEX_DIR, 0755);
+	/* A detached walk of the same volume may still be saving */
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", p->index,
+		 (long)syscall(SYS_gettid));
+	fp = fopen(tmp, "wb");
+	if (fp == NULL)
+		return -1;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = INDEX_MAGIC;
+	hdr.version = INDEX_VERSION;
+	hdr.complete = p->complete;
+	hdr.ndirs = p->ndirs;
+	memcpy(hdr.uuid, p->uuid, UUID_LEN);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	for (i = 0; i < p->ndirs; i++) {
+		fwrite(&p->dirs[i].mtime, sizeof(p->dirs[i].mtime), 1, fp);
+		fwrite(&p->dirs[i].nent, sizeof(p->dirs[i].nent), 1, fp);
+		fwrite(&p->dirs[i].done, sizeof(p->dirs[i].done), 1, fp);
+		fwrite(&p->dirs[i].len, sizeof(p->dirs[i].len), 1, fp);
+		fwrite(p->dirs[i].path, 1, p->dirs[i].len, fp);
+	}
+
+	if (fclose(fp) != 0) {
+		unlink(tmp);
+		return -1;
+	}
+
+	return rename(tmp, p->index);
+}
+
+/* List one directory, stat its entries and record new subdirectories */
+static void walk_dir(struct prefetch *p, struct dir_rec *d)
+{
+	char path[PATH_MAX];
+	char sub[PATH_MAX];
+	struct dirent *de;
+	struct stat st;
+	struct dir_rec *child;
+	DIR *dir;
+	int fd, len;
+	uint32_t nent = 0;
+
+	if (snprintf(path, sizeof(path), "%s/%s", p->root, d->path) >=
+	    (int)sizeof(path)) {
+		d->done = 1;
+		return;
+	}
+	fd = open(path, O_RDONLY | O_DIRECTORY | O_NOATIME);
+	if (fd < 0)
+		fd = open(path, O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		d->done = 1;
+		return;
+	}
+
+	dir = fdopendir(fd);
+	if (dir == NULL) {
+		close(fd);
+		d->done = 1;
+		return;
+	}
+
+	if (fstat(fd, &st) == 0)
+		d->mtime = mtime_ns(&st);
+
+	while (!stopping(p) && (de = readdir(dir))) {
+		if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+			continue;
+		nent++;
+		if (fstatat(fd, de->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0)
+			continue;
+		p->stats++;
+		if (!S_ISDIR(st.st_mode))
+			continue;
+
+		len = snprintf(sub, sizeof(sub), "%s%s%s", d->path,
+			       d->len ? "/" : "", de->d_name);
+		if (len <= 0 || len >= (int)sizeof(sub))
+			continue;
+		child = find_dir(p, sub, len);
+		if (child == NULL) {
+			add_dir(p, sub, len);
+		} else if (child->done && child->mtime != mtime_ns(&st)) {
+			child->done = 0;
+		}
+	}
+
+	closedir(dir);
+	if (!stopping(p)) {
+		d->nent = nent;
+		d->done = 1;
+		p->listed++;
+	}
+}
+
+/* Index files by age, oldest first */
+struct index_file {
+	time_t mtime;
+	char name[NAME_MAX + 1];
+};
+
+static int older(const void *a, const void *b)
+{
+	const struct index_file *x = a, *y = b;
+
+	return x->mtime < y->mtime ? -1 : x->mtime > y->mtime;
+}
+
+/* Keep only the most recently used volume indexes */
+static void prune_indexes(struct prefetch *p)
+{
+	struct index_file *files = NULL, *f;
+	struct dirent *de;
+	struct stat st;
+	size_t len;
+	int n = 0, i;
+	DIR *dir;
+
+	dir = opendir(PREFETCH_INDEX_DIR);
+	if (dir == NULL)
+		return;
+
+	while (!stopping(p) && (de = readdir(dir))) {
+		len = strlen(de->d_name);
+		if (len < 5 || strcmp(de->d_name + len - 4, ".idx"))
+			continue;
+		if (fstatat(dirfd(dir), de->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0)
+			continue;
+		f = realloc(files, (n + 1) * sizeof(*files));
+		if (f == NULL)
+			break;
+		files = f;
+		files[n].mtime = st.st_mtime;
+		snprintf(files[n].name, sizeof(files[n].name), "%s", de->d_name);
+		n++;
+	}
+
+	if (n > PREFETCH_MAX_INDEXES) {
+		qsort(files, n, sizeof(*files), older);
+		for (i = 0; i < n - PREFETCH_MAX_INDEXES; i++)
+			unlinkat(dirfd(dir), files[i].name, 0);
+	}
+
+	closedir(dir);
+	free(files);
+}
+
+static void prefetch_put(struct prefetch *p)
+{
+	if (__atomic_sub_fetch(&p->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		free_dirs(p);
+		free(p);
+	}
+}
+
+static void *prefetch_thread(void *data)
+{
+	struct prefetch *p = data;
+	struct stat st;
+	char path[PATH_MAX];
+	int i, since_save = 0;
+
+	lower_priority();
+
+	volume_uuid(p->root, p->uuid, sizeof(p->uuid));
+	snprintf(p->index, sizeof(p->index), "%s/%s.idx", PREFETCH_INDEX_DIR,
+		 p->uuid);
+	if (load_index(p) < 0 || p->ndirs == 0) {
+		free_dirs(p);
+		p->complete = 0;
+		add_dir(p, "", 0);
+	} else if (p->complete) {
+		/*
+		 * Only changed directories need listing again, apart from
+		 * the top levels the file browser shows first.
+		 */
+		for (i = 0; i < p->ndirs && !stopping(p); i++) {
+			if (snprintf(path, sizeof(path), "%s/%s", p->root,
+				     p->dirs[i].path) >= (int)sizeof(path))
+				continue;
+			if (stat(path, &st) == 0 && mtime_ns(&st) == p->dirs[i].mtime
+			    && path_depth(&p->dirs[i]) > PREFETCH_WARM_DEPTH)
+				p->skipped++;
+			else
+				p->dirs[i].done = 0;
+		}
+		p->complete = 0;
+	}
+
+	/* Records are appended in discovery order, so this is breadth first */
+	for (i = 0; i < p->ndirs && !stopping(p); i++) {
+		if (p->dirs[i].done)
+			continue;
+		walk_dir(p, &p->dirs[i]);
+		if (++since_save >= PREFETCH_SAVE_EVERY) {
+			save_index(p);
+			since_save = 0;
+		}
+	}
+
+	if (!stopping(p))
+		p->complete = 1;
+	save_index(p);
+
+	system_print("\n usbotg : prefetch %s %s, %d dirs listed, %d unchanged, %ld stats \n",
+		     p->uuid, p->complete ? "done" : "paused",
+		     p->listed, p->skipped, p->stats);
+
+	prune_indexes(p);
+	__atomic_store_n(&p->finished, 1, __ATOMIC_RELEASE);
+	prefetch_put(p);
+	return NULL;
+}
+
+/* Release the walks that have ended on their own */
+static void reap(void)
+{
+	struct prefetch *p;
+	int i;
+
+	for (i = 0; i < PREFETCH_MAX_WALKS; i++) {
+		p = walks[i];
+		if (p && __atomic_load_n(&p->finished, __ATOMIC_ACQUIRE)) {
+			pthread_join(p->thread, NULL);
+			prefetch_put(p);
+			walks[i] = NULL;
+		}
+	}
+}
+
+static void stop_all(void)
+{
+	usbotg_prefetch_stop(NULL);
+}
+
+/* Start the background walk of a new mount */
+int usbotg_prefetch_start(const char *mount_path)
+{
+	struct prefetch *p;
+	int i, slot = -1;
+
+	if (mount_path == NULL || strlen(mount_path) >= PATH_MAX)
+		return -1;
+
+	reap();
+	for (i = 0; i < PREFETCH_MAX_WALKS; i++) {
+		if (walks[i] == NULL) {
+			if (slot < 0)
+				slot = i;
+		} else if (strcmp(walks[i]->root, mount_path) == 0) {
+			return 0;
+		}
+	}
+	if (slot < 0) {
+		system_print("\n usbotg : %d walks running, %s not prefetched \n",
+			     PREFETCH_MAX_WALKS, mount_path);
+		return -1;
+	}
+
+	p = calloc(1, sizeof(*p));
+	if (p == NULL)
+		return -1;
+	snprintf(p->root, sizeof(p->root), "%s", mount_path);
+	p->refs = 2;
+
+	if (pthread_create(&p->thread, NULL, prefetch_thread, p) != 0) {
+		free(p);
+		return -1;
+	}
+
+	walks[slot] = p;
+	if (!exit_hooked) {
+		atexit(stop_all);
+		exit_hooked = 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Interrupt a walk and keep its progress for the next connect. A
+ * readdir on a slow device is not interruptible, so the main loop waits
+ * a bounded time and then leaves the thread to finish and free itself.
+ */
+static void stop_walk(struct prefetch *p)
+{
+	struct timespec ts;
+
+	__atomic_store_n(&p->stop, 1, __ATOMIC_RELAXED);
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_nsec += PREFETCH_STOP_MS * 1000000L;
+	ts.tv_sec += ts.tv_nsec / 1000000000L;
+	ts.tv_nsec %= 1000000000L;
+
+	if (pthread_timedjoin_np(p->thread, NULL, &ts) != 0) {
+		system_print("\n usbotg : prefetch %s still busy, detached \n",
+			     p->root);
+		pthread_detach(p->thread);
+	}
+	prefetch_put(p);
+}
+
+/* Stop the walk of mount_path, or every walk when it is NULL */
+void usbotg_prefetch_stop(const char *mount_path)
+{
+	struct prefetch *p;
+	int i;
+
+	for (i = 0; i < PREFETCH_MAX_WALKS; i++) {
+		p = walks[i];
+		if (p == NULL ||
+		    (mount_path && strcmp(p->root, mount_path) != 0))
+			continue;
+		walks[i] = NULL;
+		stop_walk(p);
+	}
+}
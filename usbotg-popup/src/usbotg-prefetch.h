@@ -0,0 +1,32 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_usbotg_prefetch_H_
+#define __DEF_usbotg_prefetch_H_
+
+#define PREFETCH_INDEX_DIR	"/opt/var/lib/usbotg-popup"
+#define PREFETCH_MAX_DIRS	4096	/* directories kept in one index */
+#define PREFETCH_SAVE_EVERY	64	/* directories between index saves */
+#define PREFETCH_WARM_DEPTH	1	/* levels always listed on connect */
+#define PREFETCH_MAX_INDEXES	16	/* volume indexes kept on disk */
+#define PREFETCH_STOP_MS	200	/* main loop wait for the walk to stop */
+#define PREFETCH_MAX_WALKS	4	/* mounts walked at the same time */
+
+int usbotg_prefetch_start(const char *mount_path);
+void usbotg_prefetch_stop(const char *mount_path);
+
+#endif				/* __DEF_usbotg_prefetch_H__ */
@@ -0,0 +1,488 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * USB hotplug monitor for usbotg-popup.
+ *
+ * Normally a daemon launches the popup once per device event. With
+ * db/private/system-popup/usb_monitor set, a resident usbotg reads kernel
+ * uevents itself. A socket filter drops everything but add and remove
+ * in the kernel, so the frequent change events (battery, thermal) never
+ * wake the process. Interface events are folded into their USB device,
+ * which is classified by the interface classes it exposes. The device is
+ * reported once it has been quiet for USBOTG_SETTLE_MS, and storage only
+ * once its block node is mounted or USBOTG_MOUNT_TRIES settles passed.
+ *
+ * With USBOTG_UEVENT_SOCKET set, uevents in the kernel format are read
+ * from a datagram socket at that path instead, the same filter attached.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/netlink.h>
+#include <linux/filter.h>
+#include <Ecore.h>
+#include "usbotg-uevent.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-timer.h"
+
+#define UEVENT_BUF	2048
+
+/* First bytes of the message, loaded big endian by the filter */
+#define WORD_ADD	0x61646440	/* "add@" */
+#define WORD_REMO	0x72656d6f	/* "remo" */
+#define WORD_VE_AT	0x7665402f	/* "ve@/" */
+
+struct hotplug_dev {
+	int used;
+	int kind;
+	int announced;
+	int tries;
+	char devpath[256];
+	char name[64];
+	char devname[32];		/* block node, storage only */
+	char path[256];			/* its mount point */
+	struct popup_timer settle;
+};
+
+struct monitor {
+	int running;
+	usbotg_uevent_cb cb;
+	void *data;
+	const char *root;
+	char sock_path[108];
+	int fd;
+	Ecore_Fd_Handler *handler;
+	struct hotplug_dev dev[USBOTG_MAX_DEVICES];
+};
+
+static struct monitor mon = { .fd = -1 };
+
+/* Keep "add@..." and "remove@/..." only */
+static struct sock_filter add_remove_code[] = {
+	BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),
+	BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, WORD_ADD, 3, 0),
+	BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, WORD_REMO, 0, 3),
+	BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 4),
+	BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, WORD_VE_AT, 0, 1),
+	BPF_STMT(BPF_RET | BPF_K, 0xffffffff),
+	BPF_STMT(BPF_RET | BPF_K, 0),
+};
+
+/* Split "ACTION@DEVPATH\0KEY=VALUE\0..." in place */
+int usbotg_uevent_parse(char *buf, size_t len, struct usbotg_uevent *ev)
+{
+	char *p = buf, *end = buf + len, *at;
+
+	memset(ev, 0, sizeof(*ev));
+	if (len == 0 || buf[len - 1] != '\0')
+		return -1;
+
+	at = strchr(p, '@');
+	if (at == NULL)
+		return -1;
+	p += strlen(p) + 1;
+
+	for (; p < end; p += strlen(p) + 1) {
+		if (strncmp(p, "ACTION=", 7) == 0)
+			ev->action = p + 7;
+		else if (strncmp(p, "DEVPATH=", 8) == 0)
+			ev->devpath = p + 8;
+		else if (strncmp(p, "SUBSYSTEM=", 10) == 0)
+			ev->subsystem = p + 10;
+		else if (strncmp(p, "DEVTYPE=", 8) == 0)
+			ev->devtype = p + 8;
+		else if (strncmp(p, "DEVNAME=", 8) == 0)
+			ev->devname = p + 8;
+		else if (strncmp(p, "INTERFACE=", 10) == 0)
+			ev->interface = p + 10;
+		else if (strncmp(p, "PRODUCT=", 8) == 0)
+			ev->product = p + 8;
+	}
+
+	/* Older kernels leave the header as the only source */
+	if (ev->action == NULL || ev->devpath == NULL) {
+		*at = '\0';
+		if (ev->action == NULL)
+			ev->action = buf;
+		if (ev->devpath == NULL)
+			ev->devpath = at + 1;
+	}
+
+	return ev->subsystem ? 0 : -1;
+}
+
+/* bInterfaceClass of "class/subclass/protocol", in decimal */
+int usbotg_uevent_classify(const char *interface)
+{
+	if (interface == NULL)
+		return USBOTG_KIND_NONE;
+
+	switch (atoi(interface)) {
+	case 8:			/* mass storage */
+		return USBOTG_KIND_STORAGE;
+	case 6:			/* still image, PTP cameras */
+		return USBOTG_KIND_CAMERA;
+	case 9:
+		return USBOTG_KIND_HUB;
+	default:
+		return USBOTG_KIND_UNKNOWN;
+	}
+}
+
+static struct hotplug_dev *find_exact(const char *devpath)
+{
+	int i;
+
+	for (i = 0; i < USBOTG_MAX_DEVICES; i++)
+		if (mon.dev[i].used && strcmp(mon.dev[i].devpath, devpath) == 0)
+			return &mon.dev[i];
+	return NULL;
+}
+
+/* The tracked device an interface or block node sits under */
+static struct hotplug_dev *find_owner(const char *devpath)
+{
+	size_t n;
+	int i;
+
+	for (i = 0; i < USBOTG_MAX_DEVICES; i++) {
+		if (!mon.dev[i].used)
+			continue;
+		n = strlen(mon.dev[i].devpath);
+		if (strncmp(mon.dev[i].devpath, devpath, n) == 0 &&
+		    devpath[n] == '/')
+			return &mon.dev[i];
+	}
+	return NULL;
+}
+
+static int read_attr(const char *devpath, const char *attr, char *buf,
+		     size_t size)
+{
+	char path[PATH_MAX];
+	ssize_t n;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s%s/%s", mon.root, devpath, attr);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	n = read(fd, buf, size - 1);
+	close(fd);
+	if (n <= 0)
+		return -1;
+
+	buf[n] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+	return buf[0] ? 0 : -1;
+}
+
+/* Product string descriptor, else the ids from the uevent */
+static void device_name(struct hotplug_dev *d, const struct usbotg_uevent *ev)
+{
+	const char *base;
+	char vid[8], pid[8];
+
+	if (read_attr(d->devpath, "product", d->name, sizeof(d->name)) == 0)
+		return;
+
+	if (ev->product && sscanf(ev->product, "%7[^/]/%7[^/]", vid, pid) == 2) {
+		snprintf(d->name, sizeof(d->name), "USB %s:%s", vid, pid);
+		return;
+	}
+
+	base = strrchr(d->devpath, '/');
+	base = base ? base + 1 : d->devpath;
+	snprintf(d->name, sizeof(d->name), "%s", base);
+}
+
+static int find_mount(const char *devname, char *path, size_t size)
+{
+	char line[512], dev[64], dir[256];
+	FILE *fp;
+	int ret = -1;
+
+	fp = fopen("/proc/mounts", "r");
+	if (fp == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%63s %255s", dev, dir) != 2 ||
+		    strncmp(dev, "/dev/", 5) != 0 || strcmp(dev + 5, devname) != 0)
+			continue;
+		snprintf(path, size, "%s", dir);
+		ret = 0;
+		break;
+	}
+	fclose(fp);
+	return ret;
+}
+
+static void report(struct hotplug_dev *d, int ev)
+{
+	struct usbotg_hotplug hp;
+
+	hp.kind = d->kind;
+	hp.devpath = d->devpath;
+	hp.name = d->name;
+	hp.path = d->path;
+
+	popup_stats_inc(POPUP_STAT_USB_HOTPLUG);
+	system_print("\n system-popup : usb %s %s kind %d (%s) \n",
+		     ev == USBOTG_EV_ADD ? "add" : "remove", d->devpath,
+		     d->kind, d->name);
+	mon.cb(ev, &hp, mon.data);
+}
+
+static void settle_cb(void *data)
+{
+	struct hotplug_dev *d = data;
+
+	if (d->kind == USBOTG_KIND_NONE)
+		d->kind = USBOTG_KIND_UNKNOWN;
+	if (d->kind == USBOTG_KIND_HUB)
+		return;
+
+	/* Storage is only useful once something mounted it */
+	if (d->kind == USBOTG_KIND_STORAGE && d->path[0] == '\0' &&
+	    (d->devname[0] == '\0' ||
+	     find_mount(d->devname, d->path, sizeof(d->path)) < 0) &&
+	    ++d->tries < USBOTG_MOUNT_TRIES) {
+		popup_timer_arm(&d->settle, USBOTG_SETTLE_MS, settle_cb, d);
+		return;
+	}
+
+	d->announced = 1;
+	report(d, USBOTG_EV_ADD);
+}
+
+static void touch(struct hotplug_dev *d)
+{
+	if (!d->announced)
+		popup_timer_arm(&d->settle, USBOTG_SETTLE_MS, settle_cb, d);
+}
+
+static void device_add(const struct usbotg_uevent *ev)
+{
+	struct hotplug_dev *d;
+	int i;
+
+	if (find_exact(ev->devpath))
+		return;
+
+	for (i = 0; i < USBOTG_MAX_DEVICES && mon.dev[i].used; i++)
+		;
+	if (i == USBOTG_MAX_DEVICES) {
+		system_print("\n system-popup : too many usb devices \n");
+		return;
+	}
+
+	d = &mon.dev[i];
+	memset(d, 0, sizeof(*d));
+	d->used = 1;
+	snprintf(d->devpath, sizeof(d->devpath), "%s", ev->devpath);
+	device_name(d, ev);
+	touch(d);
+}
+
+static void device_remove(const struct usbotg_uevent *ev)
+{
+	struct hotplug_dev *d = find_exact(ev->devpath);
+
+	if (d == NULL)
+		return;
+
+	popup_timer_cancel(&d->settle);
+	if (d->announced)
+		report(d, USBOTG_EV_REMOVE);
+	d->used = 0;
+}
+
+static void handle(const struct usbotg_uevent *ev)
+{
+	struct hotplug_dev *d;
+	int add = strcmp(ev->action, "add") == 0;
+	int kind;
+
+	if (strcmp(ev->subsystem, "usb") == 0) {
+		if (ev->devtype && strcmp(ev->devtype, "usb_device") == 0) {
+			if (add)
+				device_add(ev);
+			else
+				device_remove(ev);
+			return;
+		}
+
+		d = find_owner(ev->devpath);
+		if (d == NULL || !add)
+			return;
+		kind = usbotg_uevent_classify(ev->interface);
+		if (kind > d->kind)
+			d->kind = kind;
+		touch(d);
+	} else if (strcmp(ev->subsystem, "block") == 0 && add && ev->devname) {
+		d = find_owner(ev->devpath);
+		if (d == NULL)
+			return;
+
+		/* A partition wins over its disk */
+		if (d->devname[0] == '\0' ||
+		    (ev->devtype && strcmp(ev->devtype, "partition") == 0))
+			snprintf(d->devname, sizeof(d->devname), "%s",
+				 ev->devname);
+		touch(d);
+	}
+}
+
+static Eina_Bool uevent_cb(void *data, Ecore_Fd_Handler *h)
+{
+	struct usbotg_uevent ev;
+	char buf[UEVENT_BUF];
+	ssize_t n;
+
+	while ((n = recv(mon.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+		popup_stats_inc(POPUP_STAT_USB_UEVENT);
+		if (usbotg_uevent_parse(buf, n, &ev) == 0)
+			handle(&ev);
+	}
+	return ECORE_CALLBACK_RENEW;
+}
+
+static int attach_filter(int fd)
+{
+	struct sock_fprog prog;
+
+	prog.len = sizeof(add_remove_code) / sizeof(add_remove_code[0]);
+	prog.filter = add_remove_code;
+	return setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog));
+}
+
+static int netlink_open(void)
+{
+	struct sockaddr_nl sa;
+	int fd;
+
+	fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+		    NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+		return -1;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.nl_family = AF_NETLINK;
+	sa.nl_groups = 1;		/* kernel events */
+	if (attach_filter(fd) < 0 ||
+	    bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int inject_open(const char *path)
+{
+	struct sockaddr_un sa;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", path);
+	unlink(path);
+	if (attach_filter(fd) < 0 ||
+	    bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	snprintf(mon.sock_path, sizeof(mon.sock_path), "%s", path);
+	return fd;
+}
+
+int usbotg_uevent_start(usbotg_uevent_cb cb, void *data)
+{
+	const char *path;
+
+	if (mon.running)
+		return 0;
+
+	mon.root = getenv(USBOTG_SYSFS_ENV);
+	if (mon.root == NULL || mon.root[0] == '\0')
+		mon.root = USBOTG_SYSFS_ROOT;
+	mon.cb = cb;
+	mon.data = data;
+	mon.sock_path[0] = '\0';
+	memset(mon.dev, 0, sizeof(mon.dev));
+
+	path = getenv(USBOTG_UEVENT_ENV);
+	if (path && path[0])
+		mon.fd = inject_open(path);
+	else
+		mon.fd = netlink_open();
+	if (mon.fd < 0) {
+		system_print("\n system-popup : uevent socket failed \n");
+		return -1;
+	}
+
+	mon.handler = ecore_main_fd_handler_add(mon.fd, ECORE_FD_READ,
+						uevent_cb, NULL, NULL, NULL);
+	if (mon.handler == NULL) {
+		close(mon.fd);
+		mon.fd = -1;
+		return -1;
+	}
+
+	system_print("\n system-popup : watching usb hotplug%s%s \n",
+		     mon.sock_path[0] ? " on " : "", mon.sock_path);
+	mon.running = 1;
+	return 0;
+}
+
+int usbotg_uevent_running(void)
+{
+	return mon.running;
+}
+
+void usbotg_uevent_stop(void)
+{
+	int i;
+
+	if (!mon.running)
+		return;
+
+	for (i = 0; i < USBOTG_MAX_DEVICES; i++)
+		popup_timer_cancel(&mon.dev[i].settle);
+	memset(mon.dev, 0, sizeof(mon.dev));
+
+	ecore_main_fd_handler_del(mon.handler);
+	mon.handler = NULL;
+	close(mon.fd);
+	mon.fd = -1;
+	if (mon.sock_path[0])
+		unlink(mon.sock_path);
+	mon.running = 0;
+}
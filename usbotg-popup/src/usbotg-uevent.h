@@ -0,0 +1,74 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef __DEF_usbotg_uevent_H_
+#define __DEF_usbotg_uevent_H_
+
+#include <stddef.h>
+
+#define USBOTG_SYSFS_ROOT	"/sys"
+#define USBOTG_SYSFS_ENV	"USBOTG_SYSFS_ROOT"	/* fake tree */
+#define USBOTG_UEVENT_ENV	"USBOTG_UEVENT_SOCKET"	/* injected uevents */
+
+#define USBOTG_SETTLE_MS	300	/* quiet time before a device counts */
+#define USBOTG_MOUNT_TRIES	10	/* settle periods to wait for a mount */
+#define USBOTG_MAX_DEVICES	8
+
+/* What a device is, from its interface descriptors */
+enum {
+	USBOTG_KIND_NONE = 0,
+	USBOTG_KIND_HUB,
+	USBOTG_KIND_UNKNOWN,
+	USBOTG_KIND_CAMERA,
+	USBOTG_KIND_STORAGE,
+};
+
+enum {
+	USBOTG_EV_ADD,
+	USBOTG_EV_REMOVE,
+};
+
+/* Fields of one kernel uevent, pointing into the receive buffer */
+struct usbotg_uevent {
+	const char *action;
+	const char *devpath;
+	const char *subsystem;
+	const char *devtype;
+	const char *devname;
+	const char *interface;		/* class/subclass/protocol */
+	const char *product;		/* vid/pid/bcd */
+};
+
+/* One settled device, handed to the callback */
+struct usbotg_hotplug {
+	int kind;
+	const char *devpath;
+	const char *name;
+	const char *path;		/* mount point, storage only */
+};
+
+typedef void (*usbotg_uevent_cb)(int ev, const struct usbotg_hotplug *hp,
+				 void *data);
+
+int usbotg_uevent_parse(char *buf, size_t len, struct usbotg_uevent *ev);
+int usbotg_uevent_classify(const char *interface);
+
+int usbotg_uevent_start(usbotg_uevent_cb cb, void *data);
+int usbotg_uevent_running(void);
+void usbotg_uevent_stop(void);
+
+#endif				/* __DEF_usbotg_uevent_H__ */
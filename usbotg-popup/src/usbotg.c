@@ -29,6 +29,19 @@
 #include <notification.h>
 #include <syspopup_caller.h>
 #include <appsvc.h>
+#include "popup-dispatch.h"
+#include "usbotg-prefetch.h"
+#include "usbotg-device.h"
+#include "usbotg-uevent.h"
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-screen.h"
+#include "popup-x.h"
+#include "popup-pool.h"
+#include "popup-vconf.h"
+#include "popup-memprof.h"
+#include "popup-font.h"
 
 #define APPLICATION_BG		1
 #define INDICATOR_HEIGHT	(38)	/* the case of 480*800 */
@@ -52,13 +65,25 @@
 
 #define GALLERY_APP_NAME	"org.tizen.gallery"
 #define MYFILE_APP_NAME		"org.tizen.myfile"
-#define CAMERA_DEVICE	1
-
-static int connected_device = 0;
-static char *otg_path = NULL;
 
+int usbotg_start(void *data);
 int unknown_usb_noti(int option);
-int camera_noti(int option, char* device_name);
+int camera_noti(int option, struct usb_device *dev);
+int otg_noti(int option, struct usb_device *dev);
+static int usbotg_monitor_wanted(void);
+static int usbotg_monitor_begin(struct appdata *ad);
+
+enum {
+	OPT_UNKNOWN_ADD,
+	OPT_UNKNOWN_REMOVE,
+	OPT_CAMERA_ADD,
+	OPT_CAMERA_REMOVE,
+	OPT_OTG_ADD,
+	OPT_OTG_REMOVE,
+};
+
+/* Option handled by notification only, no popup window */
+#define OPT_NOTI_ONLY	0x1
 
 int myterm(bundle *b, void *data)
 {
@@ -133,15 +158,18 @@ static Evas_Object *create_win(const char *name)
 	Evas_Object *eo;
 	int w, h;
 
-	eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC);
+	POPUP_X("elm_win_add", eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC));
 	if (eo) {
 		elm_win_title_set(eo, name);
 		elm_win_borderless_set(eo, EINA_TRUE);
 		evas_object_smart_callback_add(eo, "delete,request", win_del, NULL);
 		elm_win_alpha_set(eo, EINA_TRUE);
-		ecore_x_window_size_get(ecore_x_window_root_first_get(), &w,
-				&h);
+		/* Cached geometry, no round trip on a warm start */
+		popup_screen_get(&w, &h, NULL);
 		evas_object_resize(eo, w, h);
+
+		/* Queued ahead of the map request */
+		popup_x_prepare(eo, 0);
 	}
 
 	return eo;
@@ -174,6 +202,8 @@ static int app_terminate(void *data)
 {
 	struct appdata *ad = data;
 
+	usbotg_uevent_stop();
+
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
 
@@ -196,63 +226,202 @@ static int app_resume(void *data)
 }
 
 
+/* Option handlers, return DEVICE_REMOVED when no popup is needed */
+static int opt_unknown_add(void *data, bundle *b)
+{
+	unknown_usb_noti(DEVICE_ADDED);
+	return DEVICE_ADDED;
+}
+
+static int opt_unknown_remove(void *data, bundle *b)
+{
+	unknown_usb_noti(DEVICE_REMOVED);
+	return DEVICE_REMOVED;
+}
+
+/* Forget a device, only its own notification is removed */
+static void device_removed(struct appdata *ad, struct usb_device *dev,
+			   int (*noti)(int, struct usb_device *))
+{
+	if (dev == NULL) {
+		/* Devices connected before the registry existed */
+		if (usb_device_count() == 0)
+			noti(DEVICE_REMOVED, NULL);
+		return;
+	}
+
+	noti(DEVICE_REMOVED, dev);
+	if (ad->dev == dev)
+		ad->dev = NULL;
+	usb_device_del(dev);
+	usb_device_save();
+	popup_stats_gauge_set(POPUP_GAUGE_DEVICES, usb_device_count());
+}
+
+/* Record a new device and post its notification */
+static int device_added(struct appdata *ad, int type, const char *key,
+			const char *name, const char *path,
+			int (*noti)(int, struct usb_device *))
+{
+	struct usb_device *dev;
+
+	dev = usb_device_find(key);
+	if (dev)
+		noti(DEVICE_REMOVED, dev);
+	dev = usb_device_add(type, key, name, path);
+	if (dev == NULL)
+		return DEVICE_REMOVED;
+
+	noti(DEVICE_ADDED, dev);
+	usb_device_save();
+	popup_stats_gauge_set(POPUP_GAUGE_DEVICES, usb_device_count());
+	ad->dev = dev;
+	return DEVICE_ADDED;
+}
+
+/* Stop the walk below a mount that went away, not another device's */
+static void usbotg_walks_stop(const char *path)
+{
+	if (path == NULL || path[0] == '\0')
+		return;
+	usbotg_prefetch_stop(path);
+}
+
+static int opt_camera_add(void *data, bundle *b)
+{
+	const char *name = bundle_get_val(b, "device_name");
+	const char *path = bundle_get_val(b, "path");
+
+	return device_added(data, USB_DEV_CAMERA, name, name, path,
+			    camera_noti);
+}
+
+static int opt_camera_remove(void *data, bundle *b)
+{
+	const char *name = bundle_get_val(b, "device_name");
+	struct usb_device *dev;
+
+	dev = name ? usb_device_find(name) : usb_device_find_type(USB_DEV_CAMERA);
+	device_removed(data, dev, camera_noti);
+	return DEVICE_REMOVED;
+}
+
+static int opt_otg_add(void *data, bundle *b)
+{
+	const char *path = bundle_get_val(b, "path");
+	const char *name;
+
+	name = strrchr(path, '/');
+	name = name ? name + 1 : path;
+
+	if (device_added(data, USB_DEV_STORAGE, path, name, path,
+			 otg_noti) != DEVICE_ADDED)
+		return DEVICE_REMOVED;
+
+	/* Warm the new mount while the user decides */
+	if (usbotg_prefetch_start(path) < 0)
+		system_print("\n system-popup : Prefetch not started \n");
+	return DEVICE_ADDED;
+}
+
+static int opt_otg_remove(void *data, bundle *b)
+{
+	const char *path = bundle_get_val(b, "path");
+	struct usb_device *dev;
+
+	dev = path ? usb_device_find(path) : usb_device_find_type(USB_DEV_STORAGE);
+	/* Without a path it is the last storage device we know of */
+	if (path)
+		usbotg_walks_stop(path);
+	else
+		usbotg_prefetch_stop(dev ? dev->path : NULL);
+	device_removed(data, dev, otg_noti);
+	return DEVICE_REMOVED;
+}
+
+/* Launch options, placed by option hash */
+#define USBOTG_OPTS(X)							\
+	X("unknown_add", 'u', 'd', OPT_UNKNOWN_ADD,			\
+	  opt_unknown_add, OPT_NOTI_ONLY, NULL)				\
+	X("unknown_remove", 'u', 'e', OPT_UNKNOWN_REMOVE,		\
+	  opt_unknown_remove, OPT_NOTI_ONLY, NULL)			\
+	X("camera_add", 'c', 'd', OPT_CAMERA_ADD,			\
+	  opt_camera_add, 0, "device_name")				\
+	X("camera_remove", 'c', 'e', OPT_CAMERA_REMOVE,		\
+	  opt_camera_remove, 0, NULL)					\
+	X("otg_add", 'o', 'd', OPT_OTG_ADD,				\
+	  opt_otg_add, 0, "path")					\
+	X("otg_remove", 'o', 'e', OPT_OTG_REMOVE,			\
+	  opt_otg_remove, 0, NULL)
+
+POPUP_OPT_TABLE(usbotg_opts, USBOTG_OPTS);
+
 /* Reset */
 static int app_reset(bundle *b, void *data)
 {
 	struct appdata *ad = data;
+	const struct popup_opt *entry = NULL;
 	int removenoti = -1;
-	char *opt = NULL;
+	int ret;
 
-	opt = bundle_get_val(b, "_SYSPOPUP_CONTENT_");
-	if (!strcmp(opt,"unknown_add")) {
-		unknown_usb_noti(DEVICE_ADDED);
-	} else if (!strcmp(opt,"unknown_remove")) {
-		unknown_usb_noti(DEVICE_REMOVED);
-	} else {
-		if(!strcmp(opt,"camera_add")) {
-			connected_device = CAMERA_DEVICE;
-			camera_noti(DEVICE_ADDED, bundle_get_val(b, "device_name"));
-		} else if (!strcmp(opt,"camera_remove")) {
-			camera_noti(DEVICE_REMOVED, NULL);
-			removenoti = DEVICE_REMOVED;
-		} else if (!strcmp(opt,"otg_add")) {
-			otg_path = bundle_get_val(b, "path");
-			otg_noti(DEVICE_ADDED, (strrchr(otg_path, '/')+1));
-		} else if (!strcmp(opt,"otg_remove")) {
-			otg_noti(DEVICE_REMOVED, NULL);
-			removenoti = DEVICE_REMOVED;
-		}
-
-		if (syspopup_has_popup(b)) {
-			if (removenoti == DEVICE_REMOVED)
-				return 0;
-			syspopup_reset(b);
-		} else {
-			if (removenoti == DEVICE_REMOVED)
+	popup_stats_inc(POPUP_STAT_LAUNCH);
+
+	/* The resident monitor sees every device itself */
+	if (usbotg_uevent_running()) {
+		system_print("\n system-popup : launch left to the monitor \n");
+		return 0;
+	}
+
+	ret = popup_dispatch(usbotg_opts, b, ad, &entry, &removenoti);
+	if (ret != POPUP_DISPATCH_OK) {
+		system_print("\n system-popup : Rejected request (%d) \n", ret);
+		if (!syspopup_has_popup(b)) {
+			/* Nothing to show, stay only to watch hotplug */
+			if (!usbotg_monitor_wanted())
 				exit(0);
 			syspopup_create(b, &handler, ad->win_main, ad);
-			evas_object_show(ad->win_main);
+			if (usbotg_monitor_begin(ad) < 0)
+				exit(0);
+		}
+		return 0;
+	}
+
+	if (entry->flags & OPT_NOTI_ONLY) {
+		usbotg_monitor_begin(ad);
+		return 0;
+	}
 
-			/* Start Main UI */
+	if (syspopup_has_popup(b)) {
+		if (removenoti == DEVICE_REMOVED)
+			return 0;
+		syspopup_reset(b);
+
+		/* Show the lingering window again */
+		if (popup_linger_reuse()) {
+			evas_object_show(ad->win_main);
 			usbotg_start((void *)ad);
 		}
+	} else {
+		if (removenoti == DEVICE_REMOVED) {
+			if (!usbotg_monitor_wanted())
+				exit(0);
+			syspopup_create(b, &handler, ad->win_main, ad);
+			if (usbotg_monitor_begin(ad) < 0)
+				exit(0);
+			return 0;
+		}
+		POPUP_X("syspopup_create",
+			syspopup_create(b, &handler, ad->win_main, ad));
+		POPUP_X("win_show", evas_object_show(ad->win_main));
+
+		/* Start Main UI */
+		usbotg_start((void *)ad);
+		usbotg_monitor_begin(ad);
 	}
 
 	return 0;
 }
 
-/* Customized print */
-void system_print(const char *format, ...)
-{
-	/* Un-comment return to disable logs */
-	//return;
-
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-}
-
 /* Cleanup objects to avoid mem-leak */
 void usbotg_cleanup(struct appdata *ad)
 {
@@ -260,39 +429,138 @@ void usbotg_cleanup(struct appdata *ad)
 		return;
 
 	if (ad->popup)
-		evas_object_del(ad->popup);
+		popup_pool_put(ad->popup);
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
+	ad->popup = NULL;
+	ad->layout_main = NULL;
+}
+
+static void usbotg_release(void *data)
+{
+	usbotg_cleanup(data);
+}
+
+/* Offer a device found by the monitor, replacing any popup shown */
+static void usbotg_offer(struct appdata *ad)
+{
+	if (ad->popup)
+		usbotg_cleanup(ad);
+	else
+		popup_linger_reuse();
+	evas_object_show(ad->win_main);
+	usbotg_start(ad);
+}
+
+/* Drop a device the monitor saw leave, and the popup offering it */
+static void usbotg_gone(struct appdata *ad, const char *key,
+			int (*noti)(int, struct usb_device *))
+{
+	struct usb_device *dev = usb_device_find(key);
+	int offered;
+
+	if (dev == NULL)
+		return;
+
+	offered = ad->dev == dev;
+	device_removed(ad, dev, noti);
+	if (offered && ad->popup)
+		popup_linger_dismiss(ad->win_main, usbotg_release, ad);
+}
+
+/* Hotplug from the monitor, handled as the matching launch would be */
+static void usbotg_hotplug(int ev, const struct usbotg_hotplug *hp, void *data)
+{
+	struct appdata *ad = data;
+
+	switch (hp->kind) {
+	case USBOTG_KIND_CAMERA:
+		if (ev == USBOTG_EV_REMOVE) {
+			usbotg_walks_stop(hp->path);
+			usbotg_gone(ad, hp->devpath, camera_noti);
+		} else if (device_added(ad, USB_DEV_CAMERA, hp->devpath,
+					hp->name, hp->path, camera_noti) == DEVICE_ADDED) {
+			usbotg_offer(ad);
+		}
+		break;
+	case USBOTG_KIND_STORAGE:
+		if (ev == USBOTG_EV_REMOVE) {
+			usbotg_walks_stop(hp->path);
+			usbotg_gone(ad, hp->devpath, otg_noti);
+			break;
+		}
+		if (device_added(ad, USB_DEV_STORAGE, hp->devpath, hp->name,
+				 hp->path[0] ? hp->path : USB_MOUNT_PATH,
+				 otg_noti) != DEVICE_ADDED)
+			break;
+		if (hp->path[0] && usbotg_prefetch_start(hp->path) < 0)
+			system_print("\n system-popup : Prefetch not started \n");
+		usbotg_offer(ad);
+		break;
+	default:
+		unknown_usb_noti(ev == USBOTG_EV_ADD ? DEVICE_ADDED : DEVICE_REMOVED);
+		break;
+	}
+}
+
+/* The usb_monitor key asks for a resident monitor */
+static int usbotg_monitor_wanted(void)
+{
+	int val = 0;
+
+	return popup_vconf_get(POPUP_VCONF_USB_MONITOR, &val) == 0 && val;
+}
+
+/* Stay resident and watch hotplug if the key asks for it */
+static int usbotg_monitor_begin(struct appdata *ad)
+{
+	if (usbotg_uevent_running())
+		return 0;
+	if (!usbotg_monitor_wanted())
+		return -1;
+
+	popup_linger_resident(1);
+	if (usbotg_uevent_start(usbotg_hotplug, ad) < 0) {
+		popup_linger_resident(0);
+		return -1;
+	}
+	return 0;
 }
 
 /* Background clicked noti */
 void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
+	struct appdata *ad = data;
+
 	system_print("\n system-popup : In BG Noti \n");
 	fflush(stdout);
-	exit(0);
+	popup_stats_inc(POPUP_STAT_CHOICE_CANCEL);
+	popup_linger_dismiss(ad->win_main, usbotg_release, ad);
 }
 
 /* Browse clicked noti */
 void browse_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
 	system_print("\n system-popup : Bwose Noti \n");
+	popup_stats_inc(POPUP_STAT_CHOICE_OK);
 
+	struct appdata *ad = data;
+	struct usb_device *dev = ad ? ad->dev : NULL;
 	int ret;
 	bundle *b;
 	b = bundle_create();
 
 	// TO DO
 	// launch my files with option
-	if (connected_device == CAMERA_DEVICE) {
+	if (dev && dev->type == USB_DEV_CAMERA) {
 		appsvc_set_operation(b, APPSVC_OPERATION_VIEW);
 		appsvc_add_data(b, "album-id", "GALLERY_ALBUM_PTP_ID");
 		appsvc_set_pkgname(b, GALLERY_APP_NAME);
 		ret = appsvc_run_service(b, 0, NULL, (void*)NULL);
 	} else {
 		appsvc_set_operation(b, APPSVC_OPERATION_VIEW);
-		if (otg_path != NULL) {
-			appsvc_add_data(b, "path", otg_path);
+		if (dev && dev->path[0] != '\0') {
+			appsvc_add_data(b, "path", dev->path);
 		} else {
 			appsvc_add_data(b, "path", USB_MOUNT_PATH);
 		}
@@ -304,7 +572,7 @@ void browse_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info
 	bundle_free(b);
 
 	fflush(stdout);
-	exit(0);
+	popup_linger_dismiss(ad->win_main, usbotg_release, ad);
 }
 
 void usbotg_clicked_cb(void *data, Evas * e, Evas_Object * obj,
@@ -332,14 +600,18 @@ int usbotg_play_vibration()
 
 	/* Open the haptic device */
 	dev_handle = device_haptic_open(DEV_IDX_0, mode);
-	if (dev_handle < 0)
+	if (dev_handle < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	/* Play a monotone pattern for 1s */
 	ret_val = device_haptic_play_monotone(dev_handle, 1000);
 	device_haptic_close(dev_handle);
-	if (ret_val < 0)
+	if (ret_val < 0) {
+		popup_stats_inc(POPUP_STAT_HAPTIC_FAIL);
 		return -1;
+	}
 
 	return 0;
 }
@@ -347,38 +619,27 @@ int usbotg_play_vibration()
 /* Basic popup widget */
 int usbotg_create_and_show_basic_popup(struct appdata *ad)
 {
-	Evas_Object *btn1;
-	Evas_Object *btn2;
-
 	/* Initialization */
 	int ret_val = 0;
 
 	/* Add notify */
 	/* No need to give main window, it will create internally */
-	ad->popup = elm_popup_add(ad->win_main);
-	evas_object_size_hint_weight_set(ad->popup, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
-	if (connected_device == CAMERA_DEVICE)
+	ad->popup = popup_pool_get(ad->win_main, 2);
+	if (ad->popup == NULL)
+		return -1;
+	if (ad->dev && ad->dev->type == USB_DEV_CAMERA)
 		elm_object_text_set(ad->popup, "Browse connected CAMERA?");
 	else
 		elm_object_text_set(ad->popup, "Browse connected USB Storage?");
 	elm_object_part_text_set(ad->popup, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
 
-	btn1 = elm_button_add(ad->popup);
-	elm_object_text_set(btn1, "Browse");
-	elm_object_part_content_set(ad->popup, "button1", btn1);
-	elm_object_style_set(btn1, "popup_button/default");
-	evas_object_smart_callback_add(btn1, "clicked", browse_clicked_cb, ad);
-
-	btn2 = elm_button_add(ad->popup);
-	elm_object_text_set(btn2, "Cancel");
-	elm_object_part_content_set(ad->popup, "button2", btn2);
-	elm_object_style_set(btn2, "popup_button/default");
-	evas_object_smart_callback_add(btn2, "clicked", bg_clicked_cb, ad);
-
-	Ecore_X_Window xwin;
-	xwin = elm_win_xwindow_get(ad->popup);
-	ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION);
+	popup_pool_button_set(ad->popup, 0, "Browse", browse_clicked_cb, ad);
+	popup_pool_button_set(ad->popup, 1, "Cancel", bg_clicked_cb, ad);
+
 	evas_object_show(ad->popup);
+	popup_linger_shown();
+	popup_stats_inc(POPUP_STAT_SHOW);
+	popup_x_report();
 
 	return 0;
 }
@@ -392,11 +653,14 @@ int usbotg_start(void *data)
 	ret_val = usbotg_create_and_show_basic_popup(ad);
 	if (ret_val != 0)
 		return -1;
+	popup_memprof_phase("popup_build");
 
 	/* Change LCD brightness */
 	ret_val = pm_change_state(LCD_NORMAL);
-	if (ret_val != 0)
+	if (ret_val != 0) {
+		popup_stats_inc(POPUP_STAT_PM_FAIL);
 		return -1;
+	}
 
 	/* Play vibration */
 	ret_val = usbotg_play_vibration();
@@ -412,12 +676,22 @@ int app_create(void *data)
 	Evas_Object *win;
 	struct appdata *ad = data;
 
+	popup_memprof_phase("efl_init");
+
 	/* create window */
 	win = create_win(PACKAGE);
 	if (win == NULL)
 		return -1;
 
 	ad->win_main = win;
+	popup_memprof_phase("create_win");
+	popup_memprof_watch(win);
+	popup_font_apply();
+
+	if (usb_device_init() < 0)
+		system_print("\n system-popup : Device registry not loaded \n");
+
+	POPUP_OPT_TABLE_ASSERT(usbotg_opts);
 
 	return 0;
 
@@ -430,10 +704,12 @@ int unknown_usb_noti(int option)
 
 	if (option == DEVICE_REMOVED) {
 		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_NOTI);
+		popup_stats_inc(POPUP_STAT_NOTI_DELETE);
 		system_print("unknown usb device is removed\n");
 		return -1;
 	} else if (option == DEVICE_ADDED) {
 		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_NOTI);
+		popup_stats_inc(POPUP_STAT_NOTI_DELETE);
 		system_print("add notification for unknow usb device\n");
 		noti = notification_new(NOTIFICATION_TYPE_NOTI, NOTIFICATION_GROUP_ID_NONE, NOTIFICATION_PRIV_ID_NONE);
 		if(noti == NULL) {
@@ -472,6 +748,8 @@ int unknown_usb_noti(int option)
 		}
 
 		noti_err = notification_insert(noti, NULL);
+		popup_stats_inc(noti_err == NOTIFICATION_ERROR_NONE ?
+				POPUP_STAT_NOTI_INSERT : POPUP_STAT_NOTI_FAIL);
 		if(noti_err != NOTIFICATION_ERROR_NONE) {
 			system_print("Error notification_insert : %d\n", noti_err);
 			return -1;
@@ -487,17 +765,29 @@ int unknown_usb_noti(int option)
 	return 0;
 }
 
-int camera_noti(int option, char* device_name)
+/* Remove the notification of one device, all of them if unknown */
+static void device_noti_delete(struct usb_device *dev)
+{
+	popup_stats_inc(POPUP_STAT_NOTI_DELETE);
+	if (dev == NULL)
+		notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_ONGOING);
+	else if (dev->priv_id != NOTIFICATION_PRIV_ID_NONE)
+		notification_delete_by_priv_id(NULL, NOTIFICATION_TYPE_ONGOING, dev->priv_id);
+}
+
+int camera_noti(int option, struct usb_device *dev)
 {
 	notification_h noti = NULL;
 	notification_error_e noti_err = NOTIFICATION_ERROR_NONE;
+	char *device_name = dev ? dev->name : NULL;
 
 	if (option == DEVICE_REMOVED) {
-		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_ONGOING);
+		device_noti_delete(dev);
 		system_print("camera removed\n");
 		return -1;
 	} else if (option == DEVICE_ADDED) {
-		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_ONGOING);
+		if (dev == NULL)
+			return -1;
 		system_print("add notification for camera\n");
 		noti = notification_new(NOTIFICATION_TYPE_ONGOING, NOTIFICATION_GROUP_ID_NONE, NOTIFICATION_PRIV_ID_NONE);
 		if(noti == NULL) {
@@ -541,7 +831,9 @@ int camera_noti(int option, char* device_name)
 			return -1;
 		}
 
-		noti_err = notification_insert(noti, NULL);
+		noti_err = notification_insert(noti, &dev->priv_id);
+		popup_stats_inc(noti_err == NOTIFICATION_ERROR_NONE ?
+				POPUP_STAT_NOTI_INSERT : POPUP_STAT_NOTI_FAIL);
 		if(noti_err != NOTIFICATION_ERROR_NONE) {
 			system_print("Error notification_insert : %d\n", noti_err);
 			return -1;
@@ -557,17 +849,19 @@ int camera_noti(int option, char* device_name)
 	return 0;
 }
 
-int otg_noti(int option, char* device_name)
+int otg_noti(int option, struct usb_device *dev)
 {
 	notification_h noti = NULL;
 	notification_error_e noti_err = NOTIFICATION_ERROR_NONE;
+	char *device_name = dev ? dev->name : NULL;
 
 	if (option == DEVICE_REMOVED) {
-		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_ONGOING);
+		device_noti_delete(dev);
 		system_print("usb otg removed\n");
 		return -1;
 	} else if (option == DEVICE_ADDED) {
-		noti_err = notification_delete_all_by_type(NULL, NOTIFICATION_TYPE_ONGOING);
+		if (dev == NULL)
+			return -1;
 		system_print("add notification for usb otg\n");
 		noti = notification_new(NOTIFICATION_TYPE_ONGOING, NOTIFICATION_GROUP_ID_NONE, NOTIFICATION_PRIV_ID_NONE);
 		if(noti == NULL) {
@@ -615,6 +909,7 @@ int otg_noti(int option, char* device_name)
 		b = bundle_create();
 		appsvc_set_pkgname(b, "org.tizen.usbotg-unmount-popup");
 		appsvc_add_data(b, "device_name", device_name);
+		appsvc_add_data(b, "path", dev->path);
 
 		noti_err = notification_set_execute_option(noti, NOTIFICATION_EXECUTE_TYPE_SINGLE_LAUNCH, "Launch", NULL, b);
 		if(noti_err != NOTIFICATION_ERROR_NONE) {
@@ -624,7 +919,9 @@ int otg_noti(int option, char* device_name)
 		bundle_free(b);
 
 
-		noti_err = notification_insert(noti, NULL);
+		noti_err = notification_insert(noti, &dev->priv_id);
+		popup_stats_inc(noti_err == NOTIFICATION_ERROR_NONE ?
+				POPUP_STAT_NOTI_INSERT : POPUP_STAT_NOTI_FAIL);
 		if(noti_err != NOTIFICATION_ERROR_NONE) {
 			system_print("Error notification_insert : %d\n", noti_err);
 			return -1;
@@ -654,6 +951,11 @@ int main(int argc, char *argv[])
 		.reset = app_reset,
 	};
 
+	popup_log_init(PACKAGE);
+	popup_memprof_init(PACKAGE);
+	popup_linger_init(PACKAGE);
+	popup_stats_init(POPUP_TYPE_USBOTG);
+
 	memset(&ad, 0x0, sizeof(struct appdata));
 	ops.data = &ad;
 
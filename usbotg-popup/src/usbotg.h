@@ -59,6 +59,8 @@ struct appdata {
 	double w_ratio;
 	double h_ratio;
 
+	struct usb_device *dev;		/* device offered for browsing */
+
 };
 
 #endif				/* __DEF_usbotg_H__ */
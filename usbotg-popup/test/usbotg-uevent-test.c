@@ -0,0 +1,383 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/*
+ * Hotplug monitor fed with synthetic uevents.
+ *
+ * The monitor is started with USBOTG_UEVENT_SOCKET pointing at a socket
+ * in a temp directory and USBOTG_SYSFS_ROOT at a fake sysfs tree, then
+ * add and remove sequences in the kernel format are sent to it while
+ * the main loop runs. What the callback reports, and when, is checked
+ * against what a real device would produce.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <Ecore.h>
+#include "src/usbotg-uevent.h"
+#include "popup-timer.h"
+
+#define USB_ROOT	"/devices/platform/usb1"
+#define CAMERA		USB_ROOT "/1-1"
+#define HUB		USB_ROOT "/1-2"
+#define OTHER		USB_ROOT "/1-3"
+#define DISK		USB_ROOT "/1-4"
+#define STICK		USB_ROOT "/1-5"
+#define BRIEF		USB_ROOT "/1-6"
+
+/* One settle period plus a tick of slack */
+#define SETTLE_WAIT_MS	(USBOTG_SETTLE_MS + 2 * POPUP_TIMER_TICK_MS)
+
+static int failures = 0;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if (!(cond)) {						\
+			fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);	\
+			fprintf(stderr, __VA_ARGS__);			\
+			fprintf(stderr, "\n");				\
+			failures++;					\
+		}							\
+	} while (0)
+
+/* Reports from the monitor, copied out of the callback */
+struct report {
+	int ev;
+	int kind;
+	char devpath[256];
+	char name[64];
+	char path[256];
+};
+
+static struct report reports[32];
+static int nreport = 0;
+
+static int sock = -1;
+static struct sockaddr_un peer;
+
+static void hotplug(int ev, const struct usbotg_hotplug *hp, void *data)
+{
+	struct report *r;
+
+	if (nreport == (int)(sizeof(reports) / sizeof(reports[0])))
+		return;
+	r = &reports[nreport++];
+	r->ev = ev;
+	r->kind = hp->kind;
+	snprintf(r->devpath, sizeof(r->devpath), "%s", hp->devpath);
+	snprintf(r->name, sizeof(r->name), "%s", hp->name);
+	snprintf(r->path, sizeof(r->path), "%s", hp->path);
+}
+
+static const struct report *find_report(int ev, const char *devpath)
+{
+	int i;
+
+	for (i = 0; i < nreport; i++)
+		if (reports[i].ev == ev && strcmp(reports[i].devpath, devpath) == 0)
+			return &reports[i];
+	return NULL;
+}
+
+/* Send "ACTION@DEVPATH" followed by ACTION, DEVPATH and the given keys */
+static void inject(const char *action, const char *devpath, ...)
+{
+	char buf[1024];
+	const char *kv;
+	va_list ap;
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "%s@%s", action, devpath) + 1;
+	len += snprintf(buf + len, sizeof(buf) - len, "ACTION=%s", action) + 1;
+	len += snprintf(buf + len, sizeof(buf) - len, "DEVPATH=%s", devpath) + 1;
+
+	va_start(ap, devpath);
+	while ((kv = va_arg(ap, const char *)) != NULL)
+		len += snprintf(buf + len, sizeof(buf) - len, "%s", kv) + 1;
+	va_end(ap);
+
+	CHECK(sendto(sock, buf, len, 0, (struct sockaddr *)&peer,
+		     sizeof(peer)) == len, "%s@%s not sent", action, devpath);
+
+	/* Hand it over now, a datagram socket only queues a few */
+	ecore_main_loop_iterate();
+}
+
+static Eina_Bool quit_cb(void *data)
+{
+	ecore_main_loop_quit();
+	return ECORE_CALLBACK_CANCEL;
+}
+
+/* Run the main loop for ms, returns ms */
+static int run_ms(int ms)
+{
+	ecore_timer_add(ms / 1000.0, quit_cb, NULL);
+	ecore_main_loop_begin();
+	return ms;
+}
+
+static int write_attr(const char *root, const char *devpath,
+		      const char *attr, const char *val)
+{
+	char path[PATH_MAX];
+	char *p;
+	FILE *fp;
+
+	if (snprintf(path, sizeof(path), "%s%s/%s", root, devpath,
+		     attr) >= (int)sizeof(path))
+		return -1;
+	for (p = strchr(path + strlen(root) + 1, '/'); p; p = strchr(p + 1, '/')) {
+		*p = '\0';
+		mkdir(path, 0755);
+		*p = '/';
+	}
+	fp = fopen(path, "w");
+	if (fp == NULL)
+		return -1;
+	fprintf(fp, "%s\n", val);
+	return fclose(fp);
+}
+
+/* A block device that is mounted right now, or -1 */
+static int mounted_dev(char *dev, size_t size, char *dir, size_t dsize)
+{
+	char line[512], d[64], m[256];
+	FILE *fp;
+	int ret = -1;
+
+	fp = fopen("/proc/mounts", "r");
+	if (fp == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "%63s %255s", d, m) == 2 &&
+		    strncmp(d, "/dev/", 5) == 0 && strchr(d + 5, '/') == NULL) {
+			snprintf(dev, size, "%s", d + 5);
+			snprintf(dir, dsize, "%s", m);
+			ret = 0;
+			break;
+		}
+	}
+	fclose(fp);
+	return ret;
+}
+
+/* Parsing and classification need no socket */
+static void test_parse(void)
+{
+	char modern[] = "add@/devices/x\0ACTION=add\0DEVPATH=/devices/x\0"
+		"SUBSYSTEM=usb\0DEVTYPE=usb_interface\0INTERFACE=8/6/80\0"
+		"PRODUCT=781/5567/100";
+	char bare[] = "remove@/devices/y\0SUBSYSTEM=block\0DEVNAME=sda1";
+	char nosub[] = "add@/devices/z\0ACTION=add";
+	char noat[] = "garbage\0SUBSYSTEM=usb";
+	struct usbotg_uevent ev;
+
+	CHECK(usbotg_uevent_parse(modern, sizeof(modern), &ev) == 0 &&
+	      strcmp(ev.action, "add") == 0 &&
+	      strcmp(ev.devpath, "/devices/x") == 0 &&
+	      strcmp(ev.subsystem, "usb") == 0 &&
+	      strcmp(ev.devtype, "usb_interface") == 0 &&
+	      strcmp(ev.interface, "8/6/80") == 0 &&
+	      strcmp(ev.product, "781/5567/100") == 0, "parse: fields");
+	CHECK(usbotg_uevent_parse(bare, sizeof(bare), &ev) == 0 &&
+	      strcmp(ev.action, "remove") == 0 &&
+	      strcmp(ev.devpath, "/devices/y") == 0 &&
+	      strcmp(ev.devname, "sda1") == 0, "parse: header fallback");
+	CHECK(usbotg_uevent_parse(nosub, sizeof(nosub), &ev) < 0,
+	      "parse: no subsystem accepted");
+	CHECK(usbotg_uevent_parse(noat, sizeof(noat), &ev) < 0,
+	      "parse: no header accepted");
+	CHECK(usbotg_uevent_parse(modern, sizeof(modern) - 1, &ev) < 0,
+	      "parse: unterminated accepted");
+
+	CHECK(usbotg_uevent_classify("8/6/80") == USBOTG_KIND_STORAGE,
+	      "classify: storage");
+	CHECK(usbotg_uevent_classify("6/1/1") == USBOTG_KIND_CAMERA,
+	      "classify: camera");
+	CHECK(usbotg_uevent_classify("9/0/0") == USBOTG_KIND_HUB, "classify: hub");
+	CHECK(usbotg_uevent_classify("3/1/2") == USBOTG_KIND_UNKNOWN,
+	      "classify: hid");
+	CHECK(usbotg_uevent_classify(NULL) == USBOTG_KIND_NONE, "classify: none");
+}
+
+static void test_hotplug(const char *tmp)
+{
+	char root[PATH_MAX], path[PATH_MAX];
+	char dev[64], devname[80], mnt[256];
+	const struct report *r;
+	char *p;
+	int mounted, elapsed = 0;
+
+	snprintf(root, sizeof(root), "%s/sys", tmp);
+	snprintf(path, sizeof(path), "%s/uevent", tmp);
+	mkdir(root, 0755);
+	write_attr(root, CAMERA, "product", "Canon Camera");
+	setenv(USBOTG_SYSFS_ENV, root, 1);
+	setenv(USBOTG_UEVENT_ENV, path, 1);
+
+	CHECK(usbotg_uevent_start(hotplug, NULL) == 0, "monitor did not start");
+	if (!usbotg_uevent_running())
+		return;
+
+	sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+	memset(&peer, 0, sizeof(peer));
+	peer.sun_family = AF_UNIX;
+	CHECK(snprintf(peer.sun_path, sizeof(peer.sun_path), "%s",
+		       path) < (int)sizeof(peer.sun_path), "socket path too long");
+
+	mounted = mounted_dev(dev, sizeof(dev), mnt, sizeof(mnt)) == 0;
+	snprintf(devname, sizeof(devname), "DEVNAME=%s", mounted ? dev : "sdy1");
+
+	/* Camera, named from sysfs */
+	inject("add", CAMERA, "SUBSYSTEM=usb", "DEVTYPE=usb_device",
+	       "PRODUCT=4a9/3218/2", NULL);
+	inject("add", CAMERA "/1-1:1.0", "SUBSYSTEM=usb",
+	       "DEVTYPE=usb_interface", "INTERFACE=6/1/1", NULL);
+
+	/* Hubs are never reported */
+	inject("add", HUB, "SUBSYSTEM=usb", "DEVTYPE=usb_device",
+	       "PRODUCT=5e3/608/6060", NULL);
+	inject("add", HUB "/1-2:1.0", "SUBSYSTEM=usb", "DEVTYPE=usb_interface",
+	       "INTERFACE=9/0/0", NULL);
+
+	/* Any class beats none, the name comes from the ids */
+	inject("add", OTHER, "SUBSYSTEM=usb", "DEVTYPE=usb_device",
+	       "PRODUCT=46d/c52b/1211", NULL);
+	inject("add", OTHER "/1-3:1.0", "SUBSYSTEM=usb",
+	       "DEVTYPE=usb_interface", "INTERFACE=3/1/1", NULL);
+
+	/* Storage, the partition node wins over the disk */
+	inject("add", DISK, "SUBSYSTEM=usb", "DEVTYPE=usb_device",
+	       "PRODUCT=781/5567/100", NULL);
+	inject("add", DISK "/1-4:1.0", "SUBSYSTEM=usb",
+	       "DEVTYPE=usb_interface", "INTERFACE=8/6/80", NULL);
+	inject("add", DISK "/1-4:1.0/host0/target0:0:0/0:0:0:0/block/sdy",
+	       "SUBSYSTEM=block", "DEVTYPE=disk", "DEVNAME=sdy", NULL);
+	inject("add", DISK "/1-4:1.0/host0/target0:0:0/0:0:0:0/block/sdy/sdy1",
+	       "SUBSYSTEM=block", "DEVTYPE=partition", devname, NULL);
+
+	/* Storage that never gets mounted */
+	inject("add", STICK, "SUBSYSTEM=usb", "DEVTYPE=usb_device",
+	       "PRODUCT=951/1666/110", NULL);
+	inject("add", STICK "/1-5:1.0", "SUBSYSTEM=usb",
+	       "DEVTYPE=usb_interface", "INTERFACE=8/6/80", NULL);
+	inject("add", STICK "/1-5:1.0/host1/target1:0:0/1:0:0:0/block/sdz",
+	       "SUBSYSTEM=block", "DEVTYPE=disk", "DEVNAME=sdz", NULL);
+
+	/* Gone before it settled */
+	inject("add", BRIEF, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+	inject("remove", BRIEF, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+
+	/* Settle is measured from the last event of each device */
+	elapsed += run_ms(USBOTG_SETTLE_MS / 2);
+	CHECK(nreport == 0, "%d reports before settling", nreport);
+	elapsed += run_ms(SETTLE_WAIT_MS);
+
+	r = find_report(USBOTG_EV_ADD, CAMERA);
+	CHECK(r && r->kind == USBOTG_KIND_CAMERA &&
+	      strcmp(r->name, "Canon Camera") == 0,
+	      "camera: %s", r ? r->name : "not reported");
+	r = find_report(USBOTG_EV_ADD, OTHER);
+	CHECK(r && r->kind == USBOTG_KIND_UNKNOWN &&
+	      strcmp(r->name, "USB 46d:c52b") == 0,
+	      "unknown: %s", r ? r->name : "not reported");
+	CHECK(find_report(USBOTG_EV_ADD, HUB) == NULL, "hub reported");
+	CHECK(find_report(USBOTG_EV_ADD, BRIEF) == NULL &&
+	      find_report(USBOTG_EV_REMOVE, BRIEF) == NULL,
+	      "unsettled device reported");
+	CHECK(find_report(USBOTG_EV_ADD, STICK) == NULL,
+	      "unmounted storage reported before its tries ran out");
+	r = find_report(USBOTG_EV_ADD, DISK);
+	if (mounted)
+		CHECK(r && r->kind == USBOTG_KIND_STORAGE &&
+		      strcmp(r->path, mnt) == 0,
+		      "storage: mounted at %s, reported %s", mnt,
+		      r ? r->path : "nothing");
+	else
+		CHECK(r == NULL, "storage reported without a mount");
+
+	/* Change events are dropped by the socket filter, not handled */
+	inject("change", CAMERA, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+	inject("remove", CAMERA "/1-1:1.0", "SUBSYSTEM=usb",
+	       "DEVTYPE=usb_interface", "INTERFACE=6/1/1", NULL);
+	elapsed += run_ms(POPUP_TIMER_TICK_MS);
+	CHECK(find_report(USBOTG_EV_REMOVE, CAMERA) == NULL,
+	      "camera removed by a change or interface event");
+
+	inject("remove", CAMERA, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+	inject("remove", HUB, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+	elapsed += run_ms(POPUP_TIMER_TICK_MS);
+	r = find_report(USBOTG_EV_REMOVE, CAMERA);
+	CHECK(r && r->kind == USBOTG_KIND_CAMERA, "camera removal not reported");
+	CHECK(find_report(USBOTG_EV_REMOVE, HUB) == NULL, "hub removal reported");
+
+	/* Unmounted storage is reported anyway once the tries run out */
+	run_ms(USBOTG_MOUNT_TRIES * USBOTG_SETTLE_MS + SETTLE_WAIT_MS - elapsed);
+	r = find_report(USBOTG_EV_ADD, STICK);
+	CHECK(r && r->kind == USBOTG_KIND_STORAGE && r->path[0] == '\0',
+	      "unmounted storage: %s", r ? r->path : "not reported");
+
+	inject("remove", STICK, "SUBSYSTEM=usb", "DEVTYPE=usb_device", NULL);
+	run_ms(POPUP_TIMER_TICK_MS);
+	CHECK(find_report(USBOTG_EV_REMOVE, STICK) != NULL,
+	      "storage removal not reported");
+
+	usbotg_uevent_stop();
+	CHECK(access(path, F_OK) < 0, "socket left behind");
+	close(sock);
+
+	/* The fake tree is the product file and the directories above it */
+	snprintf(path, sizeof(path), "%s" CAMERA "/product", root);
+	unlink(path);
+	while ((p = strrchr(path, '/')) != NULL && strlen(path) > strlen(root)) {
+		*p = '\0';
+		rmdir(path);
+	}
+}
+
+int main(void)
+{
+	char tmp[] = "/tmp/usbotg-test.XXXXXX";
+
+	test_parse();
+
+	if (mkdtemp(tmp) == NULL) {
+		CHECK(0, "no temp dir");
+	} else {
+		ecore_init();
+		popup_timer_init();
+		test_hotplug(tmp);
+		popup_timer_fini();
+		ecore_shutdown();
+		rmdir(tmp);
+	}
+
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("usbotg uevent: all checks passed\n");
+	return 0;
+}
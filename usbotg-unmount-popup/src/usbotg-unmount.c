@@ -29,6 +29,16 @@
 #include <notification.h>
 #include <syspopup_caller.h>
 #include <appsvc.h>
+#include <vconf.h>
+#include "popup-linger.h"
+#include "popup-log.h"
+#include "popup-stats.h"
+#include "popup-screen.h"
+#include "popup-x.h"
+#include "popup-arena.h"
+#include "popup-pool.h"
+#include "popup-memprof.h"
+#include "popup-font.h"
 
 #define APPLICATION_BG		1
 #define INDICATOR_HEIGHT	(38)	/* the case of 480*800 */
@@ -41,8 +51,12 @@
 
 #include <syspopup.h>
 
+/* Strings of the request on screen, dropped on close */
+static struct popup_arena req_arena = POPUP_ARENA_INIT;
 static const char *dev_name = NULL;
 
+int usbotg_unmount_start(void *data);
+
 int myterm(bundle *b, void *data)
 {
 	return 0;
@@ -116,15 +130,18 @@ static Evas_Object *create_win(const char *name)
 	Evas_Object *eo;
 	int w, h;
 
-	eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC);
+	POPUP_X("elm_win_add", eo = elm_win_add(NULL, name, ELM_WIN_DIALOG_BASIC));
 	if (eo) {
 		elm_win_title_set(eo, name);
 		elm_win_borderless_set(eo, EINA_TRUE);
 		evas_object_smart_callback_add(eo, "delete,request", win_del, NULL);
 		elm_win_alpha_set(eo, EINA_TRUE);
-		ecore_x_window_size_get(ecore_x_window_root_first_get(), &w,
-				&h);
+		/* Cached geometry, no round trip on a warm start */
+		popup_screen_get(&w, &h, NULL);
 		evas_object_resize(eo, w, h);
+
+		/* Queued ahead of the map request */
+		popup_x_prepare(eo, 0);
 	}
 
 	return eo;
@@ -163,6 +180,7 @@ static int app_terminate(void *data)
 	if (ad->win_main)
 		evas_object_del(ad->win_main);
 
+	popup_arena_fini(&req_arena);
 	return 0;
 }
 
@@ -186,15 +204,26 @@ static int app_reset(bundle *b, void *data)
 	int removenoti = -1;
 	char *opt = NULL;
 
-	dev_name = bundle_get_val(b, "device_name");
+	popup_stats_inc(POPUP_STAT_LAUNCH);
+
+	if (bundle_get_val(b, "device_name") == NULL)
+		return 0;
+	dev_name = popup_arena_strdup(&req_arena, bundle_get_val(b, "device_name"));
 	if (dev_name == NULL)
 		return 0;
 
 	if (syspopup_has_popup(b)) {
 		syspopup_reset(b);
+
+		/* Show the lingering window again */
+		if (popup_linger_reuse()) {
+			evas_object_show(ad->win_main);
+			usbotg_unmount_start((void *)ad);
+		}
 	} else {
-		syspopup_create(b, &handler, ad->win_main, ad);
-		evas_object_show(ad->win_main);
+		POPUP_X("syspopup_create",
+			syspopup_create(b, &handler, ad->win_main, ad));
+		POPUP_X("win_show", evas_object_show(ad->win_main));
 
 		/* Start Main UI */
 		usbotg_unmount_start((void *)ad);
@@ -203,18 +232,6 @@ static int app_reset(bundle *b, void *data)
 	return 0;
 }
 
-/* Customized print */
-void system_print(const char *format, ...)
-{
-	/* Un-comment return to disable logs */
-	//return;
-
-	va_list args;
-	va_start(args, format);
-	vfprintf(stderr, format, args);
-	va_end(args);
-}
-
 /* Cleanup objects to avoid mem-leak */
 void usbotg_unmount_cleanup(struct appdata *ad)
 {
@@ -222,17 +239,32 @@ void usbotg_unmount_cleanup(struct appdata *ad)
 		return;
 
 	if (ad->popup)
-		evas_object_del(ad->popup);
+		popup_pool_put(ad->popup);
 	if (ad->layout_main)
 		evas_object_del(ad->layout_main);
+	ad->popup = NULL;
+	ad->layout_main = NULL;
+}
+
+static void usbotg_unmount_release(void *data)
+{
+	struct appdata *ad = data;
+
+	usbotg_unmount_cleanup(ad);
+	ad->device_name = NULL;
+	dev_name = NULL;
+	popup_arena_reset(&req_arena);
 }
 
 /* Background clicked noti */
 void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
+	struct appdata *ad = data;
+
 	system_print("\n system-popup : In BG Noti \n");
 	fflush(stdout);
-	exit(0);
+	popup_stats_inc(POPUP_STAT_CHOICE_CANCEL);
+	popup_linger_dismiss(ad->win_main, usbotg_unmount_release, ad);
 }
 
 /* Yes clicked noti */
@@ -243,13 +275,13 @@ void bg_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 void ok_clicked_cb(void *data, Evas * e, Evas_Object * obj, void *event_info)
 {
 	system_print("\n system-popup : Yes Noti \n");
+	popup_stats_inc(POPUP_STAT_CHOICE_OK);
 
 	struct appdata *ad = data;
 	vconf_set_str(VCONFKEY_REMOVED_USB_STORAGE, ad->device_name);
-	free(ad->device_name);
 
 	fflush(stdout);
-	exit(0);
+	popup_linger_dismiss(ad->win_main, usbotg_unmount_release, ad);
 }
 
 /* Create indicator bar */
@@ -262,37 +294,28 @@ int usbotg_unmount_create_indicator(struct appdata *ad)
 /* Basic popup widget */
 int usbotg_unmount_create_and_show_basic_popup(struct appdata *ad)
 {
-	Evas_Object *btn1;
-	Evas_Object *btn2;
 	char buf[PATH_MAX] = {0, };
 
 	/* Initialization */
 	int ret_val = 0;
 	snprintf(buf, PATH_MAX, "Unmount %s?", dev_name);
-	ad->device_name = malloc(strlen(dev_name)+1);
-	strncpy(ad->device_name, dev_name, strlen(dev_name));
+	ad->device_name = dev_name;
 
 	/* Add notify */
 	/* No need to give main window, it will create internally */
-	ad->popup = elm_popup_add(ad->win_main);
-	evas_object_size_hint_weight_set(ad->popup, EVAS_HINT_EXPAND, EVAS_HINT_EXPAND);
+	ad->popup = popup_pool_get(ad->win_main, 2);
+	if (ad->popup == NULL)
+		return -1;
 	elm_object_text_set(ad->popup, buf);
 	elm_object_part_text_set(ad->popup, "title,text", _("IDS_COM_BODY_SYSTEM_INFO_ABB"));
 
-	btn1 = elm_button_add(ad->popup);
-	elm_object_text_set(btn1, "OK");
-	elm_object_part_content_set(ad->popup, "button1", btn1);
-	evas_object_smart_callback_add(btn1, "clicked", ok_clicked_cb, ad);
-
-	btn2 = elm_button_add(ad->popup);
-	elm_object_text_set(btn2, "Cancel");
-	elm_object_part_content_set(ad->popup, "button2", btn2);
-	evas_object_smart_callback_add(btn2, "clicked", bg_clicked_cb, ad);
+	popup_pool_button_set(ad->popup, 0, "OK", ok_clicked_cb, ad);
+	popup_pool_button_set(ad->popup, 1, "Cancel", bg_clicked_cb, ad);
 
-	Ecore_X_Window xwin;
-	xwin = elm_win_xwindow_get(ad->popup);
-	ecore_x_netwm_window_type_set(xwin, ECORE_X_WINDOW_TYPE_NOTIFICATION);
 	evas_object_show(ad->popup);
+	popup_linger_shown();
+	popup_stats_inc(POPUP_STAT_SHOW);
+	popup_x_report();
 
 	return 0;
 }
@@ -306,6 +329,7 @@ int usbotg_unmount_start(void *data)
 	ret_val = usbotg_unmount_create_and_show_basic_popup(ad);
 	if (ret_val != 0)
 		return -1;
+	popup_memprof_phase("popup_build");
 
 	return 0;
 }
@@ -316,12 +340,17 @@ int app_create(void *data)
 	Evas_Object *win;
 	struct appdata *ad = data;
 
+	popup_memprof_phase("efl_init");
+
 	/* create window */
 	win = create_win(PACKAGE);
 	if (win == NULL)
 		return -1;
 
 	ad->win_main = win;
+	popup_memprof_phase("create_win");
+	popup_memprof_watch(win);
+	popup_font_apply();
 
 	return 0;
 
@@ -340,6 +369,11 @@ int main(int argc, char *argv[])
 		.reset = app_reset,
 	};
 
+	popup_log_init(PACKAGE);
+	popup_memprof_init(PACKAGE);
+	popup_linger_init(PACKAGE);
+	popup_stats_init(POPUP_TYPE_USBOTG_UNMOUNT);
+
 	memset(&ad, 0x0, sizeof(struct appdata));
 	ops.data = &ad;
 